@@ -0,0 +1,45 @@
+#permutation INDIRECT 0 1
+#shader vertex
+#version 330 core
+#if INDIRECT
+#extension GL_ARB_shader_storage_buffer_object : require
+#endif
+
+layout(location = 0) in vec4 position;
+
+#if INDIRECT
+//BaseInstance of each indirect draw selects its entry
+layout(location = 1) in uint drawID;
+
+layout(std430) buffer DrawData
+{
+	vec4 u_Draws[];
+};
+#define TRANSFORM u_Draws[drawID * 2u]
+#define COLOR u_Draws[drawID * 2u + 1u]
+#else
+uniform vec4 u_DrawData[2];
+#define TRANSFORM u_DrawData[0]
+#define COLOR u_DrawData[1]
+#endif
+
+out vec4 v_Color;
+
+void main()
+{
+	//xy = offset, zw = scale
+	gl_Position = vec4(position.xy * TRANSFORM.zw + TRANSFORM.xy, position.zw);
+	v_Color = COLOR;
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 v_Color;
+
+void main()
+{
+	color = v_Color;
+};
\ No newline at end of file
@@ -0,0 +1,27 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+//Per instance: xy = offset, zw = scale
+layout(location = 1) in vec4 instanceTransform;
+layout(location = 2) in vec4 instanceColor;
+
+out vec4 v_Color;
+
+void main()
+{
+	gl_Position = vec4(position.xy * instanceTransform.zw + instanceTransform.xy, position.zw);
+	v_Color = instanceColor;
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 v_Color;
+
+void main()
+{
+	color = v_Color;
+};
\ No newline at end of file
@@ -0,0 +1,24 @@
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+
+//Columns of the model-view-projection matrix, one draw_uniform each
+uniform vec4 u_Transform[4];
+
+void main()
+{
+	gl_Position = mat4(u_Transform[0], u_Transform[1], u_Transform[2], u_Transform[3]) * position;
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+uniform vec4 u_Color;
+
+void main()
+{
+	color = u_Color;
+};
\ No newline at end of file
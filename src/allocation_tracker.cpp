@@ -0,0 +1,93 @@
+#include "allocation_tracker.h"
+
+#ifdef TRACK_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<size_t> allocationCount(0);
+
+static void* CountedAllocate(size_t size) noexcept
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+static void* CountedAllocateAligned(size_t size, std::align_val_t alignment) noexcept
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    size_t align = (size_t)alignment;
+    size = size ? (size + align - 1) / align * align : align;
+#ifdef _WIN32
+    return _aligned_malloc(size, align);
+#else
+    return std::aligned_alloc(align, size);
+#endif
+}
+
+static void FreeAligned(void* memory) noexcept
+{
+#ifdef _WIN32
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+void* operator new(size_t size)
+{
+    if (void* memory = CountedAllocate(size))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    if (void* memory = CountedAllocate(size))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return CountedAllocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return CountedAllocate(size); }
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    if (void* memory = CountedAllocateAligned(size, alignment))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    if (void* memory = CountedAllocateAligned(size, alignment))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+
+void operator delete(void* memory, std::align_val_t) noexcept { FreeAligned(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { FreeAligned(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { FreeAligned(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { FreeAligned(memory); }
+
+size_t GetAllocationCount()
+{
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+#else
+
+size_t GetAllocationCount()
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+
+//Number of global operator new calls so far, from every thread. Only counted in
+//builds with TRACK_ALLOCATIONS, which replaces the global operator new/delete;
+//otherwise always 0.
+size_t GetAllocationCount();
+
+//Heap allocations made while the scope is alive
+class allocation_scope
+{
+private:
+	size_t m_Start;
+
+public:
+	allocation_scope()
+		: m_Start(GetAllocationCount()) {}
+
+	inline size_t GetCount() const { return GetAllocationCount() - m_Start; }
+};
@@ -1,107 +1,49 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+#include <chrono>
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <sstream>
 
 #include "renderer.h"
 #include "vertex_buffer.h"
+#include "vertex_buffer_layout.h"
+#include "vertex_array.h"
+#include "command_list.h"
+#include "render_thread.h"
+#include "allocation_tracker.h"
+#include "fixed_timestep.h"
+#include "frame_pacer.h"
+#include "scene_graph.h"
+#include "frustum_culler.h"
+#include "bvh.h"
+#ifdef ON_DEMAND_RENDERING
+#include "damage_tracker.h"
+#endif
+
+//Override on the command line, e.g. -DFRAME_PACING_MODE=pacing_mode::LIMITED -DFRAME_PACING_FPS=30
+#ifndef FRAME_PACING_MODE
+#define FRAME_PACING_MODE pacing_mode::VSYNC
+#endif
+#ifndef FRAME_PACING_FPS
+#define FRAME_PACING_FPS 60.0
+#endif
+#if defined(GL_TRACE) && !defined(GL_TRACE_FILE)
+#define GL_TRACE_FILE "capture.gltrace"
+#endif
 #include "index_buffer.h"
-
-struct ShaderProgramSource
-{
-    std::string VertexSource;
-    std::string FragmentSource;
-};
-
-static ShaderProgramSource IterateShader(const::std::string &filepath)
-{
-    std::ifstream stream(filepath);
-
-    enum class shaderType
-    {
-        NONE = -1, VERTEX = 0, FRAGMENT = 1
-    };
-
-    //Set the shaders to an external file
-    std::string line;
-    std::stringstream ss[2];
-    shaderType type = shaderType::NONE;
-    while (getline(stream, line))
-    {
-        //Parsing shader file to find the specified sections
-        if (line.find("#shader") != std::string::npos)
-        {
-            if (line.find("vertex") != std::string::npos)
-                //Set mode to vertex
-                type = shaderType::VERTEX;
-            else if (line.find("fragment") != std::string::npos)
-                //Set mode to fragment
-                type = shaderType::FRAGMENT;
-        }
-        else
-        {
-            ss[(int)type] << line << "\n";
-        }
-    }
-    return{ ss[0].str(), ss[1].str() };
-}
-
-static unsigned int compileShader(unsigned int type, const::std::string& source)
-{
-    unsigned int id = glCreateShader(type);
-
-    //Make sure this string stays alive to avoid ptr to junk
-    const char* src = source.c_str();
-    GLCall(glShaderSource(id, 1, &src, nullptr));
-    GLCall(glCompileShader(id));
-
-    int result;
-    GLCall(glGetShaderiv(id, GL_COMPILE_STATUS, &result));
-
-    if (result == GL_FALSE)
-    {
-        int length;
-        GLCall(glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length));
-        char* message = (char*)alloca(length * sizeof(char));
-        GLCall(glGetShaderInfoLog(id, length, &length, message));
-
-        std::cout << "Failed to compile " <<
-            (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << std::endl;
-
-        std::cout << message << std::endl;
-
-        GLCall(glDeleteShader(id));
-        return 0;
-    }
-
-    return id;
-}
-
-static unsigned int createShader(const::std::string& vertexShader, const::std::string& fragmentShader) 
-{
-    unsigned int program = glCreateProgram();
-
-    //Create two shader objects
-    unsigned int vs = compileShader(GL_VERTEX_SHADER, vertexShader);
-    unsigned int fs = compileShader(GL_FRAGMENT_SHADER, fragmentShader);
-
-    GLCall(glAttachShader(program, vs));
-    GLCall(glAttachShader(program, fs));
-
-    GLCall(glLinkProgram(program));
-    GLCall(glValidateProgram(program));
-
-    GLCall(glDeleteShader(vs));
-    GLCall(glDeleteShader(fs));
-
-    return program;
-}
+#include "shader_program.h"
+#ifdef SHADER_HOT_RELOAD
+#include "shader_hot_reload.h"
+#else
+#include "embedded_shaders.h"
+#include "program_pipeline.h"
+#endif
 
 int main(void)
 {
+    auto startupBegin = std::chrono::steady_clock::now();
+
     GLFWwindow* window;
 
     //Initialize the library 
@@ -124,7 +66,9 @@ int main(void)
     //Make the window's context current 
     glfwMakeContextCurrent(window);
 
-    glfwSwapInterval(1);
+    frame_pacer pacer(FRAME_PACING_MODE, FRAME_PACING_FPS);
+    int swapInterval = pacer.ChooseSwapInterval();
+    glfwSwapInterval(swapInterval);
 
     if (glewInit() != GLEW_OK)
     {
@@ -134,6 +78,13 @@ int main(void)
     //Print the OpenGl version being utilized
     std::cout << glGetString(GL_VERSION) << std::endl;
 
+#ifdef GL_TRACE
+    //Everything from here on goes into the trace, object creation included, for tools/gl_replay
+    int traceWidth, traceHeight;
+    glfwGetFramebufferSize(window, &traceWidth, &traceHeight);
+    BeginGLTrace(GL_TRACE_FILE, traceWidth, traceHeight);
+#endif
+
     {
         //Buffer index
         float positions[] = {
@@ -148,11 +99,8 @@ int main(void)
             2, 3, 0
         };
 
-        unsigned int vao;
-        GLCall(glGenVertexArrays(1, &vao));
-        GLCall(glBindVertexArray(vao));
-
-        vertex_buffer vb(positions, 6 * 2 * sizeof(float));
+        vertex_array va;
+        vertex_buffer vb(positions, 4 * 2 * sizeof(float));
                 /*Replaces the following:
                 //Setting up a static buffer to draw triangle
                 unsigned int buffer;
@@ -161,20 +109,25 @@ int main(void)
 
                 //Copy positions into buffer with ptr and specifying size
                 GLCall(glBufferData(GL_ARRAY_BUFFER,        //target
-                                    6 * 2 * sizeof(float),  //size
+                                    4 * 2 * sizeof(float),  //size
                                     positions,              //data
                                     GL_STATIC_DRAW));       //usage
                 */
-        GLCall(glEnableVertexAttribArray(0)); //Enable index 0
-
-        //This line binds the 'buffer' to 'vao'
-        //Reminder, stide is the total byte size accross all attributes
-        GLCall(glVertexAttribPointer(0,                  //index
-                                     2,                  //size
-                                     GL_FLOAT,           //type
-                                     GL_FALSE,           //normalized
-                                     sizeof(float) * 2,  //stride
-                                     0 ));               //pointer
+        vertex_buffer_layout layout;
+        layout.Push<float>(2);
+        va.AddBuffer(vb, layout);
+                /*Replaces the following:
+                GLCall(glEnableVertexAttribArray(0)); //Enable index 0
+
+                //This line binds the 'buffer' to 'vao'
+                //Reminder, stide is the total byte size accross all attributes
+                GLCall(glVertexAttribPointer(0,                  //index
+                                             2,                  //size
+                                             GL_FLOAT,           //type
+                                             GL_FALSE,           //normalized
+                                             sizeof(float) * 2,  //stride
+                                             0 ));               //pointer
+                */
 
         index_buffer ib(indices, 6);
                 /*Replaces the following:
@@ -189,56 +142,256 @@ int main(void)
                                     indices,                   //data
                                     GL_STATIC_DRAW));          //usage
                 */
-        ShaderProgramSource source = IterateShader("res/shaders/basic.shader");
-
-        unsigned int shader = createShader(source.VertexSource, source.FragmentSource);
-        GLCall(glUseProgram(shader));
-
-        int location = glGetUniformLocation(shader, "u_Color");
-        ASSERT(location != -1);
+#ifdef SHADER_HOT_RELOAD
+        //Development mode: edits under res/shaders are picked up while running
+        shader_hot_reload shaderReload("res/shaders");
+        unsigned int sceneHandle = shaderReload.Watch("res/shaders/scene.shader");
+        unsigned int shader = shaderReload.GetProgram(sceneHandle);
+#else
+        //Embedded by tools/embed_shaders and split into stages at compile time, no file I/O.
+        //The hot reload build above keeps reading res/shaders from disk.
+        static constexpr shader_sections sceneSections = ParseShaderSections(scene_shader);
+        static_assert(!sceneSections.Get(shader_stage::VERTEX).empty() &&
+                      !sceneSections.Get(shader_stage::FRAGMENT).empty(), "scene.shader needs both stages");
+
+        //Whole programs, since renderer binds one per draw; the cache deletes them at the end
+        program_pipeline_cache programs(false);
+        unsigned int shader = programs.Get(ToProgramSource(sceneSections)).Program;
+        ASSERT(shader != 0);
+#endif
+        scene_uniforms sceneUniforms = GetSceneUniforms(shader);
+        ASSERT(sceneUniforms.Color != -1);
+
+        //A sun with orbiting planets and moons, each orbit a pivot node rotating its children
+        scene_graph scene;
+        unsigned int square = scene.AddMesh({ va.GetRendererID(), &ib });
+        const aabb squareBounds = { vec3(-0.5f, -0.5f, 0.0f), vec3(0.5f, 0.5f, 0.0f) };
+        const unsigned int planetCount = 4;
+        const unsigned int moonsPerPlanet = 2;
+
+        scene_node sun = scene.Add(invalidSceneNode, Scaling(vec3(0.4f, 0.4f, 1.0f)), squareBounds, square,
+                                   vec4(0.2f, 0.3f, 0.8f, 0.2f));
+        scene_node planetOrbits[planetCount];
+        scene_node moonOrbits[planetCount * moonsPerPlanet];
+        for (unsigned int p = 0; p < planetCount; p++)
+        {
+            planetOrbits[p] = scene.Add(invalidSceneNode);
+            float distance = 0.45f + 0.22f * p;
+            scene_node planet = scene.Add(planetOrbits[p], Compose(vec3(distance, 0.0f, 0.0f), quat(), vec3(0.08f, 0.08f, 1.0f)),
+                                          squareBounds, square, vec4(0.9f, 0.5f + 0.1f * p, 0.2f, 1.0f));
+            for (unsigned int m = 0; m < moonsPerPlanet; m++)
+            {
+                scene_node orbit = scene.Add(planet);
+                moonOrbits[p * moonsPerPlanet + m] = orbit;
+                scene.Add(orbit, Compose(vec3(1.0f + 0.6f * m, 0.0f, 0.0f), quat(), vec3(0.3f, 0.3f, 1.0f)),
+                          squareBounds, square, vec4(0.7f, 0.7f, 0.7f, 1.0f));
+            }
+        }
 
-        GLCall(glUniform4f(location, 0.2f, 0.3f, 0.8f, 0.2f));
+        int framebufferWidth, framebufferHeight;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        float aspect = framebufferHeight > 0 ? (float)framebufferWidth / framebufferHeight : 1.0f;
+        const mat4 viewProjection = Orthographic(-aspect, aspect, -1.0f, 1.0f, -1.0f, 1.0f);
+        const frustum view = ExtractFrustum(viewProjection);
+        frustum_culler culler;
+
+        //Bodies under the cursor are found through a bvh over the scene, refit as they move
+        scene.Update();
+        bvh picker;
+        picker.Build(scene.GetWorldBounds(), scene.GetCount());
+        scene_node picked = invalidSceneNode;
+        vec4 pickedColor;
+        bool mouseWasDown = false;
 
         //Unbind all objects
         GLCall(glUseProgram(0));
         GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));  //Bind Buffer
         GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));  //Bind Buffer
 
+        std::cout << "Startup took " << std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - startupBegin).count() << " ms" << std::endl;
+
+        renderer squareRenderer;
+#ifdef SHADER_HOT_RELOAD
+        //Reloads have to happen on the GL thread, so development builds stay single threaded
+        command_list frameList;
+#else
+        //The GL context moves to its own thread, this one only records frames and polls events
+        render_thread renderThread(window, squareRenderer, 1, swapInterval);
+        renderThread.Start();
+#endif
+
+#ifdef ON_DEMAND_RENDERING
+        //Frames that would look like the last one are skipped, the loop sleeps in glfwWaitEventsTimeout
+        damage_tracker damage(window);
+#endif
+
+        //Simulated at a fixed 60 Hz whatever the render rate, frames blend the last two states
+        fixed_timestep simulation(1.0 / 60.0);
+        float previousR = 0.0f;
         float r = 0.0f;
         float increment = 0.05f;
+        float previousAngle = 0.0f;
+        float angle = 0.0f;
+        auto lastFrame = std::chrono::steady_clock::now();
+
+        //The first frames may still grow command lists and sort buffers to their final size
+        const unsigned int warmupFrames = 3;
+        unsigned int frameIndex = 0;
+
         // Loop until the user closes the window
         while (!glfwWindowShouldClose(window))
         {
+#ifdef SHADER_HOT_RELOAD
+            //Recompiling an edited shader allocates, so it stays out of the check below
+            if (shaderReload.Update())
+            {
+                shader = shaderReload.GetProgram(sceneHandle);
+                sceneUniforms = GetSceneUniforms(shader);
+#ifdef ON_DEMAND_RENDERING
+                damage.MarkDirty();
+#endif
+            }
+#endif
+
+            //With TRACK_ALLOCATIONS, a steady-state frame touching the heap stops the program
+            allocation_scope frameAllocations;
+
+#ifdef SHADER_HOT_RELOAD
+            command_list& frame = frameList;
+#else
+            command_list& frame = renderThread.BeginFrame();
+#endif
+
+            auto now = std::chrono::steady_clock::now();
+            double frameTime = std::chrono::duration<double>(now - lastFrame).count();
+            lastFrame = now;
+#ifdef BENCHMARK_FRAME_TIME
+            //Benchmarks run uncapped but every frame counts as the same amount of time,
+            //so the simulation and the visuals are identical from run to run
+            frameTime = BENCHMARK_FRAME_TIME;
+#endif
+
+            for (unsigned int step = simulation.Advance(frameTime); step > 0; step--)
+            {
+                previousR = r;
+                previousAngle = angle;
+                angle += 0.01f;
+
+                if (r > 1.0f)
+                    increment = -0.05f;
+                else if (r < 0.0f)
+                    increment = 0.05f;
+
+                r += increment;
+            }
+
+#ifdef ON_DEMAND_RENDERING
+            //Blending would change the picture every frame, show the latest step instead
+            float alpha = 1.0f;
+#else
+            float alpha = (float)simulation.GetAlpha();
+#endif
+            float renderedR = previousR + (r - previousR) * alpha;
+            float renderedAngle = previousAngle + (angle - previousAngle) * alpha;
+
+            //Only the orbits move; Update recomputes just them and what hangs below
+            const vec3 unitScale(1.0f, 1.0f, 1.0f);
+            const vec3 zAxis(0.0f, 0.0f, 1.0f);
+            for (unsigned int p = 0; p < planetCount; p++)
+                scene.SetLocal(planetOrbits[p], vec3(), AxisAngle(zAxis, renderedAngle / (1.0f + p)), unitScale);
+            for (unsigned int m = 0; m < planetCount * moonsPerPlanet; m++)
+                scene.SetLocal(moonOrbits[m], vec3(), AxisAngle(zAxis, renderedAngle * (3.0f + m)), unitScale);
+            scene.SetColor(sun, vec4(renderedR, 0.3f, 0.8f, 0.2f));
+            scene.Update();
+            picker.Refit(scene.GetWorldBounds());
+
+            //Clicking a body highlights it, clicking empty space clears the highlight
+            bool mouseDown = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+            if (mouseDown && !mouseWasDown)
+            {
+                double cursorX, cursorY;
+                int windowWidth, windowHeight;
+                glfwGetCursorPos(window, &cursorX, &cursorY);
+                glfwGetWindowSize(window, &windowWidth, &windowHeight);
+                ray pick = MakePickingRay(viewProjection, (float)(2.0 * cursorX / windowWidth - 1.0),
+                                          (float)(1.0 - 2.0 * cursorY / windowHeight));
+
+                if (picked != invalidSceneNode)
+                    scene.SetColor(picked, pickedColor);
+                ray_hit hit;
+                picked = picker.Raycast(pick, INFINITY, hit) ? scene.GetNode(hit.Index) : invalidSceneNode;
+                if (picked != invalidSceneNode)
+                    pickedColor = scene.GetColor(picked);
+            }
+            mouseWasDown = mouseDown;
+            if (picked != invalidSceneNode)
+                scene.SetColor(picked, vec4(1.0f, 1.0f, 1.0f, 1.0f));
+
+            //The outer planets and their moons swing past the top and bottom edges, only what is on screen gets drawn
+            culler.Cull(view, scene.GetWorldBounds(), scene.GetCount());
+            scene.Submit(frame, viewProjection, shader, sceneUniforms, culler.GetVisible(), culler.GetVisibleCount());
+
+#ifdef ON_DEMAND_RENDERING
+            if (!damage.Prepare(frame))
+            {
+                //Nothing to show: the list is simply recorded again next time, sleep until
+                //an event arrives or the simulation takes its next step
+                frame.Clear();
+                glfwWaitEventsTimeout(simulation.GetTimeToNextStep());
+                continue;
+            }
+#endif
+
+#ifdef SHADER_HOT_RELOAD
             // Render here 
-            GLCall(glClear(GL_COLOR_BUFFER_BIT));
-
-            GLCall(glUseProgram(shader)); //bind shader
-
-            GLCall(glUniform4f(location, r, 0.3f, 0.8f, 0.2f)); //setupi uniforms
-
-            GLCall(glBindVertexArray(vao));  //Bind vertex Buffer
-
-            ib.bind();;  //Bind index Buffer
-
-            GLCall(glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr));
-
-            if (r > 1.0f)
-                increment = -0.05f;
-            else if (r < 0.0f)
-                increment = 0.05f;
-        
-            r += increment;
+#ifdef ON_DEMAND_RENDERING
+            squareRenderer.ApplyScissor(frame, frame.HasScissor() ? QueryBufferAge(window) : 0);
+#else
+            squareRenderer.ApplyScissor(frame);
+#endif
+            squareRenderer.Clear();
+            squareRenderer.Execute(frame);
+            frame.Clear();
 
             // Swap front and back buffers 
             glfwSwapBuffers(window);
+#ifdef GL_TRACE
+            MarkGLTraceFrame();
+#endif
+#else
+            renderThread.EndFrame();
+#endif
 
             // Poll for and process events 
             glfwPollEvents();
+
+            pacer.EndFrame();
+
+            if (frameIndex++ >= warmupFrames && frameAllocations.GetCount() != 0)
+            {
+                std::cout << "[Frame " << frameIndex << "] " << frameAllocations.GetCount()
+                    << " heap allocations in the render loop" << std::endl;
+                ASSERT(false);
+            }
         }
 
-        GLCall(glDeleteProgram(shader));
+        frame_pacing_stats pacing = pacer.GetStats();
+        std::cout << "Frame time " << pacing.MeanMs << " ms, jitter " << pacing.JitterMs << " ms (min "
+            << pacing.MinMs << ", max " << pacing.MaxMs << ") over " << pacing.Frames << " frames" << std::endl;
+#ifdef ON_DEMAND_RENDERING
+        std::cout << damage.GetSkippedFrames() << " frames skipped as unchanged" << std::endl;
+#endif
+
+#ifndef SHADER_HOT_RELOAD
+        renderThread.Stop();
+#endif
     } //This scope is to terminate the instance once window is closed
 
+#ifdef GL_TRACE
+    EndGLTrace();
+#endif
+
     glfwTerminate();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,663 @@
+#include "bvh.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "job_system.h"
+
+
+//Bins of box centers per axis the split candidates are taken from, fewer for nodes with fewer boxes
+static const unsigned int binCount = 16;
+//Nodes with at most this many boxes may stay leaves when splitting doesn't pay off
+static const unsigned int maxLeafSize = 8;
+//Cost of visiting a node relative to testing one box
+static const float traversalCost = 1.0f;
+//Below this depth nodes are halved at the median instead, keeping traversal stacks bounded
+static const unsigned int maxSahDepth = 64;
+static const unsigned int traversalStackSize = 128;
+//Nodes with more boxes than this are binned and partitioned with parallel passes
+static const unsigned int parallelBuildThreshold = 16384;
+//Boxes per job in those passes and in Refit
+static const unsigned int buildChunkSize = 16384;
+
+struct sah_bins
+{
+    aabb Bounds[3][binCount];
+    unsigned int Count[3][binCount];
+
+    explicit sah_bins(unsigned int bins = binCount)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            std::fill(Bounds[axis], Bounds[axis] + bins, EmptyAABB());
+            std::fill(Count[axis], Count[axis] + bins, 0u);
+        }
+    }
+};
+
+static inline float GetCenter(const aabb& box, int axis)
+{
+    return (box.Min[axis] + box.Max[axis]) * 0.5f;
+}
+
+static inline unsigned int GetBin(float center, float min, float scale, unsigned int bins)
+{
+    return std::min(bins - 1, (unsigned int)((center - min) * scale));
+}
+
+//Union without the NaN handling of fmin and fmax, which costs a library call per component
+static inline aabb Grow(const aabb& a, const aabb& b)
+{
+    return { vec3(a.Min.X < b.Min.X ? a.Min.X : b.Min.X, a.Min.Y < b.Min.Y ? a.Min.Y : b.Min.Y, a.Min.Z < b.Min.Z ? a.Min.Z : b.Min.Z),
+             vec3(a.Max.X > b.Max.X ? a.Max.X : b.Max.X, a.Max.Y > b.Max.Y ? a.Max.Y : b.Max.Y, a.Max.Z > b.Max.Z ? a.Max.Z : b.Max.Z) };
+}
+
+static inline aabb Grow(const aabb& a, const vec3& p)
+{
+    return Grow(a, aabb{ p, p });
+}
+
+static inline bool SameBounds(const aabb& a, const aabb& b)
+{
+    return a.Min.X == b.Min.X && a.Min.Y == b.Min.Y && a.Min.Z == b.Min.Z &&
+           a.Max.X == b.Max.X && a.Max.Y == b.Max.Y && a.Max.Z == b.Max.Z;
+}
+
+//Calls fn(begin, end) for chunks of [begin, begin + count), in parallel with a job system
+template<typename Function>
+static void ForChunks(job_system* jobs, unsigned int begin, unsigned int count, const Function& fn)
+{
+    unsigned int chunks = (count + buildChunkSize - 1) / buildChunkSize;
+    auto chunk = [&](unsigned int c)
+    {
+        unsigned int chunkBegin = begin + c * buildChunkSize;
+        fn(c, chunkBegin, std::min(chunkBegin + buildChunkSize, begin + count));
+    };
+    if (jobs && chunks > 1)
+        jobs->ParallelFor(chunks, 1, chunk);
+    else
+    {
+        for (unsigned int c = 0; c < chunks; c++)
+            chunk(c);
+    }
+}
+
+ray MakePickingRay(const mat4& viewProjection, float x, float y)
+{
+    mat4 inverse = Inverse(viewProjection);
+    vec4 nearPoint = inverse * vec4(x, y, -1.0f, 1.0f);
+    vec4 farPoint = inverse * vec4(x, y, 1.0f, 1.0f);
+    vec3 origin = nearPoint.XYZ() * (1.0f / nearPoint.W);
+    vec3 target = farPoint.XYZ() * (1.0f / farPoint.W);
+    return { origin, Normalize(target - origin) };
+}
+
+bvh::bvh(job_system* jobs)
+    : m_SceneCount(0), m_Jobs(jobs)
+{
+    m_Nodes.push_back({ EmptyAABB(), 0, 0, 0, 0 });
+}
+
+void bvh::Build(const scene_bounds& bounds, unsigned int count)
+{
+    m_SceneCount = count;
+    m_References.clear();
+    for (unsigned int i = 0; i < count; i++)
+    {
+        aabb box = { vec3(bounds.MinX[i], bounds.MinY[i], bounds.MinZ[i]), vec3(bounds.MaxX[i], bounds.MaxY[i], bounds.MaxZ[i]) };
+        if (!box.IsEmpty())
+            m_References.push_back({ box, i });
+    }
+
+    unsigned int primitives = (unsigned int)m_References.size();
+    m_Partitioned.resize(primitives);
+    m_Nodes.clear();
+    m_Nodes.push_back({ EmptyAABB(), 0, 0, primitives, 0 });
+    m_Subtrees.clear();
+    m_TopNodes.clear();
+    if (primitives == 0)
+    {
+        //Nothing to split: an empty leaf that every query misses
+        m_SubtreeStart.assign(1, 1u);
+        m_Primitives.clear();
+        m_PrimitiveBounds.clear();
+        m_PrimitiveLeaf.clear();
+        m_Slot.assign(count, noSlot);
+        return;
+    }
+
+    //Large nodes are split with parallel passes until the pieces are small enough to be one job each
+    std::vector<unsigned int> subtreeDepths;
+    std::vector<std::pair<unsigned int, unsigned int>> pending(1, { 0u, 0u }); //node, depth
+    while (!pending.empty())
+    {
+        unsigned int index = pending.back().first;
+        unsigned int depth = pending.back().second;
+        pending.pop_back();
+        if (m_Jobs && m_Nodes[index].Count > parallelBuildThreshold && SplitNode(m_Nodes, index, depth, true))
+        {
+            m_TopNodes.push_back(index);
+            pending.push_back({ m_Nodes[index].Child + 1, depth + 1 });
+            pending.push_back({ m_Nodes[index].Child, depth + 1 });
+        }
+        else
+        {
+            m_Subtrees.push_back(index);
+            subtreeDepths.push_back(depth);
+        }
+    }
+
+    //Each subtree is built into a list of its own, starting with a copy of its root,
+    //and the lists are then placed one after the other behind the top nodes, so the
+    //nodes of a subtree form one range that Refit can sweep backwards
+    unsigned int subtrees = (unsigned int)m_Subtrees.size();
+    if (m_SubtreeNodes.size() < subtrees)
+        m_SubtreeNodes.resize(subtrees);
+    auto build = [&](unsigned int s)
+    {
+        //A binary tree with at least one box per leaf has at most 2n - 1 nodes, so the list never moves
+        std::vector<node>& nodes = m_SubtreeNodes[s];
+        const node& root = m_Nodes[m_Subtrees[s]];
+        nodes.clear();
+        nodes.reserve(std::max(1u, root.Count * 2 - 1));
+        nodes.push_back(root);
+        BuildSubtree(nodes, 0, subtreeDepths[s]);
+    };
+    if (m_Jobs && subtrees > 1)
+        m_Jobs->ParallelFor(subtrees, 1, build);
+    else
+    {
+        for (unsigned int s = 0; s < subtrees; s++)
+            build(s);
+    }
+
+    m_SubtreeStart.resize(subtrees + 1);
+    m_SubtreeStart[0] = (unsigned int)m_Nodes.size();
+    for (unsigned int s = 0; s < subtrees; s++)
+        m_SubtreeStart[s + 1] = m_SubtreeStart[s] + (unsigned int)m_SubtreeNodes[s].size() - 1;
+    m_Nodes.resize(m_SubtreeStart[subtrees]);
+    m_PrimitiveLeaf.resize(primitives);
+
+    auto place = [&](unsigned int s)
+    {
+        //Node k of the list goes to offset + k, except the root, which stays where it is
+        const std::vector<node>& nodes = m_SubtreeNodes[s];
+        unsigned int root = m_Subtrees[s];
+        unsigned int offset = m_SubtreeStart[s] - 1;
+        for (unsigned int k = 0; k < (unsigned int)nodes.size(); k++)
+        {
+            node n = nodes[k];
+            unsigned int index = k == 0 ? root : offset + k;
+            if (n.Child)
+                n.Child += offset;
+            if (k > 0)
+                n.Parent = n.Parent == 0 ? root : n.Parent + offset;
+            m_Nodes[index] = n;
+
+            if (!n.Child)
+            {
+                for (unsigned int p = n.Begin; p < n.Begin + n.Count; p++)
+                    m_PrimitiveLeaf[p] = index;
+            }
+        }
+    };
+    if (m_Jobs && subtrees > 1)
+        m_Jobs->ParallelFor(subtrees, 1, place);
+    else
+    {
+        for (unsigned int s = 0; s < subtrees; s++)
+            place(s);
+    }
+
+    m_Primitives.resize(primitives);
+    m_PrimitiveBounds.resize(primitives);
+    m_Slot.assign(count, noSlot);
+    for (unsigned int p = 0; p < primitives; p++)
+    {
+        m_Primitives[p] = m_References[p].Index;
+        m_PrimitiveBounds[p] = m_References[p].Bounds;
+        m_Slot[m_References[p].Index] = p;
+    }
+}
+
+void bvh::AllocateChildren(std::vector<node>& nodes, unsigned int parent, unsigned int leftCount)
+{
+    node n = nodes[parent];
+    unsigned int child = (unsigned int)nodes.size();
+    nodes.push_back({ EmptyAABB(), 0, n.Begin, leftCount, parent });
+    nodes.push_back({ EmptyAABB(), 0, n.Begin + leftCount, n.Count - leftCount, parent });
+    nodes[parent].Child = child;
+}
+
+bool bvh::FindSplit(const node& n, const aabb& centers, bool parallel, split& best)
+{
+    const unsigned int binsUsed = std::min(binCount, n.Count);
+    float scale[3];
+    for (int axis = 0; axis < 3; axis++)
+    {
+        float extent = centers.Max[axis] - centers.Min[axis];
+        scale[axis] = extent > 0.0f ? binsUsed / extent : 0.0f;
+    }
+
+    auto fill = [&](sah_bins& bins, unsigned int begin, unsigned int end)
+    {
+        for (unsigned int p = begin; p < end; p++)
+        {
+            const aabb& box = m_References[p].Bounds;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                unsigned int bin = GetBin(GetCenter(box, axis), centers.Min[axis], scale[axis], binsUsed);
+                bins.Bounds[axis][bin] = Grow(bins.Bounds[axis][bin], box);
+                bins.Count[axis][bin]++;
+            }
+        }
+    };
+
+    sah_bins bins(binsUsed);
+    if (parallel)
+    {
+        std::vector<sah_bins> chunkBins((n.Count + buildChunkSize - 1) / buildChunkSize);
+        ForChunks(m_Jobs, n.Begin, n.Count, [&](unsigned int chunk, unsigned int begin, unsigned int end)
+        {
+            fill(chunkBins[chunk], begin, end);
+        });
+        for (const sah_bins& chunk : chunkBins)
+            for (int axis = 0; axis < 3; axis++)
+                for (unsigned int bin = 0; bin < binsUsed; bin++)
+                {
+                    bins.Bounds[axis][bin] = Grow(bins.Bounds[axis][bin], chunk.Bounds[axis][bin]);
+                    bins.Count[axis][bin] += chunk.Count[axis][bin];
+                }
+    }
+    else
+    {
+        fill(bins, n.Begin, n.Begin + n.Count);
+    }
+
+    //Cost of a split between bins: visiting the node plus testing each half's boxes,
+    //weighted by the chance of hitting it, i.e. its surface area
+    bool found = false;
+    best.Cost = INFINITY;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        if (scale[axis] == 0.0f)
+            continue;
+
+        float rightCost[binCount];
+        aabb right = EmptyAABB();
+        unsigned int rightCount = 0;
+        for (unsigned int bin = binsUsed - 1; bin > 0; bin--)
+        {
+            right = Grow(right, bins.Bounds[axis][bin]);
+            rightCount += bins.Count[axis][bin];
+            rightCost[bin] = rightCount > 0 ? SurfaceArea(right) * rightCount : 0.0f;
+        }
+
+        aabb left = EmptyAABB();
+        unsigned int leftCount = 0;
+        for (unsigned int bin = 1; bin < binsUsed; bin++)
+        {
+            left = Grow(left, bins.Bounds[axis][bin - 1]);
+            leftCount += bins.Count[axis][bin - 1];
+            if (leftCount == 0 || leftCount == n.Count)
+                continue;
+
+            float cost = traversalCost * SurfaceArea(n.Bounds) + SurfaceArea(left) * leftCount + rightCost[bin];
+            if (cost < best.Cost)
+            {
+                best = { axis, bin, binsUsed, cost };
+                found = true;
+            }
+        }
+    }
+    return found;
+}
+
+bool bvh::SplitNode(std::vector<node>& nodes, unsigned int index, unsigned int depth, bool parallel)
+{
+    node& n = nodes[index];
+    aabb bounds = EmptyAABB(), centers = EmptyAABB();
+    if (parallel)
+    {
+        std::vector<aabb> chunkBounds((n.Count + buildChunkSize - 1) / buildChunkSize * 2, EmptyAABB());
+        ForChunks(m_Jobs, n.Begin, n.Count, [&](unsigned int chunk, unsigned int begin, unsigned int end)
+        {
+            for (unsigned int p = begin; p < end; p++)
+            {
+                chunkBounds[chunk * 2] = Grow(chunkBounds[chunk * 2], m_References[p].Bounds);
+                chunkBounds[chunk * 2 + 1] = Grow(chunkBounds[chunk * 2 + 1], m_References[p].Bounds.GetCenter());
+            }
+        });
+        for (size_t c = 0; c < chunkBounds.size(); c += 2)
+        {
+            bounds = Grow(bounds, chunkBounds[c]);
+            centers = Grow(centers, chunkBounds[c + 1]);
+        }
+    }
+    else
+    {
+        for (unsigned int p = n.Begin; p < n.Begin + n.Count; p++)
+        {
+            bounds = Grow(bounds, m_References[p].Bounds);
+            centers = Grow(centers, m_References[p].Bounds.GetCenter());
+        }
+    }
+    n.Bounds = bounds;
+
+    if (n.Count <= 1)
+    {
+        n.Child = 0;
+        return false;
+    }
+
+    //Small nodes stay leaves unless a split is cheaper than testing all their boxes
+    split best;
+    bool found = depth < maxSahDepth && FindSplit(n, centers, parallel, best);
+    if (n.Count <= maxLeafSize && (!found || best.Cost >= SurfaceArea(bounds) * n.Count))
+    {
+        n.Child = 0;
+        return false;
+    }
+
+    reference* references = m_References.data() + n.Begin;
+    unsigned int leftCount;
+    if (!found)
+    {
+        //Too deep, or every center in the same spot: halve at the median of the widest axis
+        vec3 extent = centers.Max - centers.Min;
+        int axis = extent.X >= extent.Y && extent.X >= extent.Z ? 0 : (extent.Y >= extent.Z ? 1 : 2);
+        leftCount = n.Count / 2;
+        std::nth_element(references, references + leftCount, references + n.Count, [axis](const reference& a, const reference& b)
+        {
+            return GetCenter(a.Bounds, axis) < GetCenter(b.Bounds, axis);
+        });
+    }
+    else
+    {
+        float min = centers.Min[best.Axis];
+        float scale = best.Bins / (centers.Max[best.Axis] - min);
+        auto isLeft = [&](const reference& r) { return GetBin(GetCenter(r.Bounds, best.Axis), min, scale, best.Bins) < best.Bin; };
+
+        if (parallel)
+        {
+            //Count per chunk, then scatter both sides to where the counts put them and copy back
+            unsigned int chunks = (n.Count + buildChunkSize - 1) / buildChunkSize;
+            std::vector<unsigned int> leftOffsets(chunks + 1, 0), rightOffsets(chunks + 1, 0);
+            ForChunks(m_Jobs, n.Begin, n.Count, [&](unsigned int chunk, unsigned int begin, unsigned int end)
+            {
+                unsigned int lefts = (unsigned int)std::count_if(m_References.begin() + begin, m_References.begin() + end, isLeft);
+                leftOffsets[chunk + 1] = lefts;
+                rightOffsets[chunk + 1] = end - begin - lefts;
+            });
+            for (unsigned int chunk = 0; chunk < chunks; chunk++)
+            {
+                leftOffsets[chunk + 1] += leftOffsets[chunk];
+                rightOffsets[chunk + 1] += rightOffsets[chunk];
+            }
+            leftCount = leftOffsets[chunks];
+
+            ForChunks(m_Jobs, n.Begin, n.Count, [&](unsigned int chunk, unsigned int begin, unsigned int end)
+            {
+                reference* left = m_Partitioned.data() + n.Begin + leftOffsets[chunk];
+                reference* right = m_Partitioned.data() + n.Begin + leftCount + rightOffsets[chunk];
+                for (unsigned int p = begin; p < end; p++)
+                {
+                    if (isLeft(m_References[p]))
+                        *left++ = m_References[p];
+                    else
+                        *right++ = m_References[p];
+                }
+            });
+            ForChunks(m_Jobs, n.Begin, n.Count, [&](unsigned int, unsigned int begin, unsigned int end)
+            {
+                std::copy(m_Partitioned.begin() + begin, m_Partitioned.begin() + end, m_References.begin() + begin);
+            });
+        }
+        else
+        {
+            leftCount = (unsigned int)(std::partition(references, references + n.Count, isLeft) - references);
+        }
+    }
+
+    AllocateChildren(nodes, index, leftCount);
+    return true;
+}
+
+void bvh::BuildSubtree(std::vector<node>& nodes, unsigned int index, unsigned int depth)
+{
+    if (SplitNode(nodes, index, depth, false))
+    {
+        unsigned int child = nodes[index].Child;
+        BuildSubtree(nodes, child, depth + 1);
+        BuildSubtree(nodes, child + 1, depth + 1);
+    }
+}
+
+aabb bvh::ComputeBounds(unsigned int index) const
+{
+    const node& n = m_Nodes[index];
+    if (n.Child)
+        return Grow(m_Nodes[n.Child].Bounds, m_Nodes[n.Child + 1].Bounds);
+
+    aabb bounds = EmptyAABB();
+    for (unsigned int p = n.Begin; p < n.Begin + n.Count; p++)
+        bounds = Grow(bounds, m_PrimitiveBounds[p]);
+    return bounds;
+}
+
+void bvh::Refit(const scene_bounds& bounds)
+{
+    //Read in storage order and scattered, so only the writes jump around
+    ForChunks(m_Jobs, 0, m_SceneCount, [&](unsigned int, unsigned int begin, unsigned int end)
+    {
+        for (unsigned int i = begin; i < end; i++)
+        {
+            unsigned int p = m_Slot[i];
+            if (p != noSlot)
+                m_PrimitiveBounds[p] = { vec3(bounds.MinX[i], bounds.MinY[i], bounds.MinZ[i]),
+                                         vec3(bounds.MaxX[i], bounds.MaxY[i], bounds.MaxZ[i]) };
+        }
+    });
+
+    //Every subtree's range from the back, children come after their parents, then
+    //its root and finally the few nodes above the roots
+    auto refit = [&](unsigned int s)
+    {
+        for (unsigned int i = m_SubtreeStart[s + 1]; i > m_SubtreeStart[s]; i--)
+            m_Nodes[i - 1].Bounds = ComputeBounds(i - 1);
+        m_Nodes[m_Subtrees[s]].Bounds = ComputeBounds(m_Subtrees[s]);
+    };
+    unsigned int subtrees = (unsigned int)m_Subtrees.size();
+    if (m_Jobs && subtrees > 1)
+        m_Jobs->ParallelFor(subtrees, 1, refit);
+    else
+    {
+        for (unsigned int s = 0; s < subtrees; s++)
+            refit(s);
+    }
+    for (size_t t = m_TopNodes.size(); t > 0; t--)
+        m_Nodes[m_TopNodes[t - 1]].Bounds = ComputeBounds(m_TopNodes[t - 1]);
+}
+
+void bvh::Refit(const scene_bounds& bounds, const unsigned int* indices, unsigned int count)
+{
+    for (unsigned int k = 0; k < count; k++)
+    {
+        unsigned int i = indices[k];
+        if (i >= m_SceneCount || m_Slot[i] == noSlot)
+            continue;
+
+        unsigned int p = m_Slot[i];
+        m_PrimitiveBounds[p] = { vec3(bounds.MinX[i], bounds.MinY[i], bounds.MinZ[i]), vec3(bounds.MaxX[i], bounds.MaxY[i], bounds.MaxZ[i]) };
+
+        //Up from the leaf until a node's bounds come out the same, everything above then is current too
+        unsigned int index = m_PrimitiveLeaf[p];
+        while (true)
+        {
+            node& n = m_Nodes[index];
+            aabb refit = ComputeBounds(index);
+            if (SameBounds(refit, n.Bounds))
+                break;
+            n.Bounds = refit;
+            if (index == 0)
+                break;
+            index = n.Parent;
+        }
+    }
+}
+
+//Drops the planes the box is entirely in front of from planes, false if it is entirely behind one
+static inline bool ClassifyBox(const frustum& f, const aabb& box, unsigned int& planes)
+{
+    for (int p = 0; p < 6; p++)
+    {
+        if (!(planes & (1u << p)))
+            continue;
+
+        //Nearest and furthest corners along the plane's normal
+        const vec4& plane = f.Planes[p];
+        vec3 furthest(plane.X >= 0.0f ? box.Max.X : box.Min.X, plane.Y >= 0.0f ? box.Max.Y : box.Min.Y, plane.Z >= 0.0f ? box.Max.Z : box.Min.Z);
+        vec3 nearest(plane.X >= 0.0f ? box.Min.X : box.Max.X, plane.Y >= 0.0f ? box.Min.Y : box.Max.Y, plane.Z >= 0.0f ? box.Min.Z : box.Max.Z);
+        if (!(plane.X * furthest.X + plane.Y * furthest.Y + plane.Z * furthest.Z + plane.W >= 0.0f))
+            return false;
+        if (plane.X * nearest.X + plane.Y * nearest.Y + plane.Z * nearest.Z + plane.W >= 0.0f)
+            planes &= ~(1u << p);
+    }
+    return true;
+}
+
+void bvh::Cull(const frustum& f, std::vector<unsigned int>& visible) const
+{
+    visible.clear();
+    if (m_Primitives.empty())
+        return;
+
+    struct entry
+    {
+        unsigned int Node;
+        unsigned int Planes; //still to test, the box is in front of the others
+    };
+    entry stack[traversalStackSize];
+    unsigned int size = 0;
+    stack[size++] = { 0, 0x3f };
+    while (size > 0)
+    {
+        entry top = stack[--size];
+        const node& n = m_Nodes[top.Node];
+        if (!ClassifyBox(f, n.Bounds, top.Planes))
+            continue;
+
+        if (top.Planes == 0)
+            visible.insert(visible.end(), m_Primitives.begin() + n.Begin, m_Primitives.begin() + n.Begin + n.Count);
+        else if (n.Child)
+        {
+            stack[size++] = { n.Child + 1, top.Planes };
+            stack[size++] = { n.Child, top.Planes };
+        }
+        else
+        {
+            for (unsigned int p = n.Begin; p < n.Begin + n.Count; p++)
+            {
+                unsigned int planes = top.Planes;
+                if (ClassifyBox(f, m_PrimitiveBounds[p], planes))
+                    visible.push_back(m_Primitives[p]);
+            }
+        }
+    }
+}
+
+//Distance to where the ray enters the box within limit, INFINITY if it misses. The slab
+//of each axis is entered at the near side for the ray's direction, which also makes
+//empty boxes miss; NaNs, from 0 * infinity on an edge, leave the interval as it is.
+static inline float IntersectRay(const aabb& box, const vec3& origin, const vec3& inverse, const bool negative[3], float limit)
+{
+    float enter = 0.0f, exit = limit;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        float nearSide = ((negative[axis] ? box.Max : box.Min)[axis] - origin[axis]) * inverse[axis];
+        float farSide = ((negative[axis] ? box.Min : box.Max)[axis] - origin[axis]) * inverse[axis];
+        if (nearSide > enter)
+            enter = nearSide;
+        if (farSide < exit)
+            exit = farSide;
+    }
+    return enter <= exit ? enter : INFINITY;
+}
+
+bool bvh::Raycast(const ray& r, float maxDistance, ray_hit& hit) const
+{
+    if (m_Primitives.empty())
+        return false;
+
+    vec3 inverse(1.0f / r.Direction.X, 1.0f / r.Direction.Y, 1.0f / r.Direction.Z);
+    const bool negative[3] = { inverse.X < 0.0f, inverse.Y < 0.0f, inverse.Z < 0.0f };
+    hit = { noSlot, maxDistance };
+
+    struct entry
+    {
+        unsigned int Node;
+        float Distance;
+    };
+    entry stack[traversalStackSize];
+    unsigned int size = 0;
+    float rootDistance = IntersectRay(m_Nodes[0].Bounds, r.Origin, inverse, negative, maxDistance);
+    if (rootDistance != INFINITY)
+        stack[size++] = { 0, rootDistance };
+
+    while (size > 0)
+    {
+        entry top = stack[--size];
+        //A closer hit was found since this node was pushed
+        if (top.Distance > hit.Distance)
+            continue;
+
+        const node& n = m_Nodes[top.Node];
+        if (!n.Child)
+        {
+            for (unsigned int p = n.Begin; p < n.Begin + n.Count; p++)
+            {
+                float distance = IntersectRay(m_PrimitiveBounds[p], r.Origin, inverse, negative, hit.Distance);
+                if (distance != INFINITY && (distance < hit.Distance || hit.Index == noSlot))
+                    hit = { m_Primitives[p], distance };
+            }
+            continue;
+        }
+
+        //The nearer child is popped first, so the other one can often be skipped
+        float left = IntersectRay(m_Nodes[n.Child].Bounds, r.Origin, inverse, negative, hit.Distance);
+        float right = IntersectRay(m_Nodes[n.Child + 1].Bounds, r.Origin, inverse, negative, hit.Distance);
+        entry nearer = { n.Child, left }, further = { n.Child + 1, right };
+        if (right < left)
+            std::swap(nearer, further);
+        if (further.Distance != INFINITY)
+            stack[size++] = further;
+        if (nearer.Distance != INFINITY)
+            stack[size++] = nearer;
+    }
+    return hit.Index != noSlot;
+}
+
+unsigned int bvh::GetDepth() const
+{
+    //Children always come after their parent
+    std::vector<unsigned int> depths(m_Nodes.size(), 1);
+    unsigned int depth = 1;
+    for (size_t i = 1; i < m_Nodes.size(); i++)
+    {
+        depths[i] = depths[m_Nodes[i].Parent] + 1;
+        depth = std::max(depth, depths[i]);
+    }
+    return depth;
+}
+
+float bvh::GetCost() const
+{
+    float rootArea = SurfaceArea(m_Nodes[0].Bounds);
+    if (m_Primitives.empty() || !(rootArea > 0.0f))
+        return 0.0f;
+
+    float cost = 0.0f;
+    for (const node& n : m_Nodes)
+        cost += SurfaceArea(n.Bounds) * (n.Child ? traversalCost : (float)n.Count);
+    return cost / rootArea;
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <vector>
+
+#include "simd_math.h"
+#include "scene_graph.h"
+#include "frustum_culler.h"
+
+class job_system;
+
+struct ray
+{
+	vec3 Origin;
+	vec3 Direction; //unit length, so hit distances are in world units
+};
+
+//Ray through a point of the screen in normalized device coordinates, from the near to the far plane
+ray MakePickingRay(const mat4& viewProjection, float x, float y);
+
+struct ray_hit
+{
+	unsigned int Index; //storage index in the scene graph
+	float Distance;     //along the ray to where it enters the box, 0 when it starts inside
+};
+
+//Bounding volume hierarchy over the world bounds of a scene graph's nodes, for
+//culling and picking that skip whole groups of nodes at once instead of testing
+//every one of them.
+//
+//Build splits nodes with the surface area heuristic, evaluated over up to 16 bins of
+//the box centers per axis. Given a job system, the large nodes near the root are
+//binned and partitioned in parallel and the subtrees below them are built one per
+//job. Refit keeps the tree and recomputes bounds after things moved, either all
+//of them or, walking up from the leaves, only those of the listed nodes; the tree
+//gets worse as nodes drift from where they were at build time, so rebuild after
+//large changes. Nodes with empty bounds at build time are left out, as are nodes
+//added later; rebuild after adding nodes or giving bounds to one without.
+//
+//Queries are const and can run concurrently.
+class bvh
+{
+private:
+	struct node
+	{
+		aabb Bounds;
+		unsigned int Child;  //first of two consecutive children, 0 for leaves
+		unsigned int Begin;  //primitives of the whole subtree, [Begin, Begin + Count) of m_Primitives
+		unsigned int Count;
+		unsigned int Parent;
+	};
+
+	//Primitive while building: its box and storage index
+	struct reference
+	{
+		aabb Bounds;
+		unsigned int Index;
+	};
+
+	struct split
+	{
+		int Axis;
+		unsigned int Bin; //primitives in bins below go left
+		unsigned int Bins;
+		float Cost;
+	};
+
+	std::vector<node> m_Nodes;
+	std::vector<unsigned int> m_Primitives;    //storage indices, grouped by leaf
+	std::vector<aabb> m_PrimitiveBounds;       //in the same order
+	std::vector<unsigned int> m_PrimitiveLeaf; //leaf of each primitive
+	std::vector<unsigned int> m_Slot;          //storage index to position in m_Primitives, noSlot if left out
+	std::vector<unsigned int> m_Subtrees;      //roots of the subtrees built, and refit, as one job each
+	std::vector<unsigned int> m_SubtreeStart;  //first node below each of those roots, plus the end
+	std::vector<unsigned int> m_TopNodes;      //inner nodes above them, parents before children
+	unsigned int m_SceneCount;
+	job_system* m_Jobs;
+
+	//Build state, only valid during Build
+	std::vector<reference> m_References;
+	std::vector<reference> m_Partitioned;
+	std::vector<std::vector<node>> m_SubtreeNodes;
+
+	static constexpr unsigned int noSlot = ~0u;
+
+	void AllocateChildren(std::vector<node>& nodes, unsigned int parent, unsigned int leftCount);
+	bool FindSplit(const node& n, const aabb& centers, bool parallel, split& best);
+	//Splits a node in two, or turns it into a leaf; returns false for a leaf
+	bool SplitNode(std::vector<node>& nodes, unsigned int index, unsigned int depth, bool parallel);
+	void BuildSubtree(std::vector<node>& nodes, unsigned int index, unsigned int depth);
+	//Bounds of a node from its children or its boxes
+	aabb ComputeBounds(unsigned int index) const;
+
+public:
+	//Without a job system Build and Refit run on the calling thread
+	explicit bvh(job_system* jobs = nullptr);
+
+	bvh(const bvh&) = delete;
+	bvh& operator=(const bvh&) = delete;
+
+	//Rebuilds the tree over boxes [0, count), normally scene_graph::GetWorldBounds after Update
+	void Build(const scene_bounds& bounds, unsigned int count);
+
+	//New bounds for every box of the last Build, tree unchanged
+	void Refit(const scene_bounds& bounds);
+	//New bounds for the boxes at indices only, parents are updated up to where they stop changing
+	void Refit(const scene_bounds& bounds, const unsigned int* indices, unsigned int count);
+
+	//Storage indices of the boxes that may be visible, like frustum_culler but in tree order.
+	//Subtrees entirely inside the frustum are taken whole, without testing their boxes.
+	void Cull(const frustum& f, std::vector<unsigned int>& visible) const;
+
+	//Closest box the ray enters within maxDistance, false if none
+	bool Raycast(const ray& r, float maxDistance, ray_hit& hit) const;
+
+	inline unsigned int GetNodeCount() const { return (unsigned int)m_Nodes.size(); }
+	inline unsigned int GetPrimitiveCount() const { return (unsigned int)m_Primitives.size(); }
+	inline const aabb& GetBounds() const { return m_Nodes[0].Bounds; }
+	//Number of nodes on the longest path from the root to a leaf
+	unsigned int GetDepth() const;
+	//Sum of node surface areas relative to the root's, weighted like the build's cost model
+	float GetCost() const;
+};
\ No newline at end of file
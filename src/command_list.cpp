@@ -0,0 +1,79 @@
+#include "command_list.h"
+
+
+void command_list::Submit(uint64_t sortKey, unsigned int program, unsigned int vertexArray, const index_buffer& ib,
+                          const draw_uniform* uniforms, unsigned int uniformCount)
+{
+    draw_command command;
+    command.SortKey = sortKey;
+    command.Program = program;
+    command.VertexArray = vertexArray;
+    command.IndexBuffer = &ib;
+    command.UniformOffset = (unsigned int)m_Uniforms.size();
+    command.UniformCount = uniformCount;
+    command.InstanceCount = 0;
+
+    m_Uniforms.insert(m_Uniforms.end(), uniforms, uniforms + uniformCount);
+    m_Commands.push_back(command);
+}
+
+void command_list::SubmitInstanced(uint64_t sortKey, unsigned int program, unsigned int vertexArray, const index_buffer& ib,
+                                   unsigned int instanceCount, const draw_uniform* uniforms, unsigned int uniformCount)
+{
+    if (instanceCount == 0)
+        return;
+
+    Submit(sortKey, program, vertexArray, ib, uniforms, uniformCount);
+    m_Commands.back().InstanceCount = instanceCount;
+}
+
+void command_list::Append(const command_list& other)
+{
+    unsigned int uniformBase = (unsigned int)m_Uniforms.size();
+    size_t first = m_Commands.size();
+
+    m_Uniforms.insert(m_Uniforms.end(), other.m_Uniforms.begin(), other.m_Uniforms.end());
+    m_Commands.insert(m_Commands.end(), other.m_Commands.begin(), other.m_Commands.end());
+
+    for (size_t i = first; i < m_Commands.size(); i++)
+        m_Commands[i].UniformOffset += uniformBase;
+}
+
+bool command_list::HasSameDraws(const command_list& other) const
+{
+    if (m_Commands.size() != other.m_Commands.size() || m_Uniforms.size() != other.m_Uniforms.size())
+        return false;
+
+    for (size_t i = 0; i < m_Commands.size(); i++)
+    {
+        const draw_command& a = m_Commands[i];
+        const draw_command& b = other.m_Commands[i];
+        if (a.SortKey != b.SortKey || a.Program != b.Program || a.VertexArray != b.VertexArray ||
+            a.IndexBuffer != b.IndexBuffer || a.UniformOffset != b.UniformOffset ||
+            a.UniformCount != b.UniformCount || a.InstanceCount != b.InstanceCount)
+            return false;
+    }
+
+    for (size_t i = 0; i < m_Uniforms.size(); i++)
+    {
+        const draw_uniform& a = m_Uniforms[i];
+        const draw_uniform& b = other.m_Uniforms[i];
+        if (a.Location != b.Location || a.Value[0] != b.Value[0] || a.Value[1] != b.Value[1] ||
+            a.Value[2] != b.Value[2] || a.Value[3] != b.Value[3])
+            return false;
+    }
+    return true;
+}
+
+void command_list::Clear()
+{
+    m_Commands.clear();
+    m_Uniforms.clear();
+    m_HasScissor = false;
+}
+
+void command_list::Reserve(unsigned int draws, unsigned int uniforms)
+{
+    m_Commands.reserve(draws);
+    m_Uniforms.reserve(uniforms);
+}
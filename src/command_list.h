@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class index_buffer;
+
+//A vec4 uniform value set right before a draw
+struct draw_uniform
+{
+	int Location;
+	float Value[4];
+};
+
+struct draw_command
+{
+	uint64_t SortKey;
+	unsigned int Program;
+	unsigned int VertexArray;
+	const index_buffer* IndexBuffer;
+	unsigned int UniformOffset;
+	unsigned int UniformCount;
+	unsigned int InstanceCount; //0 for a plain glDrawElements
+};
+
+//Window pixels, origin bottom left like glScissor
+struct scissor_rect
+{
+	int X;
+	int Y;
+	int Width;
+	int Height;
+};
+
+//A frame's worth of recorded draws. Recording makes no GL calls, so a list can be
+//filled on any thread and replayed later by renderer::Execute on the GL thread.
+//Clearing keeps the capacity, so reusing a list every frame doesn't allocate.
+class command_list
+{
+private:
+	std::vector<draw_command> m_Commands;
+	std::vector<draw_uniform> m_Uniforms;
+	scissor_rect m_Scissor;
+	bool m_HasScissor = false;
+
+public:
+	void Submit(uint64_t sortKey, unsigned int program, unsigned int vertexArray, const index_buffer& ib,
+	            const draw_uniform* uniforms = nullptr, unsigned int uniformCount = 0);
+
+	//One glDrawElementsInstanced call; per-instance data comes from attributes with a
+	//divisor in the vertex array (see vertex_buffer_layout::Push)
+	void SubmitInstanced(uint64_t sortKey, unsigned int program, unsigned int vertexArray, const index_buffer& ib,
+	                     unsigned int instanceCount, const draw_uniform* uniforms = nullptr, unsigned int uniformCount = 0);
+
+	//Copies another list's draws onto the end of this one
+	void Append(const command_list& other);
+
+	//Limits clearing and drawing of this frame to rect, for partial redraws
+	inline void SetScissor(const scissor_rect& rect) { m_Scissor = rect; m_HasScissor = true; }
+
+	//True if other would issue exactly the same draws with the same uniform values
+	bool HasSameDraws(const command_list& other) const;
+
+	void Clear();
+
+	//Grows the storage ahead of time, e.g. to the largest frame expected
+	void Reserve(unsigned int draws, unsigned int uniforms);
+
+	inline bool HasScissor() const { return m_HasScissor; }
+	inline const scissor_rect& GetScissor() const { return m_Scissor; }
+	inline const std::vector<draw_command>& GetCommands() const { return m_Commands; }
+	inline const std::vector<draw_uniform>& GetUniforms() const { return m_Uniforms; }
+	inline bool IsEmpty() const { return m_Commands.empty(); }
+};
@@ -0,0 +1,177 @@
+#include "damage_tracker.h"
+
+#include <GLFW/glfw3.h>
+#if defined(__unix__) && !defined(__APPLE__)
+#define GLFW_EXPOSE_NATIVE_X11
+#define GLFW_EXPOSE_NATIVE_GLX
+#define GLFW_EXPOSE_NATIVE_EGL
+#include <GLFW/glfw3native.h>
+#include <EGL/eglext.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+
+static damage_tracker* GetTracker(GLFWwindow* window)
+{
+    return static_cast<damage_tracker*>(glfwGetWindowUserPointer(window));
+}
+
+static void OnFramebufferSize(GLFWwindow* window, int width, int height)
+{
+    GetTracker(window)->Resize(width, height);
+}
+
+static void OnRefresh(GLFWwindow* window)
+{
+    GetTracker(window)->MarkDirty();
+}
+
+static void OnKey(GLFWwindow* window, int, int, int, int)
+{
+    GetTracker(window)->MarkDirty();
+}
+
+static void OnMouseButton(GLFWwindow* window, int, int, int)
+{
+    GetTracker(window)->MarkDirty();
+}
+
+static void OnCursorPos(GLFWwindow* window, double, double)
+{
+    GetTracker(window)->MarkDirty();
+}
+
+static void OnScroll(GLFWwindow* window, double, double)
+{
+    GetTracker(window)->MarkDirty();
+}
+
+static void OnFocus(GLFWwindow* window, int)
+{
+    GetTracker(window)->MarkDirty();
+}
+
+damage_tracker::damage_tracker(GLFWwindow* window)
+    : m_Window(window), m_Width(0), m_Height(0), m_FullRedraw(true), m_SkippedFrames(0)
+{
+    glfwGetFramebufferSize(window, &m_Width, &m_Height);
+
+    glfwSetWindowUserPointer(window, this);
+    glfwSetFramebufferSizeCallback(window, OnFramebufferSize);
+    glfwSetWindowRefreshCallback(window, OnRefresh);
+    glfwSetKeyCallback(window, OnKey);
+    glfwSetMouseButtonCallback(window, OnMouseButton);
+    glfwSetCursorPosCallback(window, OnCursorPos);
+    glfwSetScrollCallback(window, OnScroll);
+    glfwSetWindowFocusCallback(window, OnFocus);
+}
+
+damage_tracker::~damage_tracker()
+{
+    glfwSetFramebufferSizeCallback(m_Window, nullptr);
+    glfwSetWindowRefreshCallback(m_Window, nullptr);
+    glfwSetKeyCallback(m_Window, nullptr);
+    glfwSetMouseButtonCallback(m_Window, nullptr);
+    glfwSetCursorPosCallback(m_Window, nullptr);
+    glfwSetScrollCallback(m_Window, nullptr);
+    glfwSetWindowFocusCallback(m_Window, nullptr);
+    glfwSetWindowUserPointer(m_Window, nullptr);
+}
+
+void damage_tracker::MarkDirty()
+{
+    m_FullRedraw = true;
+}
+
+void damage_tracker::MarkDirty(const scissor_rect& rect)
+{
+    if (rect.Width > 0 && rect.Height > 0)
+        m_Rects.push_back(rect);
+}
+
+void damage_tracker::Resize(int width, int height)
+{
+    m_Width = width;
+    m_Height = height;
+    m_FullRedraw = true;
+}
+
+scissor_rect damage_tracker::Union(const scissor_rect& a, const scissor_rect& b)
+{
+    int x0 = std::min(a.X, b.X);
+    int y0 = std::min(a.Y, b.Y);
+    int x1 = std::max(a.X + a.Width, b.X + b.Width);
+    int y1 = std::max(a.Y + a.Height, b.Y + b.Height);
+    return { x0, y0, x1 - x0, y1 - y0 };
+}
+
+bool damage_tracker::Prepare(command_list& frame)
+{
+    bool drawsChanged = !frame.HasSameDraws(m_Previous);
+    if (!m_FullRedraw && m_Rects.empty() && !drawsChanged)
+    {
+        m_SkippedFrames++;
+        return false;
+    }
+
+    //Reported rects are trusted to cover any draw changes in the same frame
+    if (!m_FullRedraw && !m_Rects.empty())
+    {
+        scissor_rect damage = m_Rects[0];
+        for (size_t i = 1; i < m_Rects.size(); i++)
+            damage = Union(damage, m_Rects[i]);
+
+        if (damage.Width < m_Width || damage.Height < m_Height)
+            frame.SetScissor(damage);
+    }
+
+    m_FullRedraw = false;
+    m_Rects.clear();
+
+    //Append keeps the capacity, so this stops allocating after the first frames
+    m_Previous.Clear();
+    m_Previous.Append(frame);
+    return true;
+}
+
+int QueryBufferAge(GLFWwindow* window)
+{
+#if defined(__unix__) && !defined(__APPLE__)
+    //Extension strings don't change for the window's lifetime, look once
+    static int support = -1;
+    EGLDisplay eglDisplay = glfwGetEGLDisplay();
+    EGLSurface surface = glfwGetEGLSurface(window);
+    if (surface != EGL_NO_SURFACE)
+    {
+        if (support < 0)
+        {
+            const char* extensions = eglQueryString(eglDisplay, EGL_EXTENSIONS);
+            support = extensions && strstr(extensions, "EGL_EXT_buffer_age") ? 1 : 0;
+        }
+        EGLint age = 0;
+        if (support && eglQuerySurface(eglDisplay, surface, EGL_BUFFER_AGE_EXT, &age))
+            return age;
+        return 0;
+    }
+
+    //Querying the attribute without the extension is an X error, which ends the program
+    Display* display = glfwGetX11Display();
+    GLXWindow drawable = glfwGetGLXWindow(window);
+    if (!display || !drawable)
+        return 0;
+    if (support < 0)
+    {
+        const char* extensions = glXQueryExtensionsString(display, DefaultScreen(display));
+        support = extensions && strstr(extensions, "GLX_EXT_buffer_age") ? 1 : 0;
+    }
+    unsigned int age = 0;
+    if (support)
+        glXQueryDrawable(display, drawable, GLX_BACK_BUFFER_AGE_EXT, &age);
+    return (int)age;
+#else
+    (void)window;
+    return 0;
+#endif
+}
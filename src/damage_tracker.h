@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+
+#include "command_list.h"
+
+struct GLFWwindow;
+
+//Decides whether a frame needs drawing at all, and where. A frame is redrawn if
+//input, a resize or an expose event came in, the app reported damage, or its
+//command list differs from the last drawn one (draws or uniform values). Buffer
+//contents aren't visible in a command list, so code that updates them calls
+//MarkDirty itself, with the affected rect if it knows one.
+//
+//Reported rects turn into a scissored partial redraw of this frame's damage.
+//What the back buffer holds depends on the swap chain, so the GL thread passes
+//QueryBufferAge to renderer::ApplyScissor, which widens the rect by the damage
+//of the frames the buffer missed or redraws everything when the age is unknown.
+//
+//Installs its own GLFW input/window callbacks and uses the window user pointer.
+class damage_tracker
+{
+private:
+	GLFWwindow* m_Window;
+	command_list m_Previous;
+	std::vector<scissor_rect> m_Rects;
+	int m_Width;
+	int m_Height;
+	bool m_FullRedraw;
+	unsigned long long m_SkippedFrames;
+
+	static scissor_rect Union(const scissor_rect& a, const scissor_rect& b);
+
+public:
+	explicit damage_tracker(GLFWwindow* window);
+	~damage_tracker();
+
+	damage_tracker(const damage_tracker&) = delete;
+	damage_tracker& operator=(const damage_tracker&) = delete;
+
+	//The whole window changed
+	void MarkDirty();
+
+	//Only rect changed, in framebuffer pixels with the origin bottom left
+	void MarkDirty(const scissor_rect& rect);
+
+	void Resize(int width, int height);
+
+	//Call with the fully recorded frame. Returns false if the screen is already up
+	//to date, otherwise sets the frame's scissor for a partial redraw if possible.
+	bool Prepare(command_list& frame);
+
+	inline unsigned long long GetSkippedFrames() const { return m_SkippedFrames; }
+};
+
+//Age of the window's back buffer in frames through EGL_EXT_buffer_age or
+//GLX_EXT_buffer_age, 0 where it is unknown (WGL, no extension, undefined contents).
+//Call on the thread with the context current, right before drawing.
+int QueryBufferAge(GLFWwindow* window);
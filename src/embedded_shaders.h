@@ -0,0 +1,214 @@
+//Generated by tools/embed_shaders, do not edit. Regenerate after changing:
+//    res/shaders/basic.shader
+//    res/shaders/instanced.shader
+//    res/shaders/indirect.shader
+//    res/shaders/batch.shader
+//    res/shaders/scene.shader
+#pragma once
+
+#include <string_view>
+
+#include "shader_source.h"
+
+inline constexpr std::string_view basic_shader =
+    R"shader(#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+
+void main()
+{
+	gl_Position = position;
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+uniform vec4 u_Color;
+
+void main()
+{
+	color = u_Color;
+};)shader";
+
+inline constexpr std::string_view instanced_shader =
+    R"shader(#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+//Per instance: xy = offset, zw = scale
+layout(location = 1) in vec4 instanceTransform;
+layout(location = 2) in vec4 instanceColor;
+
+out vec4 v_Color;
+
+void main()
+{
+	gl_Position = vec4(position.xy * instanceTransform.zw + instanceTransform.xy, position.zw);
+	v_Color = instanceColor;
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 v_Color;
+
+void main()
+{
+	color = v_Color;
+};)shader";
+
+inline constexpr std::string_view indirect_shader =
+    R"shader(#permutation INDIRECT 0 1
+#shader vertex
+#version 330 core
+#if INDIRECT
+#extension GL_ARB_shader_storage_buffer_object : require
+#endif
+
+layout(location = 0) in vec4 position;
+
+#if INDIRECT
+//BaseInstance of each indirect draw selects its entry
+layout(location = 1) in uint drawID;
+
+layout(std430) buffer DrawData
+{
+	vec4 u_Draws[];
+};
+#define TRANSFORM u_Draws[drawID * 2u]
+#define COLOR u_Draws[drawID * 2u + 1u]
+#else
+uniform vec4 u_DrawData[2];
+#define TRANSFORM u_DrawData[0]
+#define COLOR u_DrawData[1]
+#endif
+
+out vec4 v_Color;
+
+void main()
+{
+	//xy = offset, zw = scale
+	gl_Position = vec4(position.xy * TRANSFORM.zw + TRANSFORM.xy, position.zw);
+	v_Color = COLOR;
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec4 v_Color;
+
+void main()
+{
+	color = v_Color;
+};)shader";
+
+inline constexpr std::string_view batch_shader =
+    R"shader(#permutation TEXTURED 1 0
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+layout(location = 2) in vec4 color;
+layout(location = 3) in float texIndex;
+
+out vec2 v_TexCoord;
+out vec4 v_Color;
+flat out int v_TexIndex;
+
+void main()
+{
+	gl_Position = position;
+	v_TexCoord = texCoord;
+	v_Color = color;
+	v_TexIndex = int(texIndex);
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+in vec4 v_Color;
+flat in int v_TexIndex;
+
+#if TEXTURED
+uniform sampler2D u_Textures[16];
+
+//GLSL 3.30 only allows constant indices into sampler arrays
+vec4 SampleSlot(int slot, vec2 uv)
+{
+	switch (slot)
+	{
+	case 0: return texture(u_Textures[0], uv);
+	case 1: return texture(u_Textures[1], uv);
+	case 2: return texture(u_Textures[2], uv);
+	case 3: return texture(u_Textures[3], uv);
+	case 4: return texture(u_Textures[4], uv);
+	case 5: return texture(u_Textures[5], uv);
+	case 6: return texture(u_Textures[6], uv);
+	case 7: return texture(u_Textures[7], uv);
+	case 8: return texture(u_Textures[8], uv);
+	case 9: return texture(u_Textures[9], uv);
+	case 10: return texture(u_Textures[10], uv);
+	case 11: return texture(u_Textures[11], uv);
+	case 12: return texture(u_Textures[12], uv);
+	case 13: return texture(u_Textures[13], uv);
+	case 14: return texture(u_Textures[14], uv);
+	case 15: return texture(u_Textures[15], uv);
+	}
+	return vec4(1.0);
+}
+#endif
+
+void main()
+{
+#if TEXTURED
+	color = v_TexIndex < 0 ? v_Color : SampleSlot(v_TexIndex, v_TexCoord) * v_Color;
+#else
+	//Batches without textures skip the sampler switch
+	color = v_Color;
+#endif
+};)shader";
+
+inline constexpr std::string_view scene_shader =
+    R"shader(#shader vertex
+#version 330 core
+
+layout(location = 0) in vec4 position;
+
+//Columns of the model-view-projection matrix, one draw_uniform each
+uniform vec4 u_Transform[4];
+
+void main()
+{
+	gl_Position = mat4(u_Transform[0], u_Transform[1], u_Transform[2], u_Transform[3]) * position;
+};
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+uniform vec4 u_Color;
+
+void main()
+{
+	color = u_Color;
+};)shader";
+
+inline constexpr embedded_shader_file embeddedShaderFiles[] = {
+    { "res/shaders/basic.shader", basic_shader },
+    { "res/shaders/instanced.shader", instanced_shader },
+    { "res/shaders/indirect.shader", indirect_shader },
+    { "res/shaders/batch.shader", batch_shader },
+    { "res/shaders/scene.shader", scene_shader },
+};
@@ -0,0 +1,27 @@
+#include "fixed_timestep.h"
+
+
+fixed_timestep::fixed_timestep(double step, unsigned int maxStepsPerFrame)
+    : m_Step(step), m_Accumulator(0.0), m_MaxSteps(maxStepsPerFrame), m_StepCount(0)
+{
+}
+
+unsigned int fixed_timestep::Advance(double frameTime)
+{
+    if (frameTime > 0.0)
+        m_Accumulator += frameTime;
+
+    unsigned int steps = 0;
+    while (m_Accumulator >= m_Step && steps < m_MaxSteps)
+    {
+        m_Accumulator -= m_Step;
+        steps++;
+    }
+
+    //Too far behind: drop the backlog rather than carry it into the next frame
+    if (m_Accumulator >= m_Step)
+        m_Accumulator = 0.0;
+
+    m_StepCount += steps;
+    return steps;
+}
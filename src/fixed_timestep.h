@@ -0,0 +1,29 @@
+#pragma once
+
+//Decouples simulation from the render rate: real frame time is accumulated and
+//paid out in fixed steps, and whatever is left over becomes the blend factor
+//between the last two simulation states for rendering. Steps per frame are
+//capped so a long stall can't snowball into ever longer catch-up frames.
+class fixed_timestep
+{
+private:
+	double m_Step;
+	double m_Accumulator;
+	unsigned int m_MaxSteps;
+	unsigned long long m_StepCount;
+
+public:
+	explicit fixed_timestep(double step = 1.0 / 60.0, unsigned int maxStepsPerFrame = 8);
+
+	//Adds frameTime seconds and returns how many steps to simulate now
+	unsigned int Advance(double frameTime);
+
+	//How far rendering is between the previous and the current state, in [0, 1)
+	inline double GetAlpha() const { return m_Accumulator / m_Step; }
+
+	//Seconds until Advance would return a step again
+	inline double GetTimeToNextStep() const { return m_Step - m_Accumulator; }
+
+	inline double GetStep() const { return m_Step; }
+	inline unsigned long long GetStepCount() const { return m_StepCount; }
+};
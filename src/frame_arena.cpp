@@ -0,0 +1,32 @@
+#include "frame_arena.h"
+
+#include "job_system.h"
+
+
+frame_arena::frame_arena(const job_system& jobs, size_t bytesPerThread)
+{
+    for (unsigned int i = 0; i < jobs.GetThreadCount(); i++)
+        m_Allocators.push_back(std::make_unique<linear_allocator>(bytesPerThread));
+}
+
+linear_allocator& frame_arena::Get()
+{
+    return *m_Allocators[job_system::GetThreadIndex()];
+}
+
+void frame_arena::Reset()
+{
+    for (std::unique_ptr<linear_allocator>& allocator : m_Allocators)
+        allocator->Reset();
+}
+
+size_t frame_arena::GetPeakUsage() const
+{
+    size_t peak = 0;
+    for (const std::unique_ptr<linear_allocator>& allocator : m_Allocators)
+    {
+        if (allocator->GetUsed() > peak)
+            peak = allocator->GetUsed();
+    }
+    return peak;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "linear_allocator.h"
+
+class job_system;
+
+//One linear_allocator per job system thread for data that only lives for the
+//current frame: culling output, uniform staging, scratch for recording. Threads
+//allocate from their own block without locking and Reset frees everything at
+//once at the end of the frame, so none of it goes through the general heap.
+class frame_arena
+{
+private:
+	std::vector<std::unique_ptr<linear_allocator>> m_Allocators;
+
+public:
+	frame_arena(const job_system& jobs, size_t bytesPerThread);
+
+	//The calling thread's allocator
+	linear_allocator& Get();
+
+	inline linear_allocator& Get(unsigned int threadIndex) { return *m_Allocators[threadIndex]; }
+
+	//Call at the end of the frame, once no job is using frame memory any more
+	void Reset();
+
+	//Highest per-thread usage since the last Reset, to size bytesPerThread
+	size_t GetPeakUsage() const;
+};
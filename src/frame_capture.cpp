@@ -0,0 +1,135 @@
+#include "frame_capture.h"
+
+#include <iostream>
+
+#include "renderer.h"
+
+
+frame_capture::frame_capture(unsigned int ringSize)
+    : m_Slots(ringSize > 0 ? ringSize : 1), m_Issued(0), m_Consumed(0), m_Mapped(false), m_Frames(0), m_Dropped(0)
+{
+    for (slot& s : m_Slots)
+    {
+        GLCall(glGenBuffers(1, &s.Buffer));
+        s.Fence = nullptr;
+        s.Capacity = 0;
+        s.Width = 0;
+        s.Height = 0;
+        s.Index = 0;
+    }
+}
+
+frame_capture::~frame_capture()
+{
+    Unmap();
+    for (slot& s : m_Slots)
+    {
+        if (s.Fence)
+            glDeleteSync((GLsync)s.Fence);
+        GLCall(glDeleteBuffers(1, &s.Buffer));
+    }
+}
+
+bool frame_capture::Capture(int width, int height, unsigned int framebuffer)
+{
+    unsigned long long index = m_Frames++;
+    if (m_Issued - m_Consumed >= m_Slots.size())
+    {
+        m_Dropped++;
+        return false;
+    }
+
+    slot& s = m_Slots[m_Issued % m_Slots.size()];
+    size_t size = (size_t)width * height * 4;
+
+    GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, s.Buffer));
+    if (s.Capacity < size)
+    {
+        GLCall(glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ));
+        s.Capacity = size;
+    }
+
+    //The caller's read framebuffer binding, the read buffer of framebuffer and the
+    //pack alignment are all put back afterwards
+    int readFramebuffer, readBuffer, alignment;
+    GLCall(glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &readFramebuffer));
+    GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer));
+    GLCall(glGetIntegerv(GL_READ_BUFFER, &readBuffer));
+    GLCall(glReadBuffer(framebuffer == 0 ? GL_BACK : GL_COLOR_ATTACHMENT0));
+    //Tightly packed whatever alignment the caller uses for its own readbacks
+    GLCall(glGetIntegerv(GL_PACK_ALIGNMENT, &alignment));
+    GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+
+    //With a pack buffer bound the pointer is an offset and the call returns immediately
+    GLCall(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+    GLCall(glPixelStorei(GL_PACK_ALIGNMENT, alignment));
+    s.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+    GLCall(glReadBuffer((GLenum)readBuffer));
+    GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, (unsigned int)readFramebuffer));
+
+    //Make sure the fence reaches the GPU, otherwise polling it could never succeed
+    GLCall(glFlush());
+
+    s.Width = width;
+    s.Height = height;
+    s.Index = index;
+    m_Issued++;
+    return true;
+}
+
+bool frame_capture::Map(captured_frame& frame, bool wait)
+{
+    if (m_Mapped || m_Consumed == m_Issued)
+        return false;
+
+    slot& s = m_Slots[m_Consumed % m_Slots.size()];
+    GLuint64 timeout = wait ? GL_TIMEOUT_IGNORED : 0;
+    GLenum status = glClientWaitSync((GLsync)s.Fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, timeout);
+    if (status == GL_TIMEOUT_EXPIRED)
+        return false;
+
+    glDeleteSync((GLsync)s.Fence);
+    s.Fence = nullptr;
+    //The readback is lost either way, free its slot instead of retrying it forever
+    if (status == GL_WAIT_FAILED)
+    {
+        std::cout << "[Capture] Waiting on readback fence failed" << std::endl;
+        m_Dropped++;
+        m_Consumed++;
+        return false;
+    }
+
+    GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, s.Buffer));
+    void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (size_t)s.Width * s.Height * 4, GL_MAP_READ_BIT);
+    GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+    if (!pixels)
+    {
+        std::cout << "[Capture] Mapping readback buffer failed" << std::endl;
+        m_Dropped++;
+        m_Consumed++;
+        return false;
+    }
+
+    frame.Pixels = static_cast<const unsigned char*>(pixels);
+    frame.Width = s.Width;
+    frame.Height = s.Height;
+    frame.Index = s.Index;
+    m_Mapped = true;
+    return true;
+}
+
+void frame_capture::Unmap()
+{
+    if (!m_Mapped)
+        return;
+
+    slot& s = m_Slots[m_Consumed % m_Slots.size()];
+    GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, s.Buffer));
+    GLCall(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+    GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+
+    m_Mapped = false;
+    m_Consumed++;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+//Pixels of one finished readback, valid until frame_capture::Unmap.
+//Tightly packed RGBA8 rows, bottom row first like glReadPixels returns them.
+struct captured_frame
+{
+	const unsigned char* Pixels;
+	int Width;
+	int Height;
+	unsigned long long Index; //counts Capture calls, so dropped frames show up as gaps
+};
+
+//Reads framebuffers back without stalling: Capture issues glReadPixels into the
+//next pixel buffer object of a ring and drops a fence behind it, the copy runs
+//on the GPU while the CPU carries on, and Map hands out the oldest readback
+//once its fence has signalled, usually one or two frames later.
+//
+//If every buffer is still in flight or mapped, Capture drops the frame rather
+//than wait; a caller that can't lose frames drains with Map(frame, true) first.
+class frame_capture
+{
+private:
+	struct slot
+	{
+		unsigned int Buffer;
+		void* Fence; //GLsync, null while the slot is free
+		size_t Capacity;
+		int Width;
+		int Height;
+		unsigned long long Index;
+	};
+
+	std::vector<slot> m_Slots;
+	unsigned long long m_Issued;   //readbacks started, slot of readback n is n % size
+	unsigned long long m_Consumed; //readbacks mapped and released
+	bool m_Mapped;
+	unsigned long long m_Frames;
+	unsigned long long m_Dropped;
+
+public:
+	explicit frame_capture(unsigned int ringSize = 3);
+	~frame_capture();
+
+	frame_capture(const frame_capture&) = delete;
+	frame_capture& operator=(const frame_capture&) = delete;
+
+	//Queues a readback of the framebuffer's first color buffer (the back buffer for
+	//framebuffer 0, so call it before swapping). Returns false if the frame was dropped.
+	bool Capture(int width, int height, unsigned int framebuffer = 0);
+
+	//Maps the oldest readback if the GPU is done with it, or waits for it with wait set.
+	//Returns false if nothing is ready (or nothing is in flight at all). A readback
+	//whose fence or mapping fails is dropped and counted.
+	bool Map(captured_frame& frame, bool wait = false);
+
+	//Releases the buffer from the last successful Map for reuse
+	void Unmap();
+
+	inline unsigned int GetInFlight() const { return (unsigned int)(m_Issued - m_Consumed); }
+	inline unsigned long long GetDroppedCount() const { return m_Dropped; }
+};
@@ -0,0 +1,241 @@
+#include "frame_encoder.h"
+
+#include <cstring>
+#include <iostream>
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#define popen _popen
+#define pclose _pclose
+#define PIPE_WRITE_MODE "wb"
+#else
+#define PIPE_WRITE_MODE "w"
+#endif
+
+//The pattern goes to snprintf as the format with the frame index as its only
+//argument, so anything but a single %llu conversion would read garbage
+static bool IsFramePattern(const std::string& pattern)
+{
+    unsigned int conversions = 0;
+    for (size_t i = 0; i < pattern.size(); i++)
+    {
+        if (pattern[i] != '%')
+            continue;
+        if (++i < pattern.size() && pattern[i] == '%')
+            continue;
+
+        while (i < pattern.size() && (pattern[i] == '0' || pattern[i] == '-'))
+            i++;
+        while (i < pattern.size() && pattern[i] >= '0' && pattern[i] <= '9')
+            i++;
+        if (pattern.compare(i, 3, "llu") != 0)
+            return false;
+        i += 2;
+        conversions++;
+    }
+    return conversions == 1;
+}
+
+frame_encoder::frame_encoder(image_format format, const std::string& path, int fps, unsigned int workerCount,
+                             unsigned int queueDepth, int pngLevel)
+    : m_Format(format), m_Path(path), m_Fps(fps), m_PngLevel(pngLevel), m_Stream(nullptr), m_IsPipe(false),
+      m_Open(false), m_QueueHead(0), m_QueueCount(0), m_Submitted(0), m_Failed(0), m_Stopping(false), m_NextWrite(0),
+      m_StreamWidth(0), m_StreamHeight(0)
+{
+    if (workerCount == 0)
+    {
+        unsigned int hardware = std::thread::hardware_concurrency();
+        workerCount = hardware > 1 ? hardware - 1 : 1;
+    }
+    if (queueDepth == 0)
+        queueDepth = workerCount * 2;
+
+    if (m_Format == image_format::Y4M)
+    {
+        if (m_Path == "-")
+        {
+#ifdef _WIN32
+            _setmode(_fileno(stdout), _O_BINARY);
+#endif
+            m_Stream = stdout;
+        }
+        else if (!m_Path.empty() && m_Path[0] == '|')
+        {
+            m_Stream = popen(m_Path.c_str() + 1, PIPE_WRITE_MODE);
+            m_IsPipe = true;
+        }
+        else
+        {
+            m_Stream = fopen(m_Path.c_str(), "wb");
+        }
+
+        m_Open = m_Stream != nullptr;
+        if (!m_Open)
+            std::cout << "[Encoder] Could not open " << m_Path << std::endl;
+    }
+    else
+    {
+        m_Open = IsFramePattern(m_Path);
+        if (!m_Open)
+            std::cout << "[Encoder] " << m_Path << " needs exactly one %llu for the frame index (e.g. frame_%06llu.png)" << std::endl;
+    }
+
+    m_Slots.resize(queueDepth);
+    m_Queue.resize(queueDepth);
+    for (unsigned int i = 0; i < queueDepth; i++)
+        m_Free.push_back(queueDepth - 1 - i);
+
+    for (unsigned int i = 0; i < workerCount; i++)
+        m_Workers.emplace_back(&frame_encoder::WorkerLoop, this);
+}
+
+frame_encoder::~frame_encoder()
+{
+    Flush();
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stopping = true;
+    }
+    m_WorkReady.notify_all();
+    for (std::thread& worker : m_Workers)
+        worker.join();
+
+    if (!m_Stream)
+        return;
+    if (m_IsPipe)
+        pclose(m_Stream);
+    else if (m_Stream != stdout)
+        fclose(m_Stream);
+    else
+        fflush(m_Stream);
+}
+
+bool frame_encoder::Enqueue(const captured_frame& frame, bool wait)
+{
+    if (!IsOpen())
+        return false;
+
+    unsigned int index;
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        if (m_Free.empty())
+        {
+            if (!wait)
+                return false;
+            m_SlotFree.wait(lock, [this] { return !m_Free.empty(); });
+        }
+        index = m_Free.back();
+        m_Free.pop_back();
+    }
+
+    //The slot belongs to this thread until it is queued, copy outside the lock
+    slot& s = m_Slots[index];
+    s.Pixels.resize((size_t)frame.Width * frame.Height * 4);
+    memcpy(s.Pixels.data(), frame.Pixels, s.Pixels.size());
+    s.Width = frame.Width;
+    s.Height = frame.Height;
+    s.Index = frame.Index;
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        s.Sequence = m_Submitted++;
+        m_Queue[(m_QueueHead + m_QueueCount) % m_Queue.size()] = index;
+        m_QueueCount++;
+    }
+    m_WorkReady.notify_one();
+    return true;
+}
+
+void frame_encoder::Flush()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_SlotFree.wait(lock, [this] { return m_Free.size() == m_Slots.size(); });
+}
+
+void frame_encoder::WorkerLoop()
+{
+    while (true)
+    {
+        unsigned int index;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_WorkReady.wait(lock, [this] { return m_Stopping || m_QueueCount > 0; });
+            if (m_QueueCount == 0)
+                return;
+
+            index = m_Queue[m_QueueHead];
+            m_QueueHead = (m_QueueHead + 1) % m_Queue.size();
+            m_QueueCount--;
+        }
+
+        bool written = Encode(m_Slots[index]);
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (!written)
+                m_Failed++;
+            m_Free.push_back(index);
+        }
+        m_SlotFree.notify_all();
+    }
+}
+
+bool frame_encoder::Encode(slot& s)
+{
+    switch (m_Format)
+    {
+    case image_format::QOI:
+        EncodeQOI(s.Pixels.data(), s.Width, s.Height, true, s.Output);
+        return WriteFile(s);
+    case image_format::PNG:
+        EncodePNG(s.Pixels.data(), s.Width, s.Height, true, s.Output, s.Scratch, m_PngLevel);
+        return WriteFile(s);
+    case image_format::Y4M:
+        EncodeY4MFrame(s.Pixels.data(), s.Width, s.Height, true, s.Output);
+        return WriteStream(s);
+    }
+    return false;
+}
+
+bool frame_encoder::WriteFile(const slot& s)
+{
+    char path[1024];
+    snprintf(path, sizeof(path), m_Path.c_str(), s.Index);
+
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        std::cout << "[Encoder] Could not open " << path << std::endl;
+        return false;
+    }
+
+    bool written = fwrite(s.Output.data(), 1, s.Output.size(), file) == s.Output.size();
+    return fclose(file) == 0 && written;
+}
+
+bool frame_encoder::WriteStream(slot& s)
+{
+    std::unique_lock<std::mutex> lock(m_WriteMutex);
+    m_WriteTurn.wait(lock, [this, &s] { return m_NextWrite == s.Sequence; });
+
+    bool written = true;
+    if (s.Sequence == 0)
+    {
+        //The first frame decides the stream size, Y4M can't change it later
+        m_StreamWidth = s.Width;
+        m_StreamHeight = s.Height;
+        EncodeY4MHeader(s.Width, s.Height, m_Fps, s.Scratch);
+        written = fwrite(s.Scratch.data(), 1, s.Scratch.size(), m_Stream) == s.Scratch.size();
+    }
+    else if (s.Width != m_StreamWidth || s.Height != m_StreamHeight)
+    {
+        std::cout << "[Encoder] Frame " << s.Index << " doesn't match the stream size, skipped" << std::endl;
+        written = false;
+    }
+    written = written && fwrite(s.Output.data(), 1, s.Output.size(), m_Stream) == s.Output.size();
+
+    m_NextWrite++;
+    lock.unlock();
+    m_WriteTurn.notify_all();
+    return written;
+}
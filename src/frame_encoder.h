@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "frame_capture.h"
+#include "image_encoder.h"
+
+//Encodes captured frames on worker threads so the render loop only pays for a
+//memcpy out of the mapped readback buffer. Frames wait in a fixed set of slots:
+//Submit blocks while all of them are queued or being encoded, which slows the
+//render loop down to the encoders' pace instead of queueing without bound.
+//
+//QOI and PNG write one file per frame, named by a printf pattern taking the frame
+//index as unsigned long long ("out/frame_%06llu.png"). The pattern needs exactly one
+//%llu, optionally with '0' or '-' flags and a width; '%%' is a literal percent sign.
+//Y4M writes one stream to a file, to stdout for "-", or into a command for "|cmd"
+//(e.g. "|ffmpeg -i - out.mp4"); frames are encoded in parallel but written in
+//submission order.
+class frame_encoder
+{
+private:
+	struct slot
+	{
+		std::vector<unsigned char> Pixels;
+		std::vector<unsigned char> Output;
+		std::vector<unsigned char> Scratch;
+		int Width;
+		int Height;
+		unsigned long long Index;    //captured frame index, names the file
+		unsigned long long Sequence; //submission order, orders the stream
+	};
+
+	image_format m_Format;
+	std::string m_Path;
+	int m_Fps;
+	int m_PngLevel;
+	FILE* m_Stream;
+	bool m_IsPipe;
+	bool m_Open;
+
+	std::vector<slot> m_Slots;
+	std::vector<unsigned int> m_Free;
+	std::vector<unsigned int> m_Queue; //ring of slot indices waiting for a worker
+	unsigned int m_QueueHead;
+	unsigned int m_QueueCount;
+	unsigned long long m_Submitted;
+	std::atomic<unsigned long long> m_Failed;
+	bool m_Stopping;
+	std::mutex m_Mutex;
+	std::condition_variable m_WorkReady;
+	std::condition_variable m_SlotFree;
+
+	//Y4M only: the next sequence number allowed to write, and the stream's frame size
+	unsigned long long m_NextWrite;
+	int m_StreamWidth;
+	int m_StreamHeight;
+	std::mutex m_WriteMutex;
+	std::condition_variable m_WriteTurn;
+
+	std::vector<std::thread> m_Workers;
+
+	void WorkerLoop();
+	bool Encode(slot& s);
+	bool WriteFile(const slot& s);
+	bool WriteStream(slot& s);
+	bool Enqueue(const captured_frame& frame, bool wait);
+
+public:
+	//workerCount 0 uses all but one hardware thread, queueDepth 0 two slots per worker
+	frame_encoder(image_format format, const std::string& path, int fps = 60, unsigned int workerCount = 0,
+	              unsigned int queueDepth = 0, int pngLevel = 1);
+	~frame_encoder();
+
+	frame_encoder(const frame_encoder&) = delete;
+	frame_encoder& operator=(const frame_encoder&) = delete;
+
+	//False if the output couldn't be opened or the file pattern is invalid, nothing gets written then
+	inline bool IsOpen() const { return m_Open; }
+
+	//Copies the frame into a free slot, waiting for one if the encoders are behind.
+	//The captured frame can be unmapped as soon as this returns.
+	inline void Submit(const captured_frame& frame) { Enqueue(frame, true); }
+
+	//Like Submit but returns false instead of waiting when every slot is busy
+	inline bool TrySubmit(const captured_frame& frame) { return Enqueue(frame, false); }
+
+	//Waits until everything submitted so far is written
+	void Flush();
+
+	inline unsigned long long GetSubmittedCount() const { return m_Submitted; }
+	inline unsigned long long GetFailedCount() const { return m_Failed; }
+};
@@ -0,0 +1,114 @@
+#include "frame_pacer.h"
+
+#include <GLFW/glfw3.h>
+
+#include <cmath>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <timeapi.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+
+//Sleeping is only trusted up to this close to the deadline, the rest is spun
+static const std::chrono::microseconds spinMargin(1500);
+
+frame_pacer::frame_pacer(pacing_mode mode, double targetFps)
+    : m_Mode(mode),
+      m_Period(std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / targetFps))),
+      m_Started(false)
+{
+    ResetStats();
+
+#ifdef _WIN32
+    //Default scheduler granularity is ~15.6 ms, far too coarse for the limiter
+    if (m_Mode == pacing_mode::LIMITED)
+        timeBeginPeriod(1);
+#endif
+}
+
+frame_pacer::~frame_pacer()
+{
+#ifdef _WIN32
+    if (m_Mode == pacing_mode::LIMITED)
+        timeEndPeriod(1);
+#endif
+}
+
+int frame_pacer::ChooseSwapInterval() const
+{
+    switch (m_Mode)
+    {
+    case pacing_mode::VSYNC:
+        return 1;
+    case pacing_mode::ADAPTIVE_VSYNC:
+        if (glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear"))
+            return -1;
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+void frame_pacer::EndFrame()
+{
+    clock::time_point now = clock::now();
+
+    if (m_Mode == pacing_mode::LIMITED)
+    {
+        if (!m_Started)
+            m_Deadline = now;
+        m_Deadline += m_Period;
+
+        //More than a frame behind: start over from now instead of rushing to catch up
+        if (now > m_Deadline + m_Period)
+            m_Deadline = now + m_Period;
+
+        if (m_Deadline - now > spinMargin)
+            std::this_thread::sleep_for(m_Deadline - now - spinMargin);
+        while (clock::now() < m_Deadline)
+            std::this_thread::yield();
+
+        now = clock::now();
+    }
+
+    if (m_Started)
+    {
+        double frameMs = std::chrono::duration<double, std::milli>(now - m_LastFrame).count();
+        m_Frames++;
+        double delta = frameMs - m_Mean;
+        m_Mean += delta / m_Frames;
+        m_M2 += delta * (frameMs - m_Mean);
+        if (frameMs < m_Min)
+            m_Min = frameMs;
+        if (frameMs > m_Max)
+            m_Max = frameMs;
+    }
+
+    m_LastFrame = now;
+    m_Started = true;
+}
+
+frame_pacing_stats frame_pacer::GetStats() const
+{
+    frame_pacing_stats stats;
+    stats.Frames = m_Frames;
+    stats.MeanMs = m_Mean;
+    stats.JitterMs = m_Frames > 1 ? std::sqrt(m_M2 / (m_Frames - 1)) : 0.0;
+    stats.MinMs = m_Frames ? m_Min : 0.0;
+    stats.MaxMs = m_Frames ? m_Max : 0.0;
+    return stats;
+}
+
+void frame_pacer::ResetStats()
+{
+    m_Frames = 0;
+    m_Mean = 0.0;
+    m_M2 = 0.0;
+    m_Min = 1e30;
+    m_Max = 0.0;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+
+enum class pacing_mode
+{
+	UNCAPPED,       //swap interval 0, as fast as possible (benchmarks)
+	VSYNC,          //swap interval 1
+	ADAPTIVE_VSYNC, //swap interval -1 where swap_control_tear exists: tear instead of halving the rate on a late frame
+	LIMITED         //swap interval 0 plus a CPU-side limiter to the target rate (kiosks)
+};
+
+struct frame_pacing_stats
+{
+	unsigned long long Frames;
+	double MeanMs;
+	double JitterMs; //standard deviation of the frame time
+	double MinMs;
+	double MaxMs;
+};
+
+//Picks the swap interval for a pacing mode and, in LIMITED mode, holds each
+//frame to the target period by sleeping most of the wait and spinning the last
+//stretch, since sleeps alone overshoot by up to a scheduler tick. Also measures
+//the time between EndFrame calls.
+class frame_pacer
+{
+private:
+	using clock = std::chrono::steady_clock;
+
+	pacing_mode m_Mode;
+	clock::duration m_Period;
+	clock::time_point m_Deadline;
+	clock::time_point m_LastFrame;
+	bool m_Started;
+
+	//Welford's running mean / variance of the frame time
+	unsigned long long m_Frames;
+	double m_Mean;
+	double m_M2;
+	double m_Min;
+	double m_Max;
+
+public:
+	explicit frame_pacer(pacing_mode mode, double targetFps = 60.0);
+	~frame_pacer();
+
+	//Needs a current GL context; falls back to plain vsync if adaptive isn't supported
+	int ChooseSwapInterval() const;
+
+	//Call once per frame; waits in LIMITED mode and records the frame time
+	void EndFrame();
+
+	frame_pacing_stats GetStats() const;
+	void ResetStats();
+
+	inline pacing_mode GetMode() const { return m_Mode; }
+};
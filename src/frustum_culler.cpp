@@ -0,0 +1,209 @@
+#include "frustum_culler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "job_system.h"
+
+
+//Boxes per job, large enough that each chunk streams through a few pages of every component
+static const unsigned int cullChunkSize = 16384;
+
+frustum ExtractFrustum(const mat4& viewProjection)
+{
+    //Gribb and Hartmann: clip space -w <= x, y, z <= w as sums and differences of the matrix's rows
+    vec4 rows[4];
+    for (int r = 0; r < 4; r++)
+        rows[r] = vec4(viewProjection.Columns[0][r], viewProjection.Columns[1][r], viewProjection.Columns[2][r],
+                       viewProjection.Columns[3][r]);
+
+    frustum f;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        f.Planes[axis * 2] = rows[3] + rows[axis];
+        f.Planes[axis * 2 + 1] = rows[3] - rows[axis];
+    }
+    for (vec4& plane : f.Planes)
+    {
+        float length = std::sqrt(plane.X * plane.X + plane.Y * plane.Y + plane.Z * plane.Z);
+        if (length > 0.0f)
+            plane = plane * (1.0f / length);
+    }
+    return f;
+}
+
+bool IsVisible(const frustum& f, const aabb& box)
+{
+    //Only the corner furthest along the plane's normal matters: if even that one is
+    //behind, so is the whole box. Empty boxes pick an infinite corner and fail.
+    for (const vec4& plane : f.Planes)
+    {
+        float x = plane.X >= 0.0f ? box.Max.X : box.Min.X;
+        float y = plane.Y >= 0.0f ? box.Max.Y : box.Min.Y;
+        float z = plane.Z >= 0.0f ? box.Max.Z : box.Min.Z;
+        if (!(plane.X * x + plane.Y * y + plane.Z * z + plane.W >= 0.0f))
+            return false;
+    }
+    return true;
+}
+
+#ifdef __AVX2__
+//Indices of the set bits of every 8 bit mask, packed to the front, for _mm256_permutevar8x32_epi32
+struct compaction_table
+{
+    unsigned long long Entries[256];
+
+    compaction_table()
+    {
+        for (unsigned int mask = 0; mask < 256; mask++)
+        {
+            unsigned long long entry = 0;
+            unsigned int slot = 0;
+            for (unsigned int bit = 0; bit < 8; bit++)
+            {
+                if (mask & (1u << bit))
+                    entry |= (unsigned long long)bit << (8 * slot++);
+            }
+            Entries[mask] = entry;
+        }
+    }
+};
+
+static const compaction_table compactionTable;
+
+static inline __m256 MulAdd(__m256 a, __m256 b, __m256 c)
+{
+#ifdef __FMA__
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+
+//Plane coefficients broadcast once per call, with the corner selection folded into which component array is read
+struct plane8
+{
+    __m256 A, B, C, D;
+    int X, Y, Z; //0 reads the min component, 1 the max
+};
+
+//Visibility of the 8 boxes starting at i as a bit mask
+static inline int Test8(const plane8* planes, const float* const* components, unsigned int i)
+{
+    const __m256 minX = _mm256_loadu_ps(components[0] + i), maxX = _mm256_loadu_ps(components[3] + i);
+    const __m256 minY = _mm256_loadu_ps(components[1] + i), maxY = _mm256_loadu_ps(components[4] + i);
+    const __m256 minZ = _mm256_loadu_ps(components[2] + i), maxZ = _mm256_loadu_ps(components[5] + i);
+    const __m256 x[2] = { minX, maxX }, y[2] = { minY, maxY }, z[2] = { minZ, maxZ };
+
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (int p = 0; p < 6; p++)
+    {
+        const plane8& plane = planes[p];
+        __m256 distance = MulAdd(plane.A, x[plane.X], MulAdd(plane.B, y[plane.Y], MulAdd(plane.C, z[plane.Z], plane.D)));
+        //Ordered compare, so NaNs from 0 * infinity on empty boxes count as outside
+        inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+    }
+    return _mm256_movemask_ps(inside);
+}
+
+//Writes the indices i + bit for the set bits, always stores 8 entries
+static inline unsigned int Compact8(int mask, unsigned int i, unsigned int* out)
+{
+    __m256i slots = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128((long long)compactionTable.Entries[mask]));
+    __m256i indices = _mm256_add_epi32(_mm256_set1_epi32((int)i), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    _mm256_storeu_si256((__m256i*)out, _mm256_permutevar8x32_epi32(indices, slots));
+    return (unsigned int)_mm_popcnt_u32((unsigned int)mask);
+}
+#endif
+
+unsigned int CullBoxes(const frustum& f, const scene_bounds& bounds, unsigned int begin, unsigned int end, unsigned int* out)
+{
+    unsigned int written = 0;
+#ifdef __AVX2__
+    plane8 planes[6];
+    for (int p = 0; p < 6; p++)
+    {
+        const vec4& plane = f.Planes[p];
+        planes[p] = { _mm256_set1_ps(plane.X), _mm256_set1_ps(plane.Y), _mm256_set1_ps(plane.Z), _mm256_set1_ps(plane.W),
+                      plane.X >= 0.0f, plane.Y >= 0.0f, plane.Z >= 0.0f };
+    }
+
+    const float* components[6] = { bounds.MinX, bounds.MinY, bounds.MinZ, bounds.MaxX, bounds.MaxY, bounds.MaxZ };
+    unsigned int i = begin;
+    for (; i + 8 <= end; i += 8)
+        written += Compact8(Test8(planes, components, i), i, out + written);
+
+    //The tail goes through the same kernel padded with empty boxes, so every box sees the same arithmetic
+    if (i < end)
+    {
+        float padded[6][8];
+        const float* paddedComponents[6];
+        for (int c = 0; c < 6; c++)
+        {
+            std::fill(padded[c], padded[c] + 8, c < 3 ? INFINITY : -INFINITY);
+            std::copy(components[c] + i, components[c] + end, padded[c]);
+            paddedComponents[c] = padded[c];
+        }
+        written += Compact8(Test8(planes, paddedComponents, 0), i, out + written);
+    }
+#else
+    for (unsigned int i = begin; i < end; i++)
+    {
+        aabb box = { vec3(bounds.MinX[i], bounds.MinY[i], bounds.MinZ[i]), vec3(bounds.MaxX[i], bounds.MaxY[i], bounds.MaxZ[i]) };
+        out[written] = i;
+        written += IsVisible(f, box) ? 1 : 0;
+    }
+#endif
+    return written;
+}
+
+frustum_culler::frustum_culler(job_system* jobs)
+    : m_Jobs(jobs), m_VisibleCount(0)
+{
+}
+
+unsigned int frustum_culler::Cull(const frustum& f, const scene_bounds& bounds, unsigned int count)
+{
+    if (!m_Jobs || count <= cullChunkSize)
+    {
+        //Room for the 8 entries the last store may write past the visible ones
+        if (m_Visible.size() < count + 8)
+            m_Visible.resize(count + 8);
+        m_VisibleCount = CullBoxes(f, bounds, 0, count, m_Visible.data());
+        return m_VisibleCount;
+    }
+
+    //Each chunk culls into its own stretch of the scratch list, padded for the final
+    //store, and the stretches are then packed into the visible list
+    const unsigned int stride = cullChunkSize + 8;
+    unsigned int chunks = (count + cullChunkSize - 1) / cullChunkSize;
+    if (m_Scratch.size() < (size_t)chunks * stride)
+        m_Scratch.resize((size_t)chunks * stride);
+    if (m_ChunkCounts.size() < chunks + 1)
+        m_ChunkCounts.resize(chunks + 1);
+
+    unsigned int* scratch = m_Scratch.data();
+    unsigned int* chunkCounts = m_ChunkCounts.data();
+    m_Jobs->ParallelFor(chunks, 1, [&](unsigned int chunk)
+    {
+        unsigned int begin = chunk * cullChunkSize;
+        unsigned int end = std::min(begin + cullChunkSize, count);
+        chunkCounts[chunk + 1] = CullBoxes(f, bounds, begin, end, scratch + (size_t)chunk * stride);
+    });
+
+    chunkCounts[0] = 0;
+    for (unsigned int chunk = 0; chunk < chunks; chunk++)
+        chunkCounts[chunk + 1] += chunkCounts[chunk];
+
+    if (m_Visible.size() < chunkCounts[chunks])
+        m_Visible.resize(chunkCounts[chunks]);
+    unsigned int* visible = m_Visible.data();
+    m_Jobs->ParallelFor(chunks, 1, [&](unsigned int chunk)
+    {
+        const unsigned int* source = scratch + (size_t)chunk * stride;
+        std::copy(source, source + chunkCounts[chunk + 1] - chunkCounts[chunk], visible + chunkCounts[chunk]);
+    });
+
+    m_VisibleCount = chunkCounts[chunks];
+    return m_VisibleCount;
+}
\ No newline at end of file
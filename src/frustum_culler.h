@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+
+#include "simd_math.h"
+#include "scene_graph.h"
+
+class job_system;
+
+//Six planes (left, right, bottom, top, near, far) with normals pointing inwards:
+//a point is inside when Dot(plane, vec4(point, 1)) >= 0 for all of them
+struct frustum
+{
+	vec4 Planes[6];
+};
+
+//Planes of a GL clip space view projection, normalized so distances are in world units
+frustum ExtractFrustum(const mat4& viewProjection);
+
+//Conservative test of one box, the same one frustum_culler runs in bulk
+bool IsVisible(const frustum& f, const aabb& box);
+
+//Tests structure-of-arrays bounding boxes against a frustum, 8 per iteration with
+//AVX2, and compacts the indices of the boxes that may be visible into one list,
+//in increasing order, ready for scene_graph::Submit. A box is only dropped when
+//it lies entirely behind one plane, so a few boxes near the frustum's edges are
+//kept although they are outside. Empty boxes never pass.
+//
+//With a job system the boxes are split into chunks culled in parallel, each into
+//its own stretch of a scratch list; a prefix sum over the chunk counts then gives
+//every chunk its place in the final list. Buffers only grow, so culling the same
+//number of boxes every frame doesn't allocate.
+class frustum_culler
+{
+private:
+	job_system* m_Jobs;
+	std::vector<unsigned int> m_Scratch;
+	std::vector<unsigned int> m_ChunkCounts;
+	std::vector<unsigned int> m_Visible;
+	unsigned int m_VisibleCount;
+
+public:
+	explicit frustum_culler(job_system* jobs = nullptr);
+
+	//Culls boxes [0, count) and returns how many may be visible
+	unsigned int Cull(const frustum& f, const scene_bounds& bounds, unsigned int count);
+
+	//Indices kept by the last Cull
+	inline const unsigned int* GetVisible() const { return m_Visible.data(); }
+	inline unsigned int GetVisibleCount() const { return m_VisibleCount; }
+};
+
+//Culls indices [begin, end) into out, which needs room for end - begin + 8 entries.
+//Returns the number written. Exposed for benchmarks and custom schedulers.
+unsigned int CullBoxes(const frustum& f, const scene_bounds& bounds, unsigned int begin, unsigned int end, unsigned int* out);
\ No newline at end of file
@@ -0,0 +1,560 @@
+#define GL_TRACE_IMPLEMENTATION
+#include "gl_trace.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "gl_trace_format.h"
+
+
+//Every GLEW loaded function the tree calls, hooked while a trace is running
+#define GLEW_TRACE_HOOKS(HOOK) \
+    HOOK(ActiveTexture) HOOK(AttachShader) HOOK(BindBuffer) HOOK(BindBufferBase) HOOK(BindFramebuffer) \
+    HOOK(BindProgramPipeline) HOOK(BindRenderbuffer) HOOK(BindVertexArray) HOOK(BufferData) HOOK(BufferSubData) \
+    HOOK(ClientWaitSync) HOOK(CompileShader) HOOK(CreateProgram) HOOK(CreateShader) HOOK(CreateShaderProgramv) \
+    HOOK(DeleteBuffers) HOOK(DeleteFramebuffers) HOOK(DeleteProgram) HOOK(DeleteProgramPipelines) \
+    HOOK(DeleteRenderbuffers) HOOK(DeleteShader) HOOK(DeleteSync) HOOK(DeleteVertexArrays) HOOK(DetachShader) \
+    HOOK(DrawElementsBaseVertex) HOOK(DrawElementsInstanced) HOOK(EnableVertexAttribArray) HOOK(FenceSync) \
+    HOOK(FramebufferRenderbuffer) HOOK(GenBuffers) HOOK(GenFramebuffers) HOOK(GenProgramPipelines) \
+    HOOK(GenRenderbuffers) HOOK(GenVertexArrays) HOOK(GetUniformLocation) HOOK(LinkProgram) HOOK(MapBufferRange) \
+    HOOK(MaxShaderCompilerThreadsARB) HOOK(MultiDrawElementsIndirect) HOOK(ProgramUniform4f) \
+    HOOK(RenderbufferStorage) HOOK(ShaderSource) HOOK(Uniform1iv) HOOK(Uniform4f) HOOK(Uniform4fv) \
+    HOOK(UnmapBuffer) HOOK(UseProgram) HOOK(UseProgramStages) HOOK(ValidateProgram) HOOK(VertexAttribDivisor) \
+    HOOK(VertexAttribIPointer) HOOK(VertexAttribPointer)
+
+#define DECLARE_REAL(name) static decltype(__glew##name) real##name = nullptr;
+GLEW_TRACE_HOOKS(DECLARE_REAL)
+
+static FILE* traceFile = nullptr;
+static std::vector<unsigned char> traceBuffer;
+static const size_t traceFlushSize = 1 << 20;
+
+//glReadPixels writes to a buffer offset when a pack buffer is bound, to client memory otherwise
+static GLuint tracePackBuffer = 0;
+
+static void FlushTraceBuffer()
+{
+    if (!traceBuffer.empty() && fwrite(traceBuffer.data(), 1, traceBuffer.size(), traceFile) != traceBuffer.size())
+        std::cout << "[Trace] Write failed, the trace is incomplete" << std::endl;
+    traceBuffer.clear();
+}
+
+template<typename T>
+static void Put(T value)
+{
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+    traceBuffer.insert(traceBuffer.end(), bytes, bytes + sizeof(T));
+}
+
+static void PutBytes(const void* data, size_t size)
+{
+    Put((uint32_t)size);
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    traceBuffer.insert(traceBuffer.end(), bytes, bytes + size);
+}
+
+template<typename... Args>
+static void Record(gl_trace_op op, Args... args)
+{
+    if (traceBuffer.size() >= traceFlushSize)
+        FlushTraceBuffer();
+
+    Put((uint16_t)op);
+    (Put(args), ...);
+}
+
+static void RecordNames(gl_trace_op op, GLsizei n, const GLuint* names)
+{
+    Record(op, (int32_t)n);
+    for (GLsizei i = 0; i < n; i++)
+        Put((uint32_t)names[i]);
+}
+
+static uint64_t Offset(const void* pointer)
+{
+    return (uint64_t)(uintptr_t)pointer;
+}
+
+static void GLAPIENTRY TracedActiveTexture(GLenum texture)
+{
+    Record(gl_trace_op::ACTIVE_TEXTURE, (uint32_t)texture);
+    realActiveTexture(texture);
+}
+
+static void GLAPIENTRY TracedAttachShader(GLuint program, GLuint shader)
+{
+    Record(gl_trace_op::ATTACH_SHADER, (uint32_t)program, (uint32_t)shader);
+    realAttachShader(program, shader);
+}
+
+static void GLAPIENTRY TracedBindBuffer(GLenum target, GLuint buffer)
+{
+    if (target == GL_PIXEL_PACK_BUFFER)
+        tracePackBuffer = buffer;
+    Record(gl_trace_op::BIND_BUFFER, (uint32_t)target, (uint32_t)buffer);
+    realBindBuffer(target, buffer);
+}
+
+static void GLAPIENTRY TracedBindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    Record(gl_trace_op::BIND_BUFFER_BASE, (uint32_t)target, (uint32_t)index, (uint32_t)buffer);
+    realBindBufferBase(target, index, buffer);
+}
+
+static void GLAPIENTRY TracedBindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    Record(gl_trace_op::BIND_FRAMEBUFFER, (uint32_t)target, (uint32_t)framebuffer);
+    realBindFramebuffer(target, framebuffer);
+}
+
+static void GLAPIENTRY TracedBindProgramPipeline(GLuint pipeline)
+{
+    Record(gl_trace_op::BIND_PROGRAM_PIPELINE, (uint32_t)pipeline);
+    realBindProgramPipeline(pipeline);
+}
+
+static void GLAPIENTRY TracedBindRenderbuffer(GLenum target, GLuint renderbuffer)
+{
+    Record(gl_trace_op::BIND_RENDERBUFFER, (uint32_t)target, (uint32_t)renderbuffer);
+    realBindRenderbuffer(target, renderbuffer);
+}
+
+static void GLAPIENTRY TracedBindVertexArray(GLuint array)
+{
+    Record(gl_trace_op::BIND_VERTEX_ARRAY, (uint32_t)array);
+    realBindVertexArray(array);
+}
+
+static void GLAPIENTRY TracedBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+    Record(gl_trace_op::BUFFER_DATA, (uint32_t)target, (int64_t)size, (uint32_t)usage, (uint8_t)(data != nullptr));
+    if (data)
+        PutBytes(data, (size_t)size);
+    realBufferData(target, size, data, usage);
+}
+
+static void GLAPIENTRY TracedBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+    Record(gl_trace_op::BUFFER_SUB_DATA, (uint32_t)target, (int64_t)offset);
+    PutBytes(data, (size_t)size);
+    realBufferSubData(target, offset, size, data);
+}
+
+static GLenum GLAPIENTRY TracedClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+    Record(gl_trace_op::CLIENT_WAIT_SYNC, Offset(sync), (uint32_t)flags, (uint64_t)timeout);
+    return realClientWaitSync(sync, flags, timeout);
+}
+
+static void GLAPIENTRY TracedCompileShader(GLuint shader)
+{
+    Record(gl_trace_op::COMPILE_SHADER, (uint32_t)shader);
+    realCompileShader(shader);
+}
+
+static GLuint GLAPIENTRY TracedCreateProgram()
+{
+    GLuint program = realCreateProgram();
+    Record(gl_trace_op::CREATE_PROGRAM, (uint32_t)program);
+    return program;
+}
+
+static GLuint GLAPIENTRY TracedCreateShader(GLenum type)
+{
+    GLuint shader = realCreateShader(type);
+    Record(gl_trace_op::CREATE_SHADER, (uint32_t)type, (uint32_t)shader);
+    return shader;
+}
+
+static GLuint GLAPIENTRY TracedCreateShaderProgramv(GLenum type, GLsizei count, const GLchar* const* strings)
+{
+    GLuint program = realCreateShaderProgramv(type, count, strings);
+    Record(gl_trace_op::CREATE_SHADER_PROGRAMV, (uint32_t)type, (int32_t)count);
+    for (GLsizei i = 0; i < count; i++)
+        PutBytes(strings[i], strlen(strings[i]));
+    Put((uint32_t)program);
+    return program;
+}
+
+static void GLAPIENTRY TracedDeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+    RecordNames(gl_trace_op::DELETE_BUFFERS, n, buffers);
+    realDeleteBuffers(n, buffers);
+}
+
+static void GLAPIENTRY TracedDeleteFramebuffers(GLsizei n, const GLuint* framebuffers)
+{
+    RecordNames(gl_trace_op::DELETE_FRAMEBUFFERS, n, framebuffers);
+    realDeleteFramebuffers(n, framebuffers);
+}
+
+static void GLAPIENTRY TracedDeleteProgram(GLuint program)
+{
+    Record(gl_trace_op::DELETE_PROGRAM, (uint32_t)program);
+    realDeleteProgram(program);
+}
+
+static void GLAPIENTRY TracedDeleteProgramPipelines(GLsizei n, const GLuint* pipelines)
+{
+    RecordNames(gl_trace_op::DELETE_PROGRAM_PIPELINES, n, pipelines);
+    realDeleteProgramPipelines(n, pipelines);
+}
+
+static void GLAPIENTRY TracedDeleteRenderbuffers(GLsizei n, const GLuint* renderbuffers)
+{
+    RecordNames(gl_trace_op::DELETE_RENDERBUFFERS, n, renderbuffers);
+    realDeleteRenderbuffers(n, renderbuffers);
+}
+
+static void GLAPIENTRY TracedDeleteShader(GLuint shader)
+{
+    Record(gl_trace_op::DELETE_SHADER, (uint32_t)shader);
+    realDeleteShader(shader);
+}
+
+static void GLAPIENTRY TracedDeleteSync(GLsync sync)
+{
+    Record(gl_trace_op::DELETE_SYNC, Offset(sync));
+    realDeleteSync(sync);
+}
+
+static void GLAPIENTRY TracedDeleteVertexArrays(GLsizei n, const GLuint* arrays)
+{
+    RecordNames(gl_trace_op::DELETE_VERTEX_ARRAYS, n, arrays);
+    realDeleteVertexArrays(n, arrays);
+}
+
+static void GLAPIENTRY TracedDetachShader(GLuint program, GLuint shader)
+{
+    Record(gl_trace_op::DETACH_SHADER, (uint32_t)program, (uint32_t)shader);
+    realDetachShader(program, shader);
+}
+
+static void GLAPIENTRY TracedDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, void* indices, GLint basevertex)
+{
+    Record(gl_trace_op::DRAW_ELEMENTS_BASE_VERTEX, (uint32_t)mode, (int32_t)count, (uint32_t)type, Offset(indices),
+           (int32_t)basevertex);
+    realDrawElementsBaseVertex(mode, count, type, indices, basevertex);
+}
+
+static void GLAPIENTRY TracedDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei primcount)
+{
+    Record(gl_trace_op::DRAW_ELEMENTS_INSTANCED, (uint32_t)mode, (int32_t)count, (uint32_t)type, Offset(indices),
+           (int32_t)primcount);
+    realDrawElementsInstanced(mode, count, type, indices, primcount);
+}
+
+static void GLAPIENTRY TracedEnableVertexAttribArray(GLuint index)
+{
+    Record(gl_trace_op::ENABLE_VERTEX_ATTRIB_ARRAY, (uint32_t)index);
+    realEnableVertexAttribArray(index);
+}
+
+static GLsync GLAPIENTRY TracedFenceSync(GLenum condition, GLbitfield flags)
+{
+    GLsync sync = realFenceSync(condition, flags);
+    Record(gl_trace_op::FENCE_SYNC, (uint32_t)condition, (uint32_t)flags, Offset(sync));
+    return sync;
+}
+
+static void GLAPIENTRY TracedFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer)
+{
+    Record(gl_trace_op::FRAMEBUFFER_RENDERBUFFER, (uint32_t)target, (uint32_t)attachment,
+           (uint32_t)renderbuffertarget, (uint32_t)renderbuffer);
+    realFramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
+}
+
+static void GLAPIENTRY TracedGenBuffers(GLsizei n, GLuint* buffers)
+{
+    realGenBuffers(n, buffers);
+    RecordNames(gl_trace_op::GEN_BUFFERS, n, buffers);
+}
+
+static void GLAPIENTRY TracedGenFramebuffers(GLsizei n, GLuint* framebuffers)
+{
+    realGenFramebuffers(n, framebuffers);
+    RecordNames(gl_trace_op::GEN_FRAMEBUFFERS, n, framebuffers);
+}
+
+static void GLAPIENTRY TracedGenProgramPipelines(GLsizei n, GLuint* pipelines)
+{
+    realGenProgramPipelines(n, pipelines);
+    RecordNames(gl_trace_op::GEN_PROGRAM_PIPELINES, n, pipelines);
+}
+
+static void GLAPIENTRY TracedGenRenderbuffers(GLsizei n, GLuint* renderbuffers)
+{
+    realGenRenderbuffers(n, renderbuffers);
+    RecordNames(gl_trace_op::GEN_RENDERBUFFERS, n, renderbuffers);
+}
+
+static void GLAPIENTRY TracedGenVertexArrays(GLsizei n, GLuint* arrays)
+{
+    realGenVertexArrays(n, arrays);
+    RecordNames(gl_trace_op::GEN_VERTEX_ARRAYS, n, arrays);
+}
+
+static GLint GLAPIENTRY TracedGetUniformLocation(GLuint program, const GLchar* name)
+{
+    GLint location = realGetUniformLocation(program, name);
+    Record(gl_trace_op::GET_UNIFORM_LOCATION, (uint32_t)program);
+    PutBytes(name, strlen(name));
+    Put((int32_t)location);
+    return location;
+}
+
+static void GLAPIENTRY TracedLinkProgram(GLuint program)
+{
+    Record(gl_trace_op::LINK_PROGRAM, (uint32_t)program);
+    realLinkProgram(program);
+}
+
+static void* GLAPIENTRY TracedMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    Record(gl_trace_op::MAP_BUFFER_RANGE, (uint32_t)target, (int64_t)offset, (int64_t)length, (uint32_t)access);
+    return realMapBufferRange(target, offset, length, access);
+}
+
+static void GLAPIENTRY TracedMaxShaderCompilerThreadsARB(GLuint count)
+{
+    Record(gl_trace_op::MAX_SHADER_COMPILER_THREADS, (uint32_t)count);
+    realMaxShaderCompilerThreadsARB(count);
+}
+
+static void GLAPIENTRY TracedMultiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride)
+{
+    Record(gl_trace_op::MULTI_DRAW_ELEMENTS_INDIRECT, (uint32_t)mode, (uint32_t)type, Offset(indirect),
+           (int32_t)drawcount, (int32_t)stride);
+    realMultiDrawElementsIndirect(mode, type, indirect, drawcount, stride);
+}
+
+static void GLAPIENTRY TracedProgramUniform4f(GLuint program, GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
+{
+    Record(gl_trace_op::PROGRAM_UNIFORM4F, (uint32_t)program, (int32_t)location, x, y, z, w);
+    realProgramUniform4f(program, location, x, y, z, w);
+}
+
+static void GLAPIENTRY TracedRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height)
+{
+    Record(gl_trace_op::RENDERBUFFER_STORAGE, (uint32_t)target, (uint32_t)internalformat, (int32_t)width, (int32_t)height);
+    realRenderbufferStorage(target, internalformat, width, height);
+}
+
+static void GLAPIENTRY TracedShaderSource(GLuint shader, GLsizei count, const GLchar* const* strings, const GLint* lengths)
+{
+    Record(gl_trace_op::SHADER_SOURCE, (uint32_t)shader, (int32_t)count);
+    for (GLsizei i = 0; i < count; i++)
+        PutBytes(strings[i], lengths && lengths[i] >= 0 ? (size_t)lengths[i] : strlen(strings[i]));
+    realShaderSource(shader, count, strings, lengths);
+}
+
+static void GLAPIENTRY TracedUniform1iv(GLint location, GLsizei count, const GLint* value)
+{
+    Record(gl_trace_op::UNIFORM1IV, (int32_t)location);
+    PutBytes(value, count * sizeof(GLint));
+    realUniform1iv(location, count, value);
+}
+
+static void GLAPIENTRY TracedUniform4f(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
+{
+    Record(gl_trace_op::UNIFORM4F, (int32_t)location, x, y, z, w);
+    realUniform4f(location, x, y, z, w);
+}
+
+static void GLAPIENTRY TracedUniform4fv(GLint location, GLsizei count, const GLfloat* value)
+{
+    Record(gl_trace_op::UNIFORM4FV, (int32_t)location);
+    PutBytes(value, count * 4 * sizeof(GLfloat));
+    realUniform4fv(location, count, value);
+}
+
+static GLboolean GLAPIENTRY TracedUnmapBuffer(GLenum target)
+{
+    Record(gl_trace_op::UNMAP_BUFFER, (uint32_t)target);
+    return realUnmapBuffer(target);
+}
+
+static void GLAPIENTRY TracedUseProgram(GLuint program)
+{
+    Record(gl_trace_op::USE_PROGRAM, (uint32_t)program);
+    realUseProgram(program);
+}
+
+static void GLAPIENTRY TracedUseProgramStages(GLuint pipeline, GLbitfield stages, GLuint program)
+{
+    Record(gl_trace_op::USE_PROGRAM_STAGES, (uint32_t)pipeline, (uint32_t)stages, (uint32_t)program);
+    realUseProgramStages(pipeline, stages, program);
+}
+
+static void GLAPIENTRY TracedValidateProgram(GLuint program)
+{
+    Record(gl_trace_op::VALIDATE_PROGRAM, (uint32_t)program);
+    realValidateProgram(program);
+}
+
+static void GLAPIENTRY TracedVertexAttribDivisor(GLuint index, GLuint divisor)
+{
+    Record(gl_trace_op::VERTEX_ATTRIB_DIVISOR, (uint32_t)index, (uint32_t)divisor);
+    realVertexAttribDivisor(index, divisor);
+}
+
+static void GLAPIENTRY TracedVertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer)
+{
+    Record(gl_trace_op::VERTEX_ATTRIB_IPOINTER, (uint32_t)index, (int32_t)size, (uint32_t)type, (int32_t)stride,
+           Offset(pointer));
+    realVertexAttribIPointer(index, size, type, stride, pointer);
+}
+
+static void GLAPIENTRY TracedVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer)
+{
+    Record(gl_trace_op::VERTEX_ATTRIB_POINTER, (uint32_t)index, (int32_t)size, (uint32_t)type, (uint8_t)normalized,
+           (int32_t)stride, Offset(pointer));
+    realVertexAttribPointer(index, size, type, normalized, stride, pointer);
+}
+
+//GL 1.1 entry points, reached through the macros in gl_trace.h
+
+void GLAPIENTRY TracedBindTexture(GLenum target, GLuint texture)
+{
+    if (traceFile)
+        Record(gl_trace_op::BIND_TEXTURE, (uint32_t)target, (uint32_t)texture);
+    glBindTexture(target, texture);
+}
+
+void GLAPIENTRY TracedClear(GLbitfield mask)
+{
+    if (traceFile)
+        Record(gl_trace_op::CLEAR, (uint32_t)mask);
+    glClear(mask);
+}
+
+void GLAPIENTRY TracedClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+    if (traceFile)
+        Record(gl_trace_op::CLEAR_COLOR, red, green, blue, alpha);
+    glClearColor(red, green, blue, alpha);
+}
+
+void GLAPIENTRY TracedDisable(GLenum cap)
+{
+    if (traceFile)
+        Record(gl_trace_op::DISABLE, (uint32_t)cap);
+    glDisable(cap);
+}
+
+void GLAPIENTRY TracedDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+    if (traceFile)
+        Record(gl_trace_op::DRAW_ELEMENTS, (uint32_t)mode, (int32_t)count, (uint32_t)type, Offset(indices));
+    glDrawElements(mode, count, type, indices);
+}
+
+void GLAPIENTRY TracedEnable(GLenum cap)
+{
+    if (traceFile)
+        Record(gl_trace_op::ENABLE, (uint32_t)cap);
+    glEnable(cap);
+}
+
+void GLAPIENTRY TracedFlush()
+{
+    if (traceFile)
+        Record(gl_trace_op::FLUSH);
+    glFlush();
+}
+
+void GLAPIENTRY TracedPixelStorei(GLenum pname, GLint param)
+{
+    if (traceFile)
+        Record(gl_trace_op::PIXEL_STOREI, (uint32_t)pname, (int32_t)param);
+    glPixelStorei(pname, param);
+}
+
+void GLAPIENTRY TracedReadBuffer(GLenum mode)
+{
+    if (traceFile)
+        Record(gl_trace_op::READ_BUFFER, (uint32_t)mode);
+    glReadBuffer(mode);
+}
+
+void GLAPIENTRY TracedReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels)
+{
+    if (traceFile)
+        Record(gl_trace_op::READ_PIXELS, (int32_t)x, (int32_t)y, (int32_t)width, (int32_t)height, (uint32_t)format,
+               (uint32_t)type, (uint8_t)(tracePackBuffer != 0), tracePackBuffer != 0 ? Offset(pixels) : (uint64_t)0);
+    glReadPixels(x, y, width, height, format, type, pixels);
+}
+
+void GLAPIENTRY TracedScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if (traceFile)
+        Record(gl_trace_op::SCISSOR, (int32_t)x, (int32_t)y, (int32_t)width, (int32_t)height);
+    glScissor(x, y, width, height);
+}
+
+void GLAPIENTRY TracedViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    if (traceFile)
+        Record(gl_trace_op::VIEWPORT, (int32_t)x, (int32_t)y, (int32_t)width, (int32_t)height);
+    glViewport(x, y, width, height);
+}
+
+bool BeginGLTrace(const std::string& filepath, int width, int height)
+{
+#ifndef GL_TRACE
+    (void)filepath;
+    (void)width;
+    (void)height;
+    std::cout << "[Trace] Built without GL_TRACE, GL 1.1 calls can't be recorded" << std::endl;
+    return false;
+#else
+    if (traceFile)
+        return false;
+
+    traceFile = fopen(filepath.c_str(), "wb");
+    if (!traceFile)
+    {
+        std::cout << "[Trace] Could not open " << filepath << std::endl;
+        return false;
+    }
+
+    gl_trace_header header = { glTraceMagic, glTraceVersion, width, height };
+    fwrite(&header, sizeof(header), 1, traceFile);
+    traceBuffer.reserve(traceFlushSize * 2);
+    tracePackBuffer = 0;
+
+    //Extensions that aren't there stay null and unhooked
+#define INSTALL_HOOK(name) real##name = __glew##name; if (real##name) __glew##name = Traced##name;
+    GLEW_TRACE_HOOKS(INSTALL_HOOK)
+#undef INSTALL_HOOK
+    return true;
+#endif
+}
+
+void MarkGLTraceFrame()
+{
+    if (traceFile)
+        Record(gl_trace_op::FRAME);
+}
+
+void EndGLTrace()
+{
+    if (!traceFile)
+        return;
+
+#define RESTORE_HOOK(name) if (real##name) __glew##name = real##name;
+    GLEW_TRACE_HOOKS(RESTORE_HOOK)
+#undef RESTORE_HOOK
+
+    FlushTraceBuffer();
+    fclose(traceFile);
+    traceFile = nullptr;
+}
+
+bool IsGLTraceActive()
+{
+    return traceFile != nullptr;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <string>
+
+//Records every GL call the renderer makes, with buffer contents, shader sources
+//and uniform values, into a binary trace (see gl_trace_format.h) that
+//tools/gl_replay re-issues as fast as it can. Calls loaded by GLEW are caught by
+//swapping GLEW's function pointers; the few GL 1.1 entry points GLEW doesn't load
+//are redirected by the macros below, which renderer.h pulls in for GL_TRACE builds.
+//Queries (glGet*, glGetError...) aren't recorded, and neither is what the app
+//writes through mapped pointers: the tree only maps buffers for reading.
+//
+//One GL thread at a time, like the context itself.
+
+//Call after glewInit with the default framebuffer size. Without GL_TRACE the
+//GL 1.1 calls can't be caught, so this refuses to start.
+bool BeginGLTrace(const std::string& filepath, int width, int height);
+
+//Marks the end of a frame, call right after swapping buffers
+void MarkGLTraceFrame();
+
+//Restores GLEW's function pointers and closes the trace
+void EndGLTrace();
+
+bool IsGLTraceActive();
+
+void GLAPIENTRY TracedBindTexture(GLenum target, GLuint texture);
+void GLAPIENTRY TracedClear(GLbitfield mask);
+void GLAPIENTRY TracedClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+void GLAPIENTRY TracedDisable(GLenum cap);
+void GLAPIENTRY TracedDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices);
+void GLAPIENTRY TracedEnable(GLenum cap);
+void GLAPIENTRY TracedFlush();
+void GLAPIENTRY TracedPixelStorei(GLenum pname, GLint param);
+void GLAPIENTRY TracedReadBuffer(GLenum mode);
+void GLAPIENTRY TracedReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels);
+void GLAPIENTRY TracedScissor(GLint x, GLint y, GLsizei width, GLsizei height);
+void GLAPIENTRY TracedViewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+#if defined(GL_TRACE) && !defined(GL_TRACE_IMPLEMENTATION)
+#define glBindTexture TracedBindTexture
+#define glClear TracedClear
+#define glClearColor TracedClearColor
+#define glDisable TracedDisable
+#define glDrawElements TracedDrawElements
+#define glEnable TracedEnable
+#define glFlush TracedFlush
+#define glPixelStorei TracedPixelStorei
+#define glReadBuffer TracedReadBuffer
+#define glReadPixels TracedReadPixels
+#define glScissor TracedScissor
+#define glViewport TracedViewport
+#endif
\ No newline at end of file
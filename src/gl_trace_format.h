@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+
+//Binary GL trace shared by the recorder (gl_trace.cpp) and tools/gl_replay.cpp.
+//Little endian: a gl_trace_header, then one record per call, a uint16 opcode
+//followed by the arguments in call order with the sizes listed next to each op.
+//Object names, sync objects and uniform locations are stored as the recording
+//saw them; the replayer maps them to its own. "bytes" is a uint32 size followed
+//by that many bytes. Buffer offsets passed as pointers are stored as u64.
+
+static const uint32_t glTraceMagic = 0x52544c47; //"GLTR"
+static const uint32_t glTraceVersion = 1;
+
+struct gl_trace_header
+{
+	uint32_t Magic;
+	uint32_t Version;
+	int32_t Width;  //default framebuffer size when recording started
+	int32_t Height;
+};
+
+enum class gl_trace_op : uint16_t
+{
+	FRAME,                        //end of a frame, the recording swapped buffers
+	ACTIVE_TEXTURE,               //u32 texture
+	ATTACH_SHADER,                //u32 program, u32 shader
+	BIND_BUFFER,                  //u32 target, u32 buffer
+	BIND_BUFFER_BASE,             //u32 target, u32 index, u32 buffer
+	BIND_FRAMEBUFFER,             //u32 target, u32 framebuffer
+	BIND_PROGRAM_PIPELINE,        //u32 pipeline
+	BIND_RENDERBUFFER,            //u32 target, u32 renderbuffer
+	BIND_TEXTURE,                 //u32 target, u32 texture
+	BIND_VERTEX_ARRAY,            //u32 array
+	BUFFER_DATA,                  //u32 target, i64 size, u32 usage, u8 has data, [bytes data]
+	BUFFER_SUB_DATA,              //u32 target, i64 offset, bytes data
+	CLEAR,                        //u32 mask
+	CLEAR_COLOR,                  //f32 r, g, b, a
+	CLIENT_WAIT_SYNC,             //u64 sync, u32 flags, u64 timeout
+	COMPILE_SHADER,               //u32 shader
+	CREATE_PROGRAM,               //u32 result
+	CREATE_SHADER,                //u32 type, u32 result
+	CREATE_SHADER_PROGRAMV,       //u32 type, i32 count, count x bytes, u32 result
+	DELETE_BUFFERS,               //i32 n, n x u32
+	DELETE_FRAMEBUFFERS,          //i32 n, n x u32
+	DELETE_PROGRAM,               //u32 program
+	DELETE_PROGRAM_PIPELINES,     //i32 n, n x u32
+	DELETE_RENDERBUFFERS,         //i32 n, n x u32
+	DELETE_SHADER,                //u32 shader
+	DELETE_SYNC,                  //u64 sync
+	DELETE_VERTEX_ARRAYS,         //i32 n, n x u32
+	DETACH_SHADER,                //u32 program, u32 shader
+	DISABLE,                      //u32 cap
+	DRAW_ELEMENTS,                //u32 mode, i32 count, u32 type, u64 offset
+	DRAW_ELEMENTS_BASE_VERTEX,    //u32 mode, i32 count, u32 type, u64 offset, i32 base vertex
+	DRAW_ELEMENTS_INSTANCED,      //u32 mode, i32 count, u32 type, u64 offset, i32 instances
+	ENABLE,                       //u32 cap
+	ENABLE_VERTEX_ATTRIB_ARRAY,   //u32 index
+	FENCE_SYNC,                   //u32 condition, u32 flags, u64 result
+	FLUSH,
+	FRAMEBUFFER_RENDERBUFFER,     //u32 target, u32 attachment, u32 renderbuffer target, u32 renderbuffer
+	GEN_BUFFERS,                  //i32 n, n x u32 result
+	GEN_FRAMEBUFFERS,             //i32 n, n x u32 result
+	GEN_PROGRAM_PIPELINES,        //i32 n, n x u32 result
+	GEN_RENDERBUFFERS,            //i32 n, n x u32 result
+	GEN_VERTEX_ARRAYS,            //i32 n, n x u32 result
+	GET_UNIFORM_LOCATION,         //u32 program, bytes name, i32 result
+	LINK_PROGRAM,                 //u32 program
+	MAP_BUFFER_RANGE,             //u32 target, i64 offset, i64 length, u32 access
+	MAX_SHADER_COMPILER_THREADS,  //u32 count
+	MULTI_DRAW_ELEMENTS_INDIRECT, //u32 mode, u32 type, u64 offset, i32 draw count, i32 stride
+	PIXEL_STOREI,                 //u32 name, i32 value
+	PROGRAM_UNIFORM4F,            //u32 program, i32 location, f32 x, y, z, w
+	READ_BUFFER,                  //u32 mode
+	READ_PIXELS,                  //i32 x, y, width, height, u32 format, u32 type, u8 into pack buffer, u64 offset
+	RENDERBUFFER_STORAGE,         //u32 target, u32 format, i32 width, i32 height
+	SCISSOR,                      //i32 x, y, width, height
+	SHADER_SOURCE,                //u32 shader, i32 count, count x bytes
+	UNIFORM1IV,                   //i32 location, bytes values
+	UNIFORM4F,                    //i32 location, f32 x, y, z, w
+	UNIFORM4FV,                   //i32 location, bytes values
+	UNMAP_BUFFER,                 //u32 target
+	USE_PROGRAM,                  //u32 program
+	USE_PROGRAM_STAGES,           //u32 pipeline, u32 stages, u32 program
+	VALIDATE_PROGRAM,             //u32 program
+	VERTEX_ATTRIB_DIVISOR,        //u32 index, u32 divisor
+	VERTEX_ATTRIB_IPOINTER,       //u32 index, i32 size, u32 type, i32 stride, u64 offset
+	VERTEX_ATTRIB_POINTER,        //u32 index, i32 size, u32 type, u8 normalized, i32 stride, u64 offset
+	VIEWPORT,                     //i32 x, y, width, height
+	COUNT
+};
\ No newline at end of file
@@ -0,0 +1,266 @@
+#include "image_encoder.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+
+static inline const unsigned char* Row(const unsigned char* pixels, int width, int height, bool bottomUp, int y)
+{
+    return pixels + (size_t)(bottomUp ? height - 1 - y : y) * width * 4;
+}
+
+static inline void PutBE32(std::vector<unsigned char>& out, uint32_t value)
+{
+    out.push_back((unsigned char)(value >> 24));
+    out.push_back((unsigned char)(value >> 16));
+    out.push_back((unsigned char)(value >> 8));
+    out.push_back((unsigned char)value);
+}
+
+void EncodeQOI(const unsigned char* pixels, int width, int height, bool bottomUp, std::vector<unsigned char>& out)
+{
+    //Straight from the QOI specification (qoiformat.org)
+    const unsigned char opIndex = 0x00, opDiff = 0x40, opLuma = 0x80, opRun = 0xc0, opRGB = 0xfe, opRGBA = 0xff;
+
+    out.clear();
+    out.reserve(14 + (size_t)width * height * 5 + 8);
+    out.insert(out.end(), { 'q', 'o', 'i', 'f' });
+    PutBE32(out, (uint32_t)width);
+    PutBE32(out, (uint32_t)height);
+    out.push_back(4); //channels
+    out.push_back(0); //sRGB with linear alpha
+
+    unsigned char seen[64][4] = {};
+    unsigned char prev[4] = { 0, 0, 0, 255 };
+    unsigned int run = 0;
+
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned char* px = Row(pixels, width, height, bottomUp, y);
+        for (int x = 0; x < width; x++, px += 4)
+        {
+            if (memcmp(px, prev, 4) == 0)
+            {
+                if (++run == 62)
+                {
+                    out.push_back(opRun | (run - 1));
+                    run = 0;
+                }
+                continue;
+            }
+            if (run > 0)
+            {
+                out.push_back(opRun | (run - 1));
+                run = 0;
+            }
+
+            unsigned int hash = (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64;
+            if (memcmp(seen[hash], px, 4) == 0)
+            {
+                out.push_back(opIndex | hash);
+            }
+            else
+            {
+                memcpy(seen[hash], px, 4);
+                if (px[3] == prev[3])
+                {
+                    signed char dr = (signed char)(px[0] - prev[0]);
+                    signed char dg = (signed char)(px[1] - prev[1]);
+                    signed char db = (signed char)(px[2] - prev[2]);
+                    signed char drg = (signed char)(dr - dg);
+                    signed char dbg = (signed char)(db - dg);
+
+                    if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+                    {
+                        out.push_back(opDiff | (unsigned char)((dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+                    }
+                    else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7)
+                    {
+                        out.push_back(opLuma | (unsigned char)(dg + 32));
+                        out.push_back((unsigned char)((drg + 8) << 4 | (dbg + 8)));
+                    }
+                    else
+                    {
+                        out.insert(out.end(), { opRGB, px[0], px[1], px[2] });
+                    }
+                }
+                else
+                {
+                    out.insert(out.end(), { opRGBA, px[0], px[1], px[2], px[3] });
+                }
+            }
+            memcpy(prev, px, 4);
+        }
+    }
+    if (run > 0)
+        out.push_back(opRun | (run - 1));
+
+    out.insert(out.end(), { 0, 0, 0, 0, 0, 0, 0, 1 });
+}
+
+#ifndef HAVE_ZLIB
+struct crc_table
+{
+    uint32_t Entries[256];
+
+    crc_table()
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            Entries[i] = c;
+        }
+    }
+};
+
+static uint32_t crc32(uint32_t crc, const unsigned char* data, size_t size)
+{
+    //Function local static, so encoder threads can't race on building it
+    static const crc_table table;
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+        crc = table.Entries[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+static uint32_t adler32(uint32_t adler, const unsigned char* data, size_t size)
+{
+    uint32_t a = adler & 0xffff, b = adler >> 16;
+    while (size > 0)
+    {
+        //5552 bytes is the most that can be summed before b could overflow
+        size_t block = size < 5552 ? size : 5552;
+        for (size_t i = 0; i < block; i++)
+        {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+        data += block;
+        size -= block;
+    }
+    return b << 16 | a;
+}
+#endif
+
+//Appends a chunk whose data is already at out[start + 8...], filling in length and CRC
+static void FinishChunk(std::vector<unsigned char>& out, size_t start)
+{
+    uint32_t length = (uint32_t)(out.size() - start - 8);
+    out[start + 0] = (unsigned char)(length >> 24);
+    out[start + 1] = (unsigned char)(length >> 16);
+    out[start + 2] = (unsigned char)(length >> 8);
+    out[start + 3] = (unsigned char)length;
+    PutBE32(out, (uint32_t)crc32(0, out.data() + start + 4, length + 4));
+}
+
+static size_t BeginChunk(std::vector<unsigned char>& out, const char* type)
+{
+    size_t start = out.size();
+    out.insert(out.end(), { 0, 0, 0, 0 });
+    out.insert(out.end(), type, type + 4);
+    return start;
+}
+
+void EncodePNG(const unsigned char* pixels, int width, int height, bool bottomUp, std::vector<unsigned char>& out,
+               std::vector<unsigned char>& scratch, int level)
+{
+    size_t rowSize = (size_t)width * 4;
+
+    //Each row gets a filter byte. Sub (1) costs next to nothing and helps deflate a
+    //lot on smooth gradients; stored blocks don't compress, so they get None (0).
+    scratch.resize((rowSize + 1) * height);
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned char* src = Row(pixels, width, height, bottomUp, y);
+        unsigned char* dst = scratch.data() + (rowSize + 1) * y;
+#ifdef HAVE_ZLIB
+        dst[0] = 1;
+        memcpy(dst + 1, src, 4);
+        for (size_t i = 4; i < rowSize; i++)
+            dst[1 + i] = (unsigned char)(src[i] - src[i - 4]);
+#else
+        dst[0] = 0;
+        memcpy(dst + 1, src, rowSize);
+#endif
+    }
+
+    out.clear();
+    out.insert(out.end(), { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' });
+
+    size_t chunk = BeginChunk(out, "IHDR");
+    PutBE32(out, (uint32_t)width);
+    PutBE32(out, (uint32_t)height);
+    out.insert(out.end(), { 8, 6, 0, 0, 0 }); //8 bit RGBA, deflate, adaptive filtering, no interlace
+    FinishChunk(out, chunk);
+
+    chunk = BeginChunk(out, "IDAT");
+#ifdef HAVE_ZLIB
+    size_t start = out.size();
+    uLongf size = compressBound((uLong)scratch.size());
+    out.resize(start + size);
+    if (compress2(out.data() + start, &size, scratch.data(), (uLong)scratch.size(), level) != Z_OK)
+        size = 0;
+    out.resize(start + size);
+#else
+    (void)level;
+    out.insert(out.end(), { 0x78, 0x01 }); //zlib header: deflate, 32K window, no dictionary
+    size_t remaining = scratch.size();
+    const unsigned char* data = scratch.data();
+    do
+    {
+        unsigned int block = remaining < 65535 ? (unsigned int)remaining : 65535;
+        remaining -= block;
+        out.push_back(remaining == 0 ? 1 : 0); //BFINAL, BTYPE 00 = stored
+        out.insert(out.end(), { (unsigned char)block, (unsigned char)(block >> 8),
+                                (unsigned char)~block, (unsigned char)(~block >> 8) });
+        out.insert(out.end(), data, data + block);
+        data += block;
+    } while (remaining > 0);
+    PutBE32(out, adler32(1, scratch.data(), scratch.size()));
+#endif
+    FinishChunk(out, chunk);
+
+    chunk = BeginChunk(out, "IEND");
+    FinishChunk(out, chunk);
+}
+
+void EncodeY4MHeader(int width, int height, int fps, std::vector<unsigned char>& out)
+{
+    char header[96];
+    int length = snprintf(header, sizeof(header), "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C444\n", width, height, fps);
+    out.assign(header, header + length);
+}
+
+void EncodeY4MFrame(const unsigned char* pixels, int width, int height, bool bottomUp, std::vector<unsigned char>& out)
+{
+    static const char frameTag[] = "FRAME\n";
+    size_t plane = (size_t)width * height;
+
+    out.resize(sizeof(frameTag) - 1 + plane * 3);
+    memcpy(out.data(), frameTag, sizeof(frameTag) - 1);
+    unsigned char* planeY = out.data() + sizeof(frameTag) - 1;
+    unsigned char* planeU = planeY + plane;
+    unsigned char* planeV = planeU + plane;
+
+    //BT.601 studio range in 8 bit fixed point
+    for (int y = 0; y < height; y++)
+    {
+        const unsigned char* px = Row(pixels, width, height, bottomUp, y);
+        for (int x = 0; x < width; x++, px += 4)
+        {
+            int r = px[0], g = px[1], b = px[2];
+            *planeY++ = (unsigned char)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+            *planeU++ = (unsigned char)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            *planeV++ = (unsigned char)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <vector>
+
+enum class image_format
+{
+	QOI, //one file per frame, fast lossless
+	PNG, //one file per frame
+	Y4M  //one raw YCbCr stream, e.g. piped into a video encoder
+};
+
+//Encoders for tightly packed RGBA8 pixels. bottomUp flips the rows on the way,
+//since glReadPixels hands them out bottom row first. out is cleared first but
+//keeps its capacity, so reusing the vectors per thread stops allocations.
+
+void EncodeQOI(const unsigned char* pixels, int width, int height, bool bottomUp, std::vector<unsigned char>& out);
+
+//level is the zlib level, 1 is the fast one. Without HAVE_ZLIB the image data goes
+//into uncompressed deflate blocks instead: big files, but valid PNGs and no copying
+//beyond the filter bytes. scratch holds the filtered rows.
+void EncodePNG(const unsigned char* pixels, int width, int height, bool bottomUp, std::vector<unsigned char>& out,
+               std::vector<unsigned char>& scratch, int level = 1);
+
+//Stream header, written once before the first frame
+void EncodeY4MHeader(int width, int height, int fps, std::vector<unsigned char>& out);
+
+//One frame as planar 4:4:4 BT.601 studio range YCbCr, alpha is dropped
+void EncodeY4MFrame(const unsigned char* pixels, int width, int height, bool bottomUp, std::vector<unsigned char>& out);
@@ -0,0 +1,96 @@
+#include "indirect_batch.h"
+
+#include "renderer.h"
+
+
+indirect_batch::indirect_batch(mesh_pool& pool, unsigned int maxDraws, bool allowIndirect)
+    : m_Pool(pool), m_CommandBuffer(0), m_DataBuffer(0), m_MaxDraws(maxDraws),
+      m_Indirect(allowIndirect && GLEW_ARB_multi_draw_indirect && GLEW_ARB_shader_storage_buffer_object && GLEW_ARB_base_instance)
+{
+    m_Commands.reserve(maxDraws);
+    m_DrawData.reserve(maxDraws);
+
+    if (!m_Indirect)
+        return;
+
+    //Draw i uses BaseInstance i, so this per-instance attribute reads back i
+    m_Pool.ReserveDrawIDs(maxDraws);
+
+    GLCall(glGenBuffers(1, &m_CommandBuffer));
+    GLCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_CommandBuffer));
+    GLCall(glBufferData(GL_DRAW_INDIRECT_BUFFER, maxDraws * sizeof(draw_elements_indirect_command), nullptr, GL_STREAM_DRAW));
+
+    GLCall(glGenBuffers(1, &m_DataBuffer));
+    GLCall(glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_DataBuffer));
+    GLCall(glBufferData(GL_SHADER_STORAGE_BUFFER, maxDraws * sizeof(indirect_draw_data), nullptr, GL_STREAM_DRAW));
+}
+
+indirect_batch::~indirect_batch()
+{
+    if (m_Indirect)
+    {
+        GLCall(glDeleteBuffers(1, &m_CommandBuffer));
+        GLCall(glDeleteBuffers(1, &m_DataBuffer));
+    }
+}
+
+bool indirect_batch::Add(const mesh_range& mesh, const indirect_draw_data& data)
+{
+    if (m_Commands.size() >= m_MaxDraws)
+        return false;
+
+    draw_elements_indirect_command command;
+    command.Count = mesh.IndexCount;
+    command.InstanceCount = 1;
+    command.FirstIndex = mesh.FirstIndex;
+    command.BaseVertex = mesh.BaseVertex;
+    command.BaseInstance = (unsigned int)m_Commands.size();
+
+    m_Commands.push_back(command);
+    m_DrawData.push_back(data);
+    return true;
+}
+
+void indirect_batch::Submit(unsigned int program)
+{
+    if (m_Commands.empty())
+        return;
+
+    GLCall(glUseProgram(program));
+    m_Pool.GetVertexArray().bind();
+
+    if (m_Indirect)
+    {
+        //Orphan and refill both buffers, then one call for the whole batch
+        GLCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_CommandBuffer));
+        GLCall(glBufferData(GL_DRAW_INDIRECT_BUFFER, m_MaxDraws * sizeof(draw_elements_indirect_command), nullptr, GL_STREAM_DRAW));
+        GLCall(glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, m_Commands.size() * sizeof(draw_elements_indirect_command), m_Commands.data()));
+
+        GLCall(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_DataBuffer));
+        GLCall(glBufferData(GL_SHADER_STORAGE_BUFFER, m_MaxDraws * sizeof(indirect_draw_data), nullptr, GL_STREAM_DRAW));
+        GLCall(glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_DrawData.size() * sizeof(indirect_draw_data), m_DrawData.data()));
+
+        GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, (int)m_Commands.size(), 0));
+    }
+    else
+    {
+        //GL 3.3 fallback: same draws in the same order, data through a uniform
+        auto found = m_DrawDataLocations.find(program);
+        if (found == m_DrawDataLocations.end())
+            found = m_DrawDataLocations.emplace(program, glGetUniformLocation(program, "u_DrawData")).first;
+        int location = found->second;
+        for (size_t i = 0; i < m_Commands.size(); i++)
+        {
+            const draw_elements_indirect_command& command = m_Commands[i];
+            GLCall(glUniform4fv(location, 2, (const float*)&m_DrawData[i]));  //Transform, Color
+            GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, command.Count, GL_UNSIGNED_INT,
+                                            (void*)(command.FirstIndex * sizeof(unsigned int)), command.BaseVertex));
+        }
+    }
+}
+
+void indirect_batch::Clear()
+{
+    m_Commands.clear();
+    m_DrawData.clear();
+}
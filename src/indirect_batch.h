@@ -0,0 +1,62 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "mesh_pool.h"
+
+//Layout fixed by the GL spec for glMultiDrawElementsIndirect
+struct draw_elements_indirect_command
+{
+	unsigned int Count;
+	unsigned int InstanceCount;
+	unsigned int FirstIndex;
+	int BaseVertex;
+	unsigned int BaseInstance;
+};
+
+//Per-draw data, read from a shader storage buffer (or a uniform in the fallback)
+struct indirect_draw_data
+{
+	float Transform[4]; //xy = offset, zw = scale
+	float Color[4];
+};
+
+//Packs many draws of meshes from one mesh_pool into a single
+//glMultiDrawElementsIndirect. Each draw's BaseInstance is its index, which a
+//per-instance draw id attribute (mesh_pool::ReserveDrawIDs) turns into an index
+//into the draw data buffer (see res/shaders/indirect.shader). Without GL 4.3 level support it falls back
+//to one glDrawElementsBaseVertex per draw with the data passed as a uniform,
+//producing the same output; build the program with INDIRECT set to IsIndirect().
+//allowIndirect false takes the fallback on any driver, to compare the two.
+class indirect_batch
+{
+private:
+	mesh_pool& m_Pool;
+	std::vector<draw_elements_indirect_command> m_Commands;
+	std::vector<indirect_draw_data> m_DrawData;
+	unsigned int m_CommandBuffer;
+	unsigned int m_DataBuffer;
+	std::unordered_map<unsigned int, int> m_DrawDataLocations; //fallback only, by program
+	unsigned int m_MaxDraws;
+	bool m_Indirect;
+
+public:
+	indirect_batch(mesh_pool& pool, unsigned int maxDraws, bool allowIndirect = true);
+	~indirect_batch();
+
+	indirect_batch(const indirect_batch&) = delete;
+	indirect_batch& operator=(const indirect_batch&) = delete;
+
+	//Returns false once maxDraws is reached, Submit and Clear to start over
+	bool Add(const mesh_range& mesh, const indirect_draw_data& data);
+
+	//The fallback looks up u_DrawData once per program, so don't reuse the batch
+	//with a program created in place of a deleted one
+	void Submit(unsigned int program);
+
+	void Clear();
+
+	inline bool IsIndirect() const { return m_Indirect; }
+	inline unsigned int GetDrawCount() const { return (unsigned int)m_Commands.size(); }
+};
@@ -0,0 +1,333 @@
+#include "job_system.h"
+
+#include <chrono>
+
+
+static thread_local unsigned int threadIndex = 0;
+
+//Failed steal rounds before an idle worker goes to sleep
+static const unsigned int idleSpins = 256;
+
+job_deque::job_deque()
+    : m_Top(0), m_Bottom(0)
+{
+    for (std::atomic<job*>& slot : m_Jobs)
+        slot.store(nullptr, std::memory_order_relaxed);
+}
+
+bool job_deque::Push(job* job)
+{
+    long long bottom = m_Bottom.load(std::memory_order_relaxed);
+    long long top = m_Top.load(std::memory_order_acquire);
+    if (bottom - top >= capacity)
+        return false;
+
+    m_Jobs[bottom & (capacity - 1)].store(job, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+    return true;
+}
+
+job* job_deque::Pop()
+{
+    long long bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+    m_Bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long long top = m_Top.load(std::memory_order_relaxed);
+
+    if (top > bottom)
+    {
+        //Empty
+        m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    job* job = m_Jobs[bottom & (capacity - 1)].load(std::memory_order_relaxed);
+    if (top == bottom)
+    {
+        //Last job, race the thieves for it
+        if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            job = nullptr;
+        m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+job* job_deque::Steal()
+{
+    long long top = m_Top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    long long bottom = m_Bottom.load(std::memory_order_acquire);
+
+    if (top >= bottom)
+        return nullptr;
+
+    job* job = m_Jobs[top & (capacity - 1)].load(std::memory_order_relaxed);
+    if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return nullptr;
+    return job;
+}
+
+job_system::thread_state::thread_state()
+{
+    for (std::atomic<bool>& used : SlotUsed)
+        used.store(false, std::memory_order_relaxed);
+}
+
+job_system::job_system(unsigned int workerCount)
+    : m_Running(true), m_MainThreadNext(0), m_HasMainThreadJobs(false), m_BlockedCount(0), m_Sleeping(0)
+{
+    if (workerCount == 0)
+    {
+        unsigned int hardware = std::thread::hardware_concurrency();
+        workerCount = hardware > 1 ? hardware - 1 : 1;
+    }
+
+    threadIndex = 0;
+    for (unsigned int i = 0; i < workerCount + 1; i++)
+        m_States.push_back(std::make_unique<thread_state>());
+    //Every blocked job holds a pool slot, so this never grows
+    m_Blocked.reserve(m_States.size() * jobPoolSize);
+
+    for (unsigned int i = 1; i <= workerCount; i++)
+        m_Workers.emplace_back(&job_system::WorkerLoop, this, i);
+}
+
+job_system::~job_system()
+{
+    m_Running = false;
+    {
+        std::lock_guard<std::mutex> lock(m_SleepMutex);
+        m_WakeUp.notify_all();
+    }
+
+    for (std::thread& worker : m_Workers)
+        worker.join();
+}
+
+unsigned int job_system::GetThreadIndex()
+{
+    return threadIndex;
+}
+
+job* job_system::AllocateJob(thread_state& state, const job& job)
+{
+    //Only the owner takes slots, any thread may free them, so a plain load and store suffice
+    for (unsigned int i = 0; i < jobPoolSize; i++)
+    {
+        unsigned int slot = state.NextJob++ % jobPoolSize;
+        if (state.SlotUsed[slot].load(std::memory_order_acquire))
+            continue;
+
+        state.SlotUsed[slot].store(true, std::memory_order_relaxed);
+        struct job* queued = &state.JobPool[slot];
+        *queued = job;
+        queued->PoolSlot = &state.SlotUsed[slot];
+        return queued;
+    }
+    return nullptr;
+}
+
+void job_system::Run(const job& job)
+{
+    //Jobs are copied into a pool owned by the calling thread and the slot is freed
+    //once the job has run
+    thread_state& state = *m_States[threadIndex];
+    if (struct job* queued = AllocateJob(state, job))
+    {
+        if (state.Deque.Push(queued))
+        {
+            if (m_Sleeping.load(std::memory_order_relaxed) > 0)
+                m_WakeUp.notify_one();
+            return;
+        }
+        queued->PoolSlot->store(false, std::memory_order_relaxed);
+    }
+
+    //Pool or deque full: run it right here, once it may start
+    if (job.Dependency)
+        Wait(*job.Dependency);
+    struct job local = job;
+    local.PoolSlot = nullptr;
+    Execute(&local);
+}
+
+void job_system::RunAfter(const std::atomic<unsigned int>& dependency, const job& job)
+{
+    struct job deferred = job;
+    deferred.Dependency = &dependency;
+    Run(deferred);
+}
+
+void job_system::RunOnMainThread(const job& job)
+{
+    std::lock_guard<std::mutex> lock(m_MainThreadMutex);
+    m_MainThreadJobs.push_back(job);
+    m_HasMainThreadJobs.store(true, std::memory_order_release);
+}
+
+void job_system::RunMainThreadJobs()
+{
+    if (!m_HasMainThreadJobs.load(std::memory_order_acquire) && m_MainThreadNext == m_MainThreadRunning.size())
+        return;
+
+    //Take the queue out so jobs can queue more main-thread work while running. A
+    //call from inside a job appends behind the ones the outer call has not reached.
+    {
+        std::lock_guard<std::mutex> lock(m_MainThreadMutex);
+        if (m_MainThreadRunning.empty())
+            m_MainThreadRunning.swap(m_MainThreadJobs);
+        else
+        {
+            m_MainThreadRunning.insert(m_MainThreadRunning.end(), m_MainThreadJobs.begin(), m_MainThreadJobs.end());
+            m_MainThreadJobs.clear();
+        }
+        m_HasMainThreadJobs.store(false, std::memory_order_relaxed);
+    }
+
+    //Each job is claimed before it runs and copied out, as a nested call may grow the vector
+    while (m_MainThreadNext < m_MainThreadRunning.size())
+    {
+        job next = m_MainThreadRunning[m_MainThreadNext++];
+        if (next.Dependency && next.Dependency->load(std::memory_order_acquire) > 0)
+        {
+            RunOnMainThread(next);
+            continue;
+        }
+        Execute(&next);
+    }
+    m_MainThreadRunning.clear();
+    m_MainThreadNext = 0;
+}
+
+unsigned int job_system::GetAdaptiveGrainSize(unsigned int count) const
+{
+    //About eight pieces per thread leaves enough slack for stealing to even out
+    //uneven work without drowning small loops in job overhead
+    unsigned int grain = count / (GetThreadCount() * 8);
+    return grain > 0 ? grain : 1;
+}
+
+void job_system::ParallelForJob(const job& self)
+{
+    const parallel_for_data& data = *(const parallel_for_data*)self.Data;
+
+    //Keep the lower half, hand the upper half to whoever is idle
+    unsigned int begin = self.Begin;
+    unsigned int end = self.End;
+    while (end - begin > data.GrainSize)
+    {
+        unsigned int middle = begin + (end - begin) / 2;
+
+        job upper = self;
+        upper.Begin = middle;
+        upper.End = end;
+        self.Counter->fetch_add(1, std::memory_order_relaxed);
+        data.System->Run(upper);
+
+        end = middle;
+    }
+
+    data.Invoke(data.Body, begin, end);
+}
+
+void job_system::Execute(job* queued)
+{
+    //Copy out first, then the pool slot can be reused while the job runs
+    job local = *queued;
+    if (local.PoolSlot)
+        local.PoolSlot->store(false, std::memory_order_release);
+    local.Function(local);
+    if (local.Counter)
+        local.Counter->fetch_sub(1, std::memory_order_acq_rel);
+}
+
+job* job_system::TakeReadyJob()
+{
+    std::lock_guard<std::mutex> lock(m_BlockedMutex);
+    for (size_t i = 0; i < m_Blocked.size(); i++)
+    {
+        job* blocked = m_Blocked[i];
+        if (blocked->Dependency->load(std::memory_order_acquire) > 0)
+            continue;
+
+        m_Blocked[i] = m_Blocked.back();
+        m_Blocked.pop_back();
+        m_BlockedCount.fetch_sub(1, std::memory_order_relaxed);
+        return blocked;
+    }
+    return nullptr;
+}
+
+job* job_system::FindJob(unsigned int index)
+{
+    //Blocked jobs that became ready have waited longest, they go first
+    if (m_BlockedCount.load(std::memory_order_acquire) > 0)
+    {
+        if (job* ready = TakeReadyJob())
+            return ready;
+    }
+
+    unsigned int count = (unsigned int)m_States.size();
+    while (true)
+    {
+        job* found = m_States[index]->Deque.Pop();
+
+        //Steal round-robin starting after ourselves so threads spread over victims
+        for (unsigned int i = 1; !found && i < count; i++)
+            found = m_States[(index + i) % count]->Deque.Steal();
+
+        if (!found || !found->Dependency || found->Dependency->load(std::memory_order_acquire) == 0)
+            return found;
+
+        //Not ready yet: set it aside, keeping its slot, and look for another
+        std::lock_guard<std::mutex> lock(m_BlockedMutex);
+        m_Blocked.push_back(found);
+        m_BlockedCount.fetch_add(1, std::memory_order_release);
+    }
+}
+
+void job_system::Wait(const std::atomic<unsigned int>& counter)
+{
+    unsigned int index = threadIndex;
+    while (counter.load(std::memory_order_acquire) > 0)
+    {
+        //The main thread also picks up its own jobs, which may be what it waits on
+        if (index == 0)
+            RunMainThreadJobs();
+
+        if (job* next = FindJob(index))
+            Execute(next);
+        else
+            std::this_thread::yield();
+    }
+}
+
+void job_system::WorkerLoop(unsigned int index)
+{
+    threadIndex = index;
+
+    unsigned int spins = 0;
+    while (m_Running.load(std::memory_order_relaxed))
+    {
+        if (job* next = FindJob(index))
+        {
+            Execute(next);
+            spins = 0;
+            continue;
+        }
+
+        if (++spins < idleSpins)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        //Timed so a wake-up that races with going to sleep costs at most a millisecond
+        std::unique_lock<std::mutex> lock(m_SleepMutex);
+        m_Sleeping++;
+        m_WakeUp.wait_for(lock, std::chrono::milliseconds(1));
+        m_Sleeping--;
+        spins = 0;
+    }
+}
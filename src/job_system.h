@@ -0,0 +1,172 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class job_system;
+
+struct job
+{
+	void (*Function)(const job& job) = nullptr;
+	const void* Data = nullptr;
+	unsigned int Begin = 0;
+	unsigned int End = 0;
+	std::atomic<unsigned int>* Counter = nullptr; //decremented once the job has run
+	const std::atomic<unsigned int>* Dependency = nullptr; //job waits until this reaches zero
+	std::atomic<bool>* PoolSlot = nullptr; //set by job_system while the job is queued in its pool
+};
+
+//Shared by the pieces of one ParallelFor, lives on the caller's stack
+struct parallel_for_data
+{
+	job_system* System;
+	const void* Body;
+	void (*Invoke)(const void* body, unsigned int begin, unsigned int end);
+	unsigned int GrainSize;
+};
+
+//Chase-Lev work-stealing deque of job pointers: the owning thread pushes and pops
+//at the bottom without locks, other threads steal from the top with one CAS
+class job_deque
+{
+private:
+	static const long long capacity = 4096;
+
+	std::atomic<long long> m_Top;
+	std::atomic<long long> m_Bottom;
+	std::atomic<job*> m_Jobs[capacity];
+
+public:
+	job_deque();
+
+	//Owner only. Returns false when full.
+	bool Push(job* job);
+	//Owner only
+	job* Pop();
+	//Any thread
+	job* Steal();
+};
+
+//A fixed set of worker threads, each with its own deque; idle threads steal from
+//the others. The thread that created the system (the main thread) takes part
+//too, as thread 0, whenever it waits on a counter. Only that thread and the
+//workers may queue jobs.
+//
+//Completion is tracked with counters: a job decrements its Counter when done,
+//Wait helps out until a counter reaches zero, and a job with a Dependency is not
+//started before that counter reaches zero. Jobs that must run on the main thread
+//(anything touching the GL context) go through RunOnMainThread.
+class job_system
+{
+private:
+	static const unsigned int jobPoolSize = 4096;
+
+	struct thread_state
+	{
+		job_deque Deque;
+		job JobPool[jobPoolSize];
+		std::atomic<bool> SlotUsed[jobPoolSize]; //cleared by whichever thread runs the slot's job
+		unsigned int NextJob = 0;
+
+		thread_state();
+	};
+
+	std::vector<std::unique_ptr<thread_state>> m_States;
+	std::vector<std::thread> m_Workers;
+	std::atomic<bool> m_Running;
+
+	std::mutex m_MainThreadMutex;
+	std::vector<job> m_MainThreadJobs;
+	//Main thread only. A job that waits re-enters RunMainThreadJobs, which carries
+	//on from m_MainThreadNext so the jobs after it are not left behind.
+	std::vector<job> m_MainThreadRunning;
+	size_t m_MainThreadNext;
+	std::atomic<bool> m_HasMainThreadJobs;
+
+	//Queued jobs found before their dependency was done. Any thread takes them from
+	//here once it is, so they neither hide the jobs queued below them nor get popped
+	//again on every spin.
+	std::mutex m_BlockedMutex;
+	std::vector<job*> m_Blocked;
+	std::atomic<unsigned int> m_BlockedCount;
+
+	std::mutex m_SleepMutex;
+	std::condition_variable m_WakeUp;
+	std::atomic<int> m_Sleeping;
+
+	void WorkerLoop(unsigned int threadIndex);
+	job* FindJob(unsigned int threadIndex);
+	job* TakeReadyJob();
+	//Copies job into a free slot of the calling thread's pool, nullptr if all are queued
+	job* AllocateJob(thread_state& state, const job& job);
+	void Execute(job* job);
+
+	static void ParallelForJob(const job& self);
+	unsigned int GetAdaptiveGrainSize(unsigned int count) const;
+
+public:
+	//0 workers = one per hardware thread besides the calling one
+	explicit job_system(unsigned int workerCount = 0);
+	~job_system();
+
+	job_system(const job_system&) = delete;
+	job_system& operator=(const job_system&) = delete;
+
+	//Queues a job on the calling thread's deque. Counter, if any, must have been
+	//incremented for it already.
+	void Run(const job& job);
+
+	//Queues job to start once dependency has reached zero
+	void RunAfter(const std::atomic<unsigned int>& dependency, const job& job);
+
+	//Queues a job that only the main thread runs, from RunMainThreadJobs or while
+	//it waits. Can be called from any thread.
+	void RunOnMainThread(const job& job);
+
+	//Main thread only: runs the main-thread jobs queued so far
+	void RunMainThreadJobs();
+
+	//Runs other jobs on this thread until counter drops to zero
+	void Wait(const std::atomic<unsigned int>& counter);
+
+	//Calls fn(index) for every index in [0, count) and returns once all of them ran.
+	//The range is halved recursively down to grainSize so idle threads can steal
+	//the upper halves; 0 picks a grain from the count and the number of threads.
+	template<typename Function>
+	void ParallelFor(unsigned int count, unsigned int grainSize, const Function& fn)
+	{
+		if (count == 0)
+			return;
+
+		parallel_for_data data;
+		data.System = this;
+		data.Body = &fn;
+		data.Invoke = [](const void* body, unsigned int begin, unsigned int end)
+		{
+			const Function& function = *(const Function*)body;
+			for (unsigned int i = begin; i < end; i++)
+				function(i);
+		};
+		data.GrainSize = grainSize ? grainSize : GetAdaptiveGrainSize(count);
+
+		std::atomic<unsigned int> counter(1);
+		job root;
+		root.Function = &job_system::ParallelForJob;
+		root.Data = &data;
+		root.Begin = 0;
+		root.End = count;
+		root.Counter = &counter;
+		Run(root);
+		Wait(counter);
+	}
+
+	//Workers plus the owning thread
+	inline unsigned int GetThreadCount() const { return (unsigned int)m_States.size(); }
+
+	//Index of the calling thread in [0, GetThreadCount()), 0 for the owning thread
+	static unsigned int GetThreadIndex();
+};
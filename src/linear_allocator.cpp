@@ -0,0 +1,23 @@
+#include "linear_allocator.h"
+
+#include <cstdint>
+
+
+linear_allocator::linear_allocator(size_t capacity)
+    : m_Memory(new unsigned char[capacity]), m_Capacity(capacity), m_Offset(0)
+{
+}
+
+void* linear_allocator::Allocate(size_t size, size_t alignment)
+{
+    //Align the address rather than the offset, the block itself is only malloc aligned
+    uintptr_t base = (uintptr_t)m_Memory.get();
+    uintptr_t aligned = (base + m_Offset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    size_t offset = aligned - base;
+
+    if (offset + size > m_Capacity)
+        return nullptr;
+
+    m_Offset = offset + size;
+    return m_Memory.get() + offset;
+}
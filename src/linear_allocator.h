@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+//Bump allocator over one fixed block: allocating is a pointer increment and
+//everything is freed at once by Reset. Not thread safe, give each thread its own.
+class linear_allocator
+{
+private:
+	std::unique_ptr<unsigned char[]> m_Memory;
+	size_t m_Capacity;
+	size_t m_Offset;
+
+public:
+	explicit linear_allocator(size_t capacity);
+
+	linear_allocator(const linear_allocator&) = delete;
+	linear_allocator& operator=(const linear_allocator&) = delete;
+
+	//nullptr once the block is used up
+	void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	template<typename T>
+	T* Allocate(size_t count)
+	{
+		return (T*)Allocate(count * sizeof(T), alignof(T));
+	}
+
+	inline void Reset() { m_Offset = 0; }
+
+	inline size_t GetUsed() const { return m_Offset; }
+	inline size_t GetCapacity() const { return m_Capacity; }
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+//Read-only memory mapping of a whole file, unmapped when it goes out of scope
+class mapped_file
+{
+private:
+	const char* m_Data;
+	size_t m_Size;
+	bool m_Open;
+#ifdef _WIN32
+	void* m_File;
+	void* m_Mapping;
+#else
+	int m_File;
+#endif
+
+public:
+	explicit mapped_file(const std::string& filepath);
+	~mapped_file();
+
+	mapped_file(const mapped_file&) = delete;
+	mapped_file& operator=(const mapped_file&) = delete;
+
+	inline bool IsOpen() const { return m_Open; }
+	inline const char* GetData() const { return m_Data; }
+	inline size_t GetSize() const { return m_Size; }
+	inline std::string_view GetView() const { return std::string_view(m_Data, m_Size); }
+};
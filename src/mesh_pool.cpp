@@ -0,0 +1,71 @@
+#include "mesh_pool.h"
+
+#include <iostream>
+#include <vector>
+
+#include "renderer.h"
+#include "vertex_buffer_layout.h"
+
+
+static std::vector<unsigned int> SequentialIDs(unsigned int count)
+{
+    std::vector<unsigned int> ids(count);
+    for (unsigned int i = 0; i < count; i++)
+        ids[i] = i;
+    return ids;
+}
+
+//Storage is allocated up front and filled with glBufferSubData as meshes are added
+mesh_pool::mesh_pool(const vertex_buffer_layout& layout, unsigned int vertexCapacity, unsigned int indexCapacity)
+    : m_Vertices(nullptr, vertexCapacity * layout.GetStride()), m_Indices(nullptr, indexCapacity),
+      m_Stride(layout.GetStride()), m_VertexCapacity(vertexCapacity), m_VertexCount(0), m_IndexCount(0),
+      m_DrawIDCount(0)
+{
+    m_VertexArray.AddBuffer(m_Vertices, layout);
+    m_Indices.bind();  //The element buffer binding is stored in the vertex array
+    m_VertexArray.unbind();
+}
+
+mesh_range mesh_pool::AddMesh(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+{
+    if (m_VertexCount + vertexCount > m_VertexCapacity || m_IndexCount + indexCount > m_Indices.GetCount())
+    {
+        std::cout << "[Mesh pool] Out of space for a mesh of " << vertexCount << " vertices" << std::endl;
+        return { 0, 0, 0 };
+    }
+
+    m_Vertices.bind();
+    GLCall(glBufferSubData(GL_ARRAY_BUFFER, m_VertexCount * m_Stride, vertexCount * m_Stride, vertices));
+
+    //Go through the vertex array so whatever element buffer is bound elsewhere stays untouched
+    m_VertexArray.bind();
+    GLCall(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, m_IndexCount * sizeof(unsigned int),
+                           indexCount * sizeof(unsigned int), indices));
+    m_VertexArray.unbind();
+
+    mesh_range range = { m_IndexCount, indexCount, (int)m_VertexCount };
+    m_VertexCount += vertexCount;
+    m_IndexCount += indexCount;
+    return range;
+}
+
+void mesh_pool::ReserveDrawIDs(unsigned int count)
+{
+    if (count <= m_DrawIDCount)
+        return;
+
+    if (!m_DrawIDs)
+    {
+        m_DrawIDs = std::make_unique<vertex_buffer>(SequentialIDs(count).data(), count * sizeof(unsigned int));
+        vertex_buffer_layout drawIDLayout;
+        drawIDLayout.Push<unsigned int>(1, 1);
+        m_VertexArray.AddBuffer(*m_DrawIDs, drawIDLayout);
+        m_VertexArray.unbind();
+    }
+    else
+    {
+        //Same buffer name, so the attribute already in the vertex array picks up the new storage
+        m_DrawIDs->Stream(SequentialIDs(count).data(), count * sizeof(unsigned int));
+    }
+    m_DrawIDCount = count;
+}
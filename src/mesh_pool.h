@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+
+#include "vertex_array.h"
+#include "vertex_buffer.h"
+#include "index_buffer.h"
+
+class vertex_buffer_layout;
+
+//Where a mesh lives inside a mesh_pool's shared buffers
+struct mesh_range
+{
+	unsigned int FirstIndex;
+	unsigned int IndexCount;
+	int BaseVertex;
+};
+
+//One vertex buffer, one index buffer and one vertex array shared by many meshes
+//with the same layout, so they can be drawn without rebinding anything in between
+//(and together in a single multi-draw, see indirect_batch)
+class mesh_pool
+{
+private:
+	vertex_array m_VertexArray;
+	vertex_buffer m_Vertices;
+	index_buffer m_Indices;
+	unsigned int m_Stride;
+	unsigned int m_VertexCapacity;
+	unsigned int m_VertexCount;
+	unsigned int m_IndexCount;
+	std::unique_ptr<vertex_buffer> m_DrawIDs; //created by the first ReserveDrawIDs
+	unsigned int m_DrawIDCount;
+
+public:
+	mesh_pool(const vertex_buffer_layout& layout, unsigned int vertexCapacity, unsigned int indexCapacity);
+
+	//Indices are relative to the mesh's own vertices. Returns an empty range if the pool is full.
+	mesh_range AddMesh(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+
+	//Per-instance attribute 0, 1, 2, ... for multi-draws that pick their data by
+	//BaseInstance. The attribute is added to the vertex array on the first call,
+	//later calls only grow the ids, so every indirect_batch on the pool shares it.
+	void ReserveDrawIDs(unsigned int count);
+
+	inline vertex_array& GetVertexArray() { return m_VertexArray; }
+	inline const vertex_array& GetVertexArray() const { return m_VertexArray; }
+};
@@ -0,0 +1,22 @@
+#include "parallel_recorder.h"
+
+
+parallel_recorder::parallel_recorder(job_system& jobs, frame_arena& arena)
+    : m_Jobs(jobs), m_Arena(arena), m_Lists(jobs.GetThreadCount())
+{
+}
+
+void parallel_recorder::Reserve(unsigned int draws, unsigned int uniforms)
+{
+    for (command_list& list : m_Lists)
+        list.Reserve(draws, uniforms);
+}
+
+void parallel_recorder::MergeInto(command_list& target)
+{
+    for (command_list& list : m_Lists)
+    {
+        target.Append(list);
+        list.Clear();
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+
+#include "command_list.h"
+#include "frame_arena.h"
+#include "job_system.h"
+
+//Records one frame's draws from many threads at once. Every thread of the job
+//system gets its own command_list and allocates scratch from its own block of
+//the frame arena, so recording takes no locks; MergeInto then concatenates the
+//lists and the renderer's sort on the GL thread puts them back in key order.
+//Draws with equal keys may come out in a different order from frame to frame,
+//give them distinct keys if that matters.
+class parallel_recorder
+{
+private:
+	job_system& m_Jobs;
+	frame_arena& m_Arena;
+	std::vector<command_list> m_Lists;
+
+public:
+	parallel_recorder(job_system& jobs, frame_arena& arena);
+
+	//Calls fn(index, list, scratch) for every object in [0, objectCount) across the
+	//job system, where list and scratch belong to the thread running that call
+	template<typename Function>
+	void Record(unsigned int objectCount, unsigned int grainSize, const Function& fn)
+	{
+		m_Jobs.ParallelFor(objectCount, grainSize, [this, &fn](unsigned int index)
+		{
+			unsigned int thread = job_system::GetThreadIndex();
+			fn(index, m_Lists[thread], m_Arena.Get(thread));
+		});
+	}
+
+	//Work stealing decides how many objects each thread records, so a list can still
+	//grow many frames in. Reserving every thread's list for a whole frame's draws
+	//keeps steady-state frames off the heap.
+	void Reserve(unsigned int draws, unsigned int uniforms);
+
+	//Appends everything recorded so far to target and empties the per-thread lists.
+	//Scratch memory stays valid until the frame arena is reset.
+	void MergeInto(command_list& target);
+};
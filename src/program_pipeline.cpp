@@ -0,0 +1,166 @@
+#include "program_pipeline.h"
+
+#include "renderer.h"
+#include "shader_preprocessor.h"
+#include "shader_program.h"
+
+
+static const unsigned int stageBits[(int)shader_stage::COUNT] = {
+    GL_VERTEX_SHADER_BIT, GL_FRAGMENT_SHADER_BIT, GL_GEOMETRY_SHADER_BIT,
+    GL_TESS_CONTROL_SHADER_BIT, GL_TESS_EVALUATION_SHADER_BIT, GL_COMPUTE_SHADER_BIT
+};
+
+program_pipeline_cache::program_pipeline_cache(bool separable)
+    : m_LinkCount(0), m_Separable(separable && GLEW_ARB_separate_shader_objects != 0)
+{
+}
+
+program_pipeline_cache::~program_pipeline_cache()
+{
+    for (auto& entry : m_Pipelines)
+    {
+        if (entry.second.Pipeline)
+        {
+            GLCall(glDeleteProgramPipelines(1, &entry.second.Pipeline));
+        }
+        if (entry.second.Program)
+        {
+            GLCall(glDeleteProgram(entry.second.Program));
+        }
+    }
+
+    for (auto& entry : m_StagePrograms)
+    {
+        GLCall(glDeleteProgram(entry.second));
+    }
+}
+
+unsigned int program_pipeline_cache::GetStageProgram(shader_stage stage, const std::string& source)
+{
+    uint64_t key = HashShaderText(source.data(), source.size(), (uint64_t)stage + 1);
+
+    auto cached = m_StagePrograms.find(key);
+    if (cached != m_StagePrograms.end())
+        return cached->second;
+
+    //Compiles and links a single stage with GL_PROGRAM_SEPARABLE set
+    const char* src = source.c_str();
+    unsigned int program = glCreateShaderProgramv(GetStageGLType(stage), 1, &src);
+    m_LinkCount++;
+
+    //Failures aren't cached, a fixed source hashes differently anyway and the same one just fails again
+    if (!checkProgramLink(program, GetStageName(stage)))
+    {
+        GLCall(glDeleteProgram(program));
+        return 0;
+    }
+
+    m_StagePrograms.emplace(key, program);
+    return program;
+}
+
+const program_pipeline& program_pipeline_cache::Get(const ShaderProgramSource& source)
+{
+    uint64_t key = 0;
+    for (int i = 0; i < (int)shader_stage::COUNT; i++)
+    {
+        const std::string& stageSource = source.Get((shader_stage)i);
+        key = HashShaderText(stageSource.data(), stageSource.size(), key ^ (uint64_t)(i + 1));
+    }
+
+    auto cached = m_Pipelines.find(key);
+    if (cached != m_Pipelines.end())
+        return cached->second;
+
+    program_pipeline pipeline;
+    if (m_Separable)
+    {
+        GLCall(glGenProgramPipelines(1, &pipeline.Pipeline));
+        for (int i = 0; i < (int)shader_stage::COUNT; i++)
+        {
+            const std::string& stageSource = source.Get((shader_stage)i);
+            if (stageSource.empty())
+                continue;
+
+            //No relinking here, the pipeline just references already linked stages
+            pipeline.Stages[i] = GetStageProgram((shader_stage)i, stageSource);
+            if (!pipeline.Stages[i])
+            {
+                GLCall(glDeleteProgramPipelines(1, &pipeline.Pipeline));
+                return m_Empty;
+            }
+            GLCall(glUseProgramStages(pipeline.Pipeline, stageBits[i], pipeline.Stages[i]));
+        }
+    }
+    else
+    {
+        pipeline.Program = createShader(source);
+        m_LinkCount++;
+
+        int stageCount = 0;
+        for (int i = 0; i < (int)shader_stage::COUNT; i++)
+        {
+            if (!source.Get((shader_stage)i).empty())
+            {
+                pipeline.Stages[i] = pipeline.Program;
+                stageCount++;
+            }
+        }
+
+        //createShader leaves out stages that don't compile, the rest may still link
+        int attached;
+        GLCall(glGetProgramiv(pipeline.Program, GL_ATTACHED_SHADERS, &attached));
+        if (attached != stageCount || !checkProgramLink(pipeline.Program, "program"))
+        {
+            GLCall(glDeleteProgram(pipeline.Program));
+            return m_Empty;
+        }
+    }
+
+    return m_Pipelines.emplace(key, pipeline).first->second;
+}
+
+void program_pipeline_cache::Bind(const program_pipeline& pipeline) const
+{
+    if (pipeline.Pipeline)
+    {
+        //A bound program takes precedence over the pipeline
+        GLCall(glUseProgram(0));
+        GLCall(glBindProgramPipeline(pipeline.Pipeline));
+    }
+    else
+    {
+        GLCall(glUseProgram(pipeline.Program));
+    }
+}
+
+void program_pipeline_cache::Unbind() const
+{
+    GLCall(glUseProgram(0));
+    if (m_Separable)
+    {
+        GLCall(glBindProgramPipeline(0));
+    }
+}
+
+int program_pipeline_cache::GetUniformLocation(const program_pipeline& pipeline, shader_stage stage, const char* name) const
+{
+    unsigned int program = pipeline.Stages[(int)stage];
+    return program ? glGetUniformLocation(program, name) : -1;
+}
+
+void program_pipeline_cache::SetUniform4f(const program_pipeline& pipeline, shader_stage stage, int location,
+                                          float v0, float v1, float v2, float v3) const
+{
+    unsigned int program = pipeline.Stages[(int)stage];
+    if (pipeline.Pipeline)
+    {
+        //Separable programs are updated directly, no need to make them current
+        GLCall(glProgramUniform4f(program, location, v0, v1, v2, v3));
+    }
+    else
+    {
+        GLCall(glUseProgram(program));
+        GLCall(glUniform4f(location, v0, v1, v2, v3));
+    }
+}
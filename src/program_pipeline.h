@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "shader_source.h"
+
+//A bindable combination of stages. With ARB_separate_shader_objects, Pipeline is
+//a program pipeline object and Stages hold the separable per-stage programs (the
+//owner of each stage's uniforms). Without it, Program is a regular linked program
+//and every present stage refers to it.
+struct program_pipeline
+{
+	unsigned int Pipeline = 0;
+	unsigned int Program = 0;
+	unsigned int Stages[(int)shader_stage::COUNT] = {};
+};
+
+//Compiles each distinct stage source once into a separable program and combines
+//them into pipelines at bind time, so materials sharing a vertex stage don't each
+//relink it. Stage programs and pipelines are cached by a hash of their sources.
+//Without separable programs, or when asked not to use them (renderer binds one
+//program per draw), whole programs are linked and cached the same way.
+//
+//A pipeline with a stage that fails to compile or link comes back empty and
+//nothing of it but the working stages is cached, so Get tries again once the
+//source changes. Separable vertex stages may need to redeclare
+//'out gl_PerVertex { vec4 gl_Position; };' on strict drivers.
+class program_pipeline_cache
+{
+private:
+	std::unordered_map<uint64_t, unsigned int> m_StagePrograms;
+	std::unordered_map<uint64_t, program_pipeline> m_Pipelines;
+	program_pipeline m_Empty;
+	unsigned int m_LinkCount;
+	bool m_Separable;
+
+	unsigned int GetStageProgram(shader_stage stage, const std::string& source);
+
+public:
+	explicit program_pipeline_cache(bool separable = true);
+	~program_pipeline_cache();
+
+	program_pipeline_cache(const program_pipeline_cache&) = delete;
+	program_pipeline_cache& operator=(const program_pipeline_cache&) = delete;
+
+	//Pipeline and Program are both 0 if a stage failed
+	const program_pipeline& Get(const ShaderProgramSource& source);
+
+	void Bind(const program_pipeline& pipeline) const;
+	void Unbind() const;
+
+	int GetUniformLocation(const program_pipeline& pipeline, shader_stage stage, const char* name) const;
+	void SetUniform4f(const program_pipeline& pipeline, shader_stage stage, int location,
+	                  float v0, float v1, float v2, float v3) const;
+
+	inline bool IsSeparable() const { return m_Separable; }
+	inline unsigned int GetLinkCount() const { return m_LinkCount; }
+};
@@ -0,0 +1,143 @@
+#include "quad_batch.h"
+
+#include "renderer.h"
+#include "vertex_buffer_layout.h"
+
+
+static std::vector<unsigned int> QuadIndices(unsigned int maxQuads)
+{
+    //Same 0, 1, 2, 2, 3, 0 pattern as the square in main(), repeated for every quad
+    std::vector<unsigned int> indices(maxQuads * 6);
+    for (unsigned int quad = 0, vertex = 0; quad < maxQuads; quad++, vertex += 4)
+    {
+        unsigned int* index = &indices[quad * 6];
+        index[0] = vertex + 0;
+        index[1] = vertex + 1;
+        index[2] = vertex + 2;
+        index[3] = vertex + 2;
+        index[4] = vertex + 3;
+        index[5] = vertex + 0;
+    }
+    return indices;
+}
+
+quad_batch::quad_batch(unsigned int maxQuads)
+    : m_Vertices(maxQuads * 4 * sizeof(quad_vertex)),
+      m_Indices(QuadIndices(maxQuads).data(), maxQuads * 6),
+      m_Staging(maxQuads * 4),
+      m_Program(0), m_UntexturedProgram(0), m_TexturesLocation(-1), m_TextureCount(0),
+      m_QuadCount(0), m_DrawCount(0)
+{
+    m_Next = m_Staging.data();
+    m_End = m_Staging.data() + m_Staging.size();
+
+    vertex_buffer_layout layout;
+    layout.Push<float>(2); //position
+    layout.Push<float>(2); //texture coordinate
+    layout.Push<float>(4); //color
+    layout.Push<float>(1); //texture slot
+    m_VertexArray.AddBuffer(m_Vertices, layout);
+    m_Indices.bind();  //The element buffer binding is stored in the vertex array
+    m_VertexArray.unbind();
+}
+
+void quad_batch::Begin(unsigned int program, unsigned int untexturedProgram)
+{
+    if (program == m_Program && untexturedProgram == m_UntexturedProgram)
+        return;
+
+    Flush();
+    m_Program = program;
+    m_UntexturedProgram = untexturedProgram;
+
+    //Sampler i reads texture unit i
+    int units[maxTextureSlots];
+    for (unsigned int i = 0; i < maxTextureSlots; i++)
+        units[i] = (int)i;
+
+    GLCall(glUseProgram(m_Program));
+    m_TexturesLocation = glGetUniformLocation(m_Program, "u_Textures");
+    if (m_TexturesLocation != -1)
+    {
+        GLCall(glUniform1iv(m_TexturesLocation, maxTextureSlots, units));
+    }
+}
+
+float quad_batch::AcquireTextureSlot(unsigned int texture)
+{
+    for (unsigned int i = 0; i < m_TextureCount; i++)
+    {
+        if (m_Textures[i] == texture)
+            return (float)i;
+    }
+
+    if (m_TextureCount == maxTextureSlots)
+        Flush();
+
+    m_Textures[m_TextureCount] = texture;
+    return (float)m_TextureCount++;
+}
+
+void quad_batch::DrawQuad(float x, float y, float width, float height, const float color[4])
+{
+    if (m_Next == m_End)
+        Flush();
+
+    const float corners[4][2] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+    for (int i = 0; i < 4; i++)
+    {
+        quad_vertex& vertex = m_Next[i];
+        vertex.Position[0] = x + corners[i][0] * width;
+        vertex.Position[1] = y + corners[i][1] * height;
+        vertex.TexCoord[0] = corners[i][0];
+        vertex.TexCoord[1] = corners[i][1];
+        vertex.Color[0] = color[0];
+        vertex.Color[1] = color[1];
+        vertex.Color[2] = color[2];
+        vertex.Color[3] = color[3];
+        vertex.TexIndex = -1.0f;
+    }
+    m_Next += 4;
+}
+
+void quad_batch::DrawQuad(float x, float y, float width, float height, unsigned int texture, const float tint[4])
+{
+    //Acquiring the slot may flush, so do it before the quad is written
+    if (m_Next == m_End)
+        Flush();
+    float slot = AcquireTextureSlot(texture);
+
+    DrawQuad(x, y, width, height, tint);
+    for (int i = 1; i <= 4; i++)
+        (m_Next - i)->TexIndex = slot;
+}
+
+void quad_batch::Flush()
+{
+    unsigned int vertexCount = (unsigned int)(m_Next - m_Staging.data());
+    if (vertexCount == 0)
+    {
+        m_TextureCount = 0;
+        return;
+    }
+
+    //Quads need a program, Begin sets it
+    ASSERT(m_Program != 0);
+    m_Vertices.Stream(m_Staging.data(), vertexCount * sizeof(quad_vertex));
+
+    for (unsigned int i = 0; i < m_TextureCount; i++)
+    {
+        GLCall(glActiveTexture(GL_TEXTURE0 + i));
+        GLCall(glBindTexture(GL_TEXTURE_2D, m_Textures[i]));
+    }
+
+    GLCall(glUseProgram(m_TextureCount == 0 && m_UntexturedProgram ? m_UntexturedProgram : m_Program));
+    m_VertexArray.bind();
+    GLCall(glDrawElements(GL_TRIANGLES, vertexCount / 4 * 6, GL_UNSIGNED_INT, nullptr));
+
+    m_QuadCount += vertexCount / 4;
+    m_DrawCount++;
+
+    m_Next = m_Staging.data();
+    m_TextureCount = 0;
+}
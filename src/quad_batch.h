@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+
+#include "vertex_array.h"
+#include "vertex_buffer.h"
+#include "index_buffer.h"
+
+struct quad_vertex
+{
+	float Position[2];
+	float TexCoord[2];
+	float Color[4];
+	float TexIndex; //-1 = untextured
+};
+
+//Accumulates quads into one streaming vertex buffer and draws each batch with a
+//single glDrawElements over a shared index buffer built once up front. A batch
+//is flushed when it is full, when a quad needs a texture that doesn't fit in the
+//remaining slots, when the program changes, or on End. A batch that binds no
+//textures is drawn with the untextured program when there is one, e.g. the
+//TEXTURED 0 variant of batch.shader, so its fragments skip the sampler switch.
+class quad_batch
+{
+public:
+	static const unsigned int maxTextureSlots = 16;
+
+private:
+	vertex_array m_VertexArray;
+	vertex_buffer m_Vertices;
+	index_buffer m_Indices;
+	std::vector<quad_vertex> m_Staging;
+	quad_vertex* m_Next;
+	quad_vertex* m_End;
+
+	unsigned int m_Program;
+	unsigned int m_UntexturedProgram;
+	int m_TexturesLocation;
+	unsigned int m_Textures[maxTextureSlots];
+	unsigned int m_TextureCount;
+
+	unsigned int m_QuadCount;
+	unsigned int m_DrawCount;
+
+	float AcquireTextureSlot(unsigned int texture);
+
+public:
+	explicit quad_batch(unsigned int maxQuads = 65536);
+
+	//Starts collecting quads for program, flushing pending ones first if it differs.
+	//Needed before the first quad. untexturedProgram, if not 0, draws the batches
+	//without textures.
+	void Begin(unsigned int program, unsigned int untexturedProgram = 0);
+
+	void DrawQuad(float x, float y, float width, float height, const float color[4]);
+	void DrawQuad(float x, float y, float width, float height, unsigned int texture, const float tint[4]);
+
+	void Flush();
+
+	inline void End() { Flush(); }
+
+	//Counters since the last ResetStats, e.g. once per frame
+	inline unsigned int GetQuadCount() const { return m_QuadCount; }
+	inline unsigned int GetDrawCount() const { return m_DrawCount; }
+	inline void ResetStats() { m_QuadCount = 0; m_DrawCount = 0; }
+};
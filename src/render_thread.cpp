@@ -0,0 +1,105 @@
+#include "render_thread.h"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <chrono>
+
+#include "renderer.h"
+#include "damage_tracker.h"
+
+
+//Spin briefly for the common short waits, then back off to sleeping
+static void WaitBriefly(unsigned int& spins)
+{
+    if (++spins < 64)
+        std::this_thread::yield();
+    else
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+}
+
+render_thread::render_thread(GLFWwindow* window, renderer& renderer, unsigned int framesOfLatency, int swapInterval)
+    : m_Window(window), m_Renderer(renderer), m_Frames(framesOfLatency + 1), m_SwapInterval(swapInterval),
+      m_Published(0), m_Retired(0), m_Running(false)
+{
+}
+
+render_thread::~render_thread()
+{
+    Stop();
+}
+
+void render_thread::Start()
+{
+    if (m_Running)
+        return;
+
+    glfwMakeContextCurrent(nullptr);
+    m_Running = true;
+    m_Thread = std::thread(&render_thread::ThreadLoop, this);
+}
+
+void render_thread::Stop()
+{
+    if (!m_Running)
+        return;
+
+    m_Running = false;
+    m_Thread.join();
+    glfwMakeContextCurrent(m_Window);
+}
+
+command_list& render_thread::BeginFrame()
+{
+    //Wait for a free slot, i.e. the render thread is less than the ring size behind
+    unsigned long long frame = m_Published.load(std::memory_order_relaxed);
+    unsigned int spins = 0;
+    while (frame - m_Retired.load(std::memory_order_acquire) >= m_Frames.size())
+        WaitBriefly(spins);
+
+    command_list& list = m_Frames[frame % m_Frames.size()];
+    list.Clear();
+    return list;
+}
+
+void render_thread::EndFrame()
+{
+    m_Published.fetch_add(1, std::memory_order_release);
+}
+
+void render_thread::ThreadLoop()
+{
+    glfwMakeContextCurrent(m_Window);
+    glfwSwapInterval(m_SwapInterval);
+
+    unsigned int spins = 0;
+    while (true)
+    {
+        unsigned long long frame = m_Retired.load(std::memory_order_relaxed);
+        if (frame == m_Published.load(std::memory_order_acquire))
+        {
+            //Only leave once everything published before Stop has been shown
+            if (!m_Running && frame == m_Published.load(std::memory_order_acquire))
+                break;
+            WaitBriefly(spins);
+            continue;
+        }
+        spins = 0;
+
+        const command_list& list = m_Frames[frame % m_Frames.size()];
+        //Only partial redraws care what the back buffer still holds
+        m_Renderer.ApplyScissor(list, list.HasScissor() ? QueryBufferAge(m_Window) : 0);
+        m_Renderer.Clear();
+        m_Renderer.Execute(list);
+
+        // Swap front and back buffers 
+        glfwSwapBuffers(m_Window);
+#ifdef GL_TRACE
+        MarkGLTraceFrame();
+#endif
+
+        m_Retired.store(frame + 1, std::memory_order_release);
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "command_list.h"
+
+struct GLFWwindow;
+class renderer;
+
+//Owns the GL context on a dedicated thread that replays command lists recorded
+//by the main thread. Lists sit in a single-producer / single-consumer ring of
+//framesOfLatency + 1 slots handed over with atomics only: the main thread
+//records frame N while the render thread replays frame N - 1 (or further back
+//with more latency), and BeginFrame only waits when the ring is full.
+//
+//Create GL objects before Start and delete them after Stop, the context is not
+//current on the main thread in between.
+class render_thread
+{
+private:
+	GLFWwindow* m_Window;
+	renderer& m_Renderer;
+	std::vector<command_list> m_Frames;
+	int m_SwapInterval;
+
+	//Frames published by the main thread and frames finished by the render thread,
+	//both only ever increase. Slot of frame n is n % m_Frames.size().
+	std::atomic<unsigned long long> m_Published;
+	std::atomic<unsigned long long> m_Retired;
+	std::atomic<bool> m_Running;
+	std::thread m_Thread;
+
+	void ThreadLoop();
+
+public:
+	render_thread(GLFWwindow* window, renderer& renderer, unsigned int framesOfLatency = 1, int swapInterval = 1);
+	~render_thread();
+
+	render_thread(const render_thread&) = delete;
+	render_thread& operator=(const render_thread&) = delete;
+
+	//Releases the context from the calling thread and starts replaying
+	void Start();
+
+	//Replays what is still queued, then hands the context back to the calling thread
+	void Stop();
+
+	//The list to record the next frame into, cleared and ready
+	command_list& BeginFrame();
+
+	//Hands the list from BeginFrame over to the render thread
+	void EndFrame();
+};
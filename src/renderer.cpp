@@ -1,6 +1,9 @@
 #include "renderer.h"
+#include <algorithm>
 #include <iostream>
 
+#include "index_buffer.h"
+
 
 #define ASSERT(x) if (!(x)) __debugbreak();
 #define GLCall(x) GLClearError();\
@@ -21,4 +24,183 @@ bool GLCallLog(const char* function, const char* file, int line)
         return false;
     }
     return true;
-}
\ No newline at end of file
+}
+
+renderer::renderer()
+    : m_DrawCount(0), m_StateChanges(0), m_PresentedFrames(0)
+{
+}
+
+uint64_t renderer::MakeSortKey(unsigned int layer, unsigned int program, unsigned int material, float depth)
+{
+    if (depth < 0.0f)
+        depth = 0.0f;
+    else if (depth > 1.0f)
+        depth = 1.0f;
+
+    uint64_t quantizedDepth = (uint64_t)(depth * 0xFFFFFF);
+
+    return ((uint64_t)(layer & 0xFF) << 56) |
+           ((uint64_t)(program & 0xFFFF) << 40) |
+           ((uint64_t)(material & 0xFFFF) << 24) |
+           quantizedDepth;
+}
+
+void renderer::Clear() const
+{
+    GLCall(glClear(GL_COLOR_BUFFER_BIT));
+}
+
+void renderer::ApplyScissor(const command_list& list, int bufferAge)
+{
+    //The back buffer misses whatever the bufferAge - 1 frames presented since it was drawn redrew
+    unsigned int missed = bufferAge > 0 ? (unsigned int)bufferAge - 1 : 0;
+    bool partial = list.HasScissor() && bufferAge > 0 && missed <= damageHistory && missed <= m_PresentedFrames;
+    scissor_rect rect = list.GetScissor();
+    for (unsigned int i = 1; partial && i <= missed; i++)
+    {
+        const frame_damage& damage = m_Damage[(m_PresentedFrames - i) % damageHistory];
+        partial = !damage.Whole;
+        int x0 = std::min(rect.X, damage.Rect.X);
+        int y0 = std::min(rect.Y, damage.Rect.Y);
+        int x1 = std::max(rect.X + rect.Width, damage.Rect.X + damage.Rect.Width);
+        int y1 = std::max(rect.Y + rect.Height, damage.Rect.Y + damage.Rect.Height);
+        rect = { x0, y0, x1 - x0, y1 - y0 };
+    }
+
+    m_Damage[m_PresentedFrames % damageHistory] = { list.GetScissor(), !partial };
+    m_PresentedFrames++;
+
+    if (partial)
+    {
+        GLCall(glEnable(GL_SCISSOR_TEST));
+        GLCall(glScissor(rect.X, rect.Y, rect.Width, rect.Height));
+    }
+    else
+    {
+        GLCall(glDisable(GL_SCISSOR_TEST));
+    }
+}
+
+void renderer::SortCommands(const std::vector<draw_command>& commands)
+{
+    //LSD radix sort on 8 bit digits over (key, index) pairs, stable so equal keys
+    //keep their submission order
+    size_t count = commands.size();
+    for (int i = 0; i < 2; i++)
+    {
+        m_Keys[i].resize(count);
+        m_Order[i].resize(count);
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        m_Keys[0][i] = commands[i].SortKey;
+        m_Order[0][i] = (unsigned int)i;
+    }
+
+    int src = 0;
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        size_t histogram[256] = {};
+        for (size_t i = 0; i < count; i++)
+            histogram[(m_Keys[src][i] >> shift) & 0xFF]++;
+
+        //Every key has the same digit here, nothing to reorder
+        if (histogram[(m_Keys[src][0] >> shift) & 0xFF] == count)
+            continue;
+
+        size_t offset = 0;
+        for (size_t& bucket : histogram)
+        {
+            size_t size = bucket;
+            bucket = offset;
+            offset += size;
+        }
+
+        int dst = src ^ 1;
+        for (size_t i = 0; i < count; i++)
+        {
+            size_t slot = histogram[(m_Keys[src][i] >> shift) & 0xFF]++;
+            m_Keys[dst][slot] = m_Keys[src][i];
+            m_Order[dst][slot] = m_Order[src][i];
+        }
+        src = dst;
+    }
+
+    if (src != 0)
+    {
+        m_Keys[0].swap(m_Keys[1]);
+        m_Order[0].swap(m_Order[1]);
+    }
+}
+
+void renderer::Flush()
+{
+    Execute(m_Queue);
+    m_Queue.Clear();
+}
+
+void renderer::Execute(const command_list& list)
+{
+    m_DrawCount = 0;
+    m_StateChanges = 0;
+
+    if (list.IsEmpty())
+        return;
+
+    const std::vector<draw_command>& commands = list.GetCommands();
+    const std::vector<draw_uniform>& uniforms = list.GetUniforms();
+    SortCommands(commands);
+
+    //Nothing is assumed bound at the start of a flush, programs may have been
+    //deleted and their names reused since the last one
+    unsigned int boundProgram = 0;
+    unsigned int boundVertexArray = 0;
+    const index_buffer* boundIndexBuffer = nullptr;
+
+    for (unsigned int index : m_Order[0])
+    {
+        const draw_command& command = commands[index];
+
+        if (command.Program != boundProgram)
+        {
+            GLCall(glUseProgram(command.Program)); //bind shader
+            boundProgram = command.Program;
+            m_StateChanges++;
+        }
+
+        if (command.VertexArray != boundVertexArray)
+        {
+            GLCall(glBindVertexArray(command.VertexArray));
+            boundVertexArray = command.VertexArray;
+            //The element buffer binding is part of the vertex array state
+            boundIndexBuffer = nullptr;
+            m_StateChanges++;
+        }
+
+        if (command.IndexBuffer != boundIndexBuffer)
+        {
+            command.IndexBuffer->bind();
+            boundIndexBuffer = command.IndexBuffer;
+            m_StateChanges++;
+        }
+
+        for (unsigned int i = 0; i < command.UniformCount; i++)
+        {
+            const draw_uniform& uniform = uniforms[command.UniformOffset + i];
+            GLCall(glUniform4f(uniform.Location, uniform.Value[0], uniform.Value[1], uniform.Value[2], uniform.Value[3]));
+        }
+
+        if (command.InstanceCount)
+        {
+            GLCall(glDrawElementsInstanced(GL_TRIANGLES, command.IndexBuffer->GetCount(), GL_UNSIGNED_INT,
+                                           nullptr, command.InstanceCount));
+        }
+        else
+        {
+            GLCall(glDrawElements(GL_TRIANGLES, command.IndexBuffer->GetCount(), GL_UNSIGNED_INT, nullptr));
+        }
+        m_DrawCount++;
+    }
+}
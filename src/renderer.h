@@ -1,6 +1,14 @@
 #pragma once
 
 #include <GL/glew.h>
+#ifdef GL_TRACE
+#include "gl_trace.h"
+#endif
+
+#include <cstdint>
+#include <vector>
+
+#include "command_list.h"
 
 #define ASSERT(x) if (!(x)) __debugbreak();
 #define GLCall(x) GLClearError();\
@@ -10,4 +18,69 @@
 
 void GLClearError();
 
-bool GLCallLog(const char* function, const char* file, int line);
\ No newline at end of file
+bool GLCallLog(const char* function, const char* file, int line);
+
+//Executing a command_list radix-sorts its draws by their 64-bit key and issues
+//them, only rebinding program / vertex array / index buffer when the next draw
+//actually uses a different one. Submit/Flush do the same through a list owned by
+//the renderer.
+class renderer
+{
+private:
+	command_list m_Queue;
+
+	//Scratch space for the sort, kept around so steady-state frames don't allocate
+	std::vector<uint64_t> m_Keys[2];
+	std::vector<unsigned int> m_Order[2];
+
+	unsigned int m_DrawCount;
+	unsigned int m_StateChanges;
+
+	//What each of the last presented frames redrew, frame n at n % damageHistory
+	struct frame_damage
+	{
+		scissor_rect Rect;
+		bool Whole;
+	};
+	static const unsigned int damageHistory = 4;
+	frame_damage m_Damage[damageHistory];
+	unsigned long long m_PresentedFrames;
+
+	void SortCommands(const std::vector<draw_command>& commands);
+
+public:
+	renderer();
+
+	//Key layout, most significant first: layer 8 bits | program 16 | material 16 | depth 24.
+	//Depth is expected in [0, 1] and sorts front to back.
+	static uint64_t MakeSortKey(unsigned int layer, unsigned int program, unsigned int material, float depth);
+
+	void Clear() const;
+
+	//Enables scissoring for the following Clear and Execute if the list has a rect, or
+	//disables it. Call once per presented frame. bufferAge is how many frames old the
+	//back buffer is (EXT_buffer_age), 0 if unknown: the rect grows by what the frames
+	//since then redrew, and an unknown age or one beyond the history means a full redraw.
+	void ApplyScissor(const command_list& list, int bufferAge = 0);
+
+	inline void Submit(uint64_t sortKey, unsigned int program, unsigned int vertexArray, const index_buffer& ib,
+	                   const draw_uniform* uniforms = nullptr, unsigned int uniformCount = 0)
+	{
+		m_Queue.Submit(sortKey, program, vertexArray, ib, uniforms, uniformCount);
+	}
+
+	inline void SubmitInstanced(uint64_t sortKey, unsigned int program, unsigned int vertexArray, const index_buffer& ib,
+	                            unsigned int instanceCount, const draw_uniform* uniforms = nullptr, unsigned int uniformCount = 0)
+	{
+		m_Queue.SubmitInstanced(sortKey, program, vertexArray, ib, instanceCount, uniforms, uniformCount);
+	}
+
+	//Sorts and issues a recorded list. Must be called on the thread owning the GL context.
+	void Execute(const command_list& list);
+
+	//Sorts and issues everything submitted since the last Flush, then empties the queue
+	void Flush();
+
+	inline unsigned int GetDrawCount() const { return m_DrawCount; }
+	inline unsigned int GetStateChanges() const { return m_StateChanges; }
+};
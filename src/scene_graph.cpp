@@ -0,0 +1,299 @@
+#include "scene_graph.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+
+#include "renderer.h"
+#include "command_list.h"
+#include "job_system.h"
+
+
+//Nodes per job when a level is split across the job system
+static const unsigned int updateChunkSize = 4096;
+//Nodes whose matrices and boxes are computed together, the boxes are then scattered into the component arrays
+static const unsigned int boundsBatchSize = 64;
+
+scene_uniforms GetSceneUniforms(unsigned int program)
+{
+    scene_uniforms uniforms;
+    for (int c = 0; c < 4; c++)
+    {
+        std::string name = "u_Transform[" + std::to_string(c) + "]";
+        GLCall(uniforms.Transform[c] = glGetUniformLocation(program, name.c_str()));
+    }
+    GLCall(uniforms.Color = glGetUniformLocation(program, "u_Color"));
+    return uniforms;
+}
+
+scene_graph::scene_graph(job_system* jobs)
+    : m_LevelStart(1, 0), m_Jobs(jobs), m_Sorted(true)
+{
+}
+
+void scene_graph::Reserve(unsigned int count)
+{
+    m_Local.reserve(count);
+    m_World.reserve(count);
+    m_Parent.reserve(count);
+    m_Depth.reserve(count);
+    m_Flags.reserve(count);
+    m_LocalBounds.reserve(count);
+    for (std::vector<float>& component : m_WorldBounds)
+        component.reserve(count);
+    m_Mesh.reserve(count);
+    m_Color.reserve(count);
+    m_Nodes.reserve(count);
+    m_Index.reserve(count);
+}
+
+unsigned int scene_graph::AddMesh(const scene_mesh& mesh)
+{
+    m_Meshes.push_back(mesh);
+    return (unsigned int)m_Meshes.size() - 1;
+}
+
+scene_node scene_graph::Add(scene_node parent, const mat4& local, const aabb& bounds, unsigned int mesh, const vec4& color)
+{
+    unsigned int parentIndex = parent == invalidSceneNode ? noParent : m_Index[parent];
+    unsigned int depth = parentIndex == noParent ? 0 : m_Depth[parentIndex] + 1;
+    unsigned int index = (unsigned int)m_Nodes.size();
+    scene_node node = (scene_node)m_Index.size();
+
+    m_Local.push_back(local);
+    m_World.push_back(local);
+    m_Parent.push_back(parentIndex);
+    m_Depth.push_back(depth);
+    m_Flags.push_back(0);
+    m_LocalBounds.push_back(bounds);
+    for (std::vector<float>& component : m_WorldBounds)
+        component.push_back(0.0f);
+    m_Mesh.push_back(mesh);
+    m_Color.push_back(color);
+    m_Nodes.push_back(node);
+    m_Index.push_back(index);
+
+    //Appending keeps the depth order as long as the node is at the deepest level
+    //or one below it; anything else waits for a sort in Update
+    unsigned int levels = (unsigned int)m_LevelStart.size() - 1;
+    if (m_Sorted)
+    {
+        if (levels > 0 && depth == levels - 1)
+            m_LevelStart.back() = index + 1;
+        else if (depth == levels)
+            m_LevelStart.push_back(index + 1);
+        else
+            m_Sorted = false;
+    }
+    if (depth >= m_LevelDirty.size())
+        m_LevelDirty.resize(depth + 1, 0);
+
+    MarkDirty(index);
+    return node;
+}
+
+void scene_graph::MarkDirty(unsigned int index)
+{
+    if (!(m_Flags[index] & dirtyFlag))
+    {
+        m_Flags[index] |= dirtyFlag;
+        m_LevelDirty[m_Depth[index]]++;
+    }
+}
+
+void scene_graph::SetLocal(scene_node node, const mat4& local)
+{
+    unsigned int index = m_Index[node];
+    m_Local[index] = local;
+    MarkDirty(index);
+}
+
+void scene_graph::SetBounds(scene_node node, const aabb& bounds)
+{
+    unsigned int index = m_Index[node];
+    m_LocalBounds[index] = bounds;
+    MarkDirty(index);
+}
+
+void scene_graph::SetColor(scene_node node, const vec4& color)
+{
+    m_Color[m_Index[node]] = color;
+}
+
+template<typename T>
+static void Permute(std::vector<T>& values, const std::vector<unsigned int>& newIndex)
+{
+    std::vector<T> sorted(values.size());
+    for (size_t i = 0; i < values.size(); i++)
+        sorted[newIndex[i]] = values[i];
+    values.swap(sorted);
+}
+
+void scene_graph::Sort()
+{
+    //Stable counting sort by depth, so siblings keep their relative order
+    unsigned int count = GetCount();
+    unsigned int levels = 0;
+    for (unsigned int depth : m_Depth)
+        levels = std::max(levels, depth + 1);
+
+    m_LevelStart.assign(levels + 1, 0);
+    for (unsigned int depth : m_Depth)
+        m_LevelStart[depth + 1]++;
+    for (unsigned int level = 0; level < levels; level++)
+        m_LevelStart[level + 1] += m_LevelStart[level];
+
+    std::vector<unsigned int> next(m_LevelStart.begin(), m_LevelStart.end() - 1);
+    std::vector<unsigned int> newIndex(count);
+    for (unsigned int i = 0; i < count; i++)
+        newIndex[i] = next[m_Depth[i]]++;
+
+    for (unsigned int& parent : m_Parent)
+    {
+        if (parent != noParent)
+            parent = newIndex[parent];
+    }
+    Permute(m_Local, newIndex);
+    Permute(m_World, newIndex);
+    Permute(m_Parent, newIndex);
+    Permute(m_Depth, newIndex);
+    Permute(m_Flags, newIndex);
+    Permute(m_LocalBounds, newIndex);
+    for (std::vector<float>& component : m_WorldBounds)
+        Permute(component, newIndex);
+    Permute(m_Mesh, newIndex);
+    Permute(m_Color, newIndex);
+    Permute(m_Nodes, newIndex);
+
+    for (unsigned int i = 0; i < count; i++)
+        m_Index[m_Nodes[i]] = i;
+    m_Sorted = true;
+}
+
+bool scene_graph::UpdateRange(unsigned int begin, unsigned int end, bool root)
+{
+    //A node is dirty if it changed itself or its parent, one level up, was recomputed
+    if (!root)
+    {
+        for (unsigned int i = begin; i < end; i++)
+            m_Flags[i] |= m_Flags[m_Parent[i]] & dirtyFlag;
+    }
+
+    bool any = false;
+    aabb transformed[boundsBatchSize];
+    unsigned int i = begin;
+    while (i < end)
+    {
+        if (!(m_Flags[i] & dirtyFlag))
+        {
+            i++;
+            continue;
+        }
+
+        //Runs of consecutive dirty nodes go through the batch kernels together
+        unsigned int runEnd = i + 1;
+        while (runEnd < end && (m_Flags[runEnd] & dirtyFlag))
+            runEnd++;
+        any = true;
+
+        //Matrices and bounds in small batches, so the new matrices are still in cache for the bounds
+        for (unsigned int batch = i; batch < runEnd; batch += boundsBatchSize)
+        {
+            unsigned int batchCount = std::min(boundsBatchSize, runEnd - batch);
+            if (root)
+                std::copy(m_Local.begin() + batch, m_Local.begin() + batch + batchCount, m_World.begin() + batch);
+            else
+                MultiplyMatrices(m_World.data(), &m_Parent[batch], &m_Local[batch], &m_World[batch], batchCount);
+
+            TransformAABBs(&m_World[batch], &m_LocalBounds[batch], transformed, batchCount);
+            for (unsigned int k = 0; k < batchCount; k++)
+            {
+                const aabb& box = m_LocalBounds[batch + k].IsEmpty() ? EmptyAABB() : transformed[k];
+                for (int axis = 0; axis < 3; axis++)
+                {
+                    m_WorldBounds[axis][batch + k] = box.Min[axis];
+                    m_WorldBounds[3 + axis][batch + k] = box.Max[axis];
+                }
+            }
+        }
+        i = runEnd;
+    }
+    return any;
+}
+
+void scene_graph::Update()
+{
+    if (!m_Sorted)
+        Sort();
+
+    unsigned int levels = GetDepthCount();
+    unsigned int firstDirty = levels, lastDirty = 0;
+    bool parentLevelDirty = false;
+    for (unsigned int level = 0; level < levels; level++)
+    {
+        //Nothing above changed and nothing here was touched: the whole level is current
+        if (!parentLevelDirty && m_LevelDirty[level] == 0)
+            continue;
+
+        unsigned int begin = m_LevelStart[level];
+        unsigned int end = m_LevelStart[level + 1];
+        bool root = level == 0;
+        bool any = false;
+        if (m_Jobs && end - begin > updateChunkSize)
+        {
+            std::atomic<bool> anyChunk(false);
+            unsigned int chunks = (end - begin + updateChunkSize - 1) / updateChunkSize;
+            m_Jobs->ParallelFor(chunks, 1, [&](unsigned int chunk)
+            {
+                unsigned int chunkBegin = begin + chunk * updateChunkSize;
+                unsigned int chunkEnd = std::min(chunkBegin + updateChunkSize, end);
+                if (UpdateRange(chunkBegin, chunkEnd, root))
+                    anyChunk.store(true, std::memory_order_relaxed);
+            });
+            any = anyChunk.load();
+        }
+        else
+        {
+            any = UpdateRange(begin, end, root);
+        }
+
+        m_LevelDirty[level] = 0;
+        parentLevelDirty = any;
+        if (any)
+        {
+            firstDirty = std::min(firstDirty, level);
+            lastDirty = level;
+        }
+    }
+
+    //Flags are read one level down during the sweep, so they are only cleared at the end
+    if (firstDirty <= lastDirty)
+    {
+        for (unsigned int i = m_LevelStart[firstDirty]; i < m_LevelStart[lastDirty + 1]; i++)
+            m_Flags[i] &= ~dirtyFlag;
+    }
+}
+
+void scene_graph::Submit(command_list& list, const mat4& viewProjection, unsigned int program, const scene_uniforms& uniforms,
+                         const unsigned int* indices, unsigned int indexCount) const
+{
+    unsigned int count = indices ? indexCount : GetCount();
+    for (unsigned int k = 0; k < count; k++)
+    {
+        unsigned int index = indices ? indices[k] : k;
+        unsigned int mesh = m_Mesh[index];
+        if (mesh == noMesh)
+            continue;
+
+        mat4 transform = viewProjection * m_World[index];
+        draw_uniform values[5];
+        for (int c = 0; c < 4; c++)
+            values[c] = { uniforms.Transform[c], { transform.Columns[c].X, transform.Columns[c].Y, transform.Columns[c].Z, transform.Columns[c].W } };
+        const vec4& color = m_Color[index];
+        values[4] = { uniforms.Color, { color.X, color.Y, color.Z, color.W } };
+
+        //Sorted by mesh so consecutive draws share their vertex array
+        const scene_mesh& drawn = m_Meshes[mesh];
+        list.Submit(renderer::MakeSortKey(0, program, mesh, 0.0f), program, drawn.VertexArray, *drawn.IndexBuffer, values, 5);
+    }
+}
\ No newline at end of file
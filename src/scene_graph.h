@@ -0,0 +1,136 @@
+#pragma once
+
+#include <vector>
+
+#include "simd_math.h"
+
+class command_list;
+class index_buffer;
+class job_system;
+
+typedef unsigned int scene_node;
+static const scene_node invalidSceneNode = ~0u;
+
+//Meshes are registered once and referenced by index from the nodes drawing them
+struct scene_mesh
+{
+	unsigned int VertexArray;
+	const index_buffer* IndexBuffer;
+};
+
+//World space bounding boxes of every node, one array per component, in the
+//graph's storage order (see scene_graph::GetNode)
+struct scene_bounds
+{
+	const float* MinX;
+	const float* MinY;
+	const float* MinZ;
+	const float* MaxX;
+	const float* MaxY;
+	const float* MaxZ;
+};
+
+//Uniform locations of res/shaders/scene.shader
+struct scene_uniforms
+{
+	int Transform[4]; //columns of the model-view-projection matrix
+	int Color;
+};
+
+//Queries the locations in a linked scene.shader program
+scene_uniforms GetSceneUniforms(unsigned int program);
+
+//A transform hierarchy kept as structure of arrays: local and world matrices,
+//parents, flags, bounds and draw data each live in their own contiguous array,
+//ordered by depth so every parent comes before its children. Update then walks
+//the arrays once, level by level, and recomputes world matrices and bounds only
+//where a node or one of its ancestors changed; levels above the first change and
+//below the last one are skipped outright. Within a level nodes don't depend on
+//each other, so with a job system each level is split across the workers.
+//
+//Handles stay valid for the graph's lifetime while storage indices change when
+//Update re-sorts after nodes were added out of depth order. Nodes are never
+//removed; park unused ones under a hidden parent or without a mesh.
+class scene_graph
+{
+public:
+	static const unsigned int noMesh = ~0u;
+
+private:
+	static const unsigned char dirtyFlag = 1;
+	static const unsigned int noParent = ~0u;
+
+	std::vector<mat4> m_Local;
+	std::vector<mat4> m_World;
+	std::vector<unsigned int> m_Parent; //storage index, noParent for roots
+	std::vector<unsigned int> m_Depth;
+	std::vector<unsigned char> m_Flags;
+	std::vector<aabb> m_LocalBounds;
+	std::vector<float> m_WorldBounds[6]; //min x, y, z, max x, y, z
+	std::vector<unsigned int> m_Mesh;
+	std::vector<vec4> m_Color;
+
+	std::vector<scene_node> m_Nodes;    //storage index to handle
+	std::vector<unsigned int> m_Index;  //handle to storage index
+	std::vector<unsigned int> m_LevelStart; //first storage index of each depth, plus the end
+	std::vector<unsigned int> m_LevelDirty; //nodes marked dirty directly, per depth
+
+	std::vector<scene_mesh> m_Meshes;
+	job_system* m_Jobs;
+	bool m_Sorted;
+
+	void MarkDirty(unsigned int index);
+	void Sort();
+	//Returns true if any node in [begin, end) was dirty
+	bool UpdateRange(unsigned int begin, unsigned int end, bool root);
+
+public:
+	//Without a job system Update runs on the calling thread
+	explicit scene_graph(job_system* jobs = nullptr);
+
+	//Reserves storage for count nodes, avoids reallocating while building large graphs
+	void Reserve(unsigned int count);
+
+	unsigned int AddMesh(const scene_mesh& mesh);
+
+	//New node under parent, or a root with invalidSceneNode. Bounds are in the
+	//node's local space, an empty box keeps it out of culling and picking.
+	scene_node Add(scene_node parent, const mat4& local = mat4(), const aabb& bounds = EmptyAABB(),
+	               unsigned int mesh = noMesh, const vec4& color = vec4(1.0f, 1.0f, 1.0f, 1.0f));
+
+	void SetLocal(scene_node node, const mat4& local);
+	inline void SetLocal(scene_node node, const vec3& translation, const quat& rotation, const vec3& scale)
+	{
+		SetLocal(node, Compose(translation, rotation, scale));
+	}
+	void SetBounds(scene_node node, const aabb& bounds);
+	void SetColor(scene_node node, const vec4& color);
+
+	//Recomputes world matrices and bounds of changed subtrees
+	void Update();
+
+	//Records one draw per node with a mesh, for scene.shader with u_Transform set to
+	//viewProjection * world. Pass storage indices (e.g. the ones that survived
+	//culling) to draw only those, or nullptr to draw every node.
+	void Submit(command_list& list, const mat4& viewProjection, unsigned int program, const scene_uniforms& uniforms,
+	            const unsigned int* indices = nullptr, unsigned int indexCount = 0) const;
+
+	//Valid after Update
+	inline const mat4& GetWorld(scene_node node) const { return m_World[m_Index[node]]; }
+	inline const mat4& GetLocal(scene_node node) const { return m_Local[m_Index[node]]; }
+	inline const vec4& GetColor(scene_node node) const { return m_Color[m_Index[node]]; }
+
+	//Storage order views, valid until the next Add
+	inline unsigned int GetCount() const { return (unsigned int)m_Nodes.size(); }
+	inline scene_node GetNode(unsigned int index) const { return m_Nodes[index]; }
+	inline unsigned int GetIndex(scene_node node) const { return m_Index[node]; }
+	inline const mat4* GetWorldMatrices() const { return m_World.data(); }
+	inline const aabb* GetLocalBounds() const { return m_LocalBounds.data(); }
+	inline const unsigned int* GetParents() const { return m_Parent.data(); }
+	inline scene_bounds GetWorldBounds() const
+	{
+		return { m_WorldBounds[0].data(), m_WorldBounds[1].data(), m_WorldBounds[2].data(),
+		         m_WorldBounds[3].data(), m_WorldBounds[4].data(), m_WorldBounds[5].data() };
+	}
+	inline unsigned int GetDepthCount() const { return (unsigned int)m_LevelStart.size() - 1; }
+};
\ No newline at end of file
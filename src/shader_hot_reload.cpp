@@ -0,0 +1,253 @@
+#include "shader_hot_reload.h"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "renderer.h"
+#include "shader_program.h"
+
+
+static const int watchTimeoutMs = 100;
+static const int settleDelayMs = 30;
+
+shader_hot_reload::shader_hot_reload(const std::string& directory)
+    : m_Directory(directory), m_Running(true), m_ParallelCompile(false)
+{
+    //Let the driver compile and link on its own threads so Update() can poll
+    if (GLEW_ARB_parallel_shader_compile)
+    {
+        m_ParallelCompile = true;
+        GLCall(glMaxShaderCompilerThreadsARB(0xFFFFFFFF));
+    }
+    else
+    {
+        std::cout << "[Shader] ARB_parallel_shader_compile missing, reloads will link on the render thread" << std::endl;
+    }
+
+    m_Worker = std::thread(&shader_hot_reload::WorkerLoop, this);
+}
+
+shader_hot_reload::~shader_hot_reload()
+{
+    m_Running = false;
+    if (m_Worker.joinable())
+        m_Worker.join();
+
+    for (pending_link& link : m_Linking)
+    {
+        for (unsigned int shader : link.Shaders)
+        {
+            GLCall(glDeleteShader(shader));
+        }
+        GLCall(glDeleteProgram(link.Program));
+    }
+
+    for (watched_shader& watched : m_Shaders)
+    {
+        GLCall(glDeleteProgram(watched.Program));
+    }
+}
+
+unsigned int shader_hot_reload::Watch(const std::string& filepath, const std::vector<shader_define>& defines)
+{
+    watched_shader watched;
+    watched.Preprocessor = std::make_unique<shader_preprocessor>(filepath);
+    watched.Defines = defines;
+    watched.Filepath = filepath;
+    watched.Program = createShader(watched.Preprocessor->GetVariant(defines));
+
+    std::lock_guard<std::mutex> lock(m_WatchMutex);
+    m_Shaders.push_back(std::move(watched));
+    return (unsigned int)m_Shaders.size() - 1;
+}
+
+void shader_hot_reload::WorkerLoop()
+{
+#ifdef __linux__
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0 || inotify_add_watch(fd, m_Directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0)
+    {
+        std::cout << "[Shader] Could not watch " << m_Directory << std::endl;
+        if (fd >= 0)
+            close(fd);
+        return;
+    }
+
+    alignas(inotify_event) char events[4096];
+    while (m_Running)
+    {
+        pollfd waiting = { fd, POLLIN, 0 };
+        if (poll(&waiting, 1, watchTimeoutMs) <= 0)
+            continue;
+
+        //Editors tend to write a file in several steps, wait for it to settle then
+        //drain everything. Includes can be any file, so every event counts.
+        std::this_thread::sleep_for(std::chrono::milliseconds(settleDelayMs));
+        while (read(fd, events, sizeof(events)) > 0);
+
+        RebuildChanged();
+    }
+    close(fd);
+#else
+    namespace fs = std::filesystem;
+
+    auto newestWrite = [this]()
+    {
+        fs::file_time_type newest{};
+        std::error_code error;
+        for (const fs::directory_entry& entry : fs::directory_iterator(m_Directory, error))
+        {
+            fs::file_time_type time = entry.last_write_time(error);
+            if (!error && time > newest)
+                newest = time;
+        }
+        return newest;
+    };
+
+    fs::file_time_type lastSeen = newestWrite();
+    while (m_Running)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(watchTimeoutMs));
+
+        fs::file_time_type newest = newestWrite();
+        if (newest == lastSeen)
+            continue;
+
+        lastSeen = newest;
+        std::this_thread::sleep_for(std::chrono::milliseconds(settleDelayMs));
+        RebuildChanged();
+    }
+#endif
+}
+
+void shader_hot_reload::RebuildChanged()
+{
+    std::lock_guard<std::mutex> lock(m_WatchMutex);
+
+    for (unsigned int handle = 0; handle < m_Shaders.size(); handle++)
+    {
+        watched_shader& watched = m_Shaders[handle];
+
+        //Reload only drops the cached variants when the expanded text differs
+        uint64_t before = watched.Preprocessor->GetContentHash();
+        if (!watched.Preprocessor->Reload() || watched.Preprocessor->GetContentHash() == before)
+            continue;
+
+        ShaderProgramSource source = watched.Preprocessor->GetVariant(watched.Defines);
+
+        std::lock_guard<std::mutex> ready(m_ReadyMutex);
+        m_Ready.emplace_back(handle, std::move(source));
+    }
+}
+
+void shader_hot_reload::BeginLink(unsigned int handle, const ShaderProgramSource& source)
+{
+    //A newer edit supersedes a link that is still in flight for the same shader
+    for (auto it = m_Linking.begin(); it != m_Linking.end(); ++it)
+    {
+        if (it->Handle != handle)
+            continue;
+
+        for (unsigned int shader : it->Shaders)
+        {
+            GLCall(glDeleteShader(shader));
+        }
+        GLCall(glDeleteProgram(it->Program));
+        m_Linking.erase(it);
+        break;
+    }
+
+    pending_link link;
+    link.Handle = handle;
+    link.Program = glCreateProgram();
+
+    //No status queries here, those would wait for the compile to finish
+    for (int i = 0; i < (int)shader_stage::COUNT; i++)
+    {
+        const std::string& stageSource = source.Get((shader_stage)i);
+        if (stageSource.empty())
+            continue;
+
+        unsigned int shader = glCreateShader(GetStageGLType((shader_stage)i));
+        const char* src = stageSource.c_str();
+        GLCall(glShaderSource(shader, 1, &src, nullptr));
+        GLCall(glCompileShader(shader));
+        GLCall(glAttachShader(link.Program, shader));
+        link.Shaders.push_back(shader);
+    }
+
+    GLCall(glLinkProgram(link.Program));
+    m_Linking.push_back(std::move(link));
+}
+
+bool shader_hot_reload::Update()
+{
+    //Never wait on the worker: if it is busy handing over sources, take them next frame
+    std::vector<std::pair<unsigned int, ShaderProgramSource>> ready;
+    {
+        std::unique_lock<std::mutex> lock(m_ReadyMutex, std::try_to_lock);
+        if (lock.owns_lock())
+            ready.swap(m_Ready);
+    }
+
+    for (const auto& entry : ready)
+        BeginLink(entry.first, entry.second);
+
+    bool swapped = false;
+    for (auto it = m_Linking.begin(); it != m_Linking.end();)
+    {
+        if (m_ParallelCompile)
+        {
+            int done = GL_FALSE;
+            GLCall(glGetProgramiv(it->Program, GL_COMPLETION_STATUS_ARB, &done));
+            if (done == GL_FALSE)
+            {
+                ++it;
+                continue;
+            }
+        }
+
+        watched_shader& watched = m_Shaders[it->Handle];
+        bool linked = checkProgramLink(it->Program, watched.Filepath);
+
+        for (unsigned int shader : it->Shaders)
+        {
+            if (!linked)
+            {
+                int compiled;
+                GLCall(glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled));
+                if (compiled == GL_FALSE)
+                {
+                    char message[2048];
+                    GLCall(glGetShaderInfoLog(shader, sizeof(message), nullptr, message));
+                    std::cout << message << std::endl;
+                }
+            }
+            GLCall(glDetachShader(it->Program, shader));
+            GLCall(glDeleteShader(shader));
+        }
+
+        //The old program keeps rendering unless the new one is complete and valid
+        if (linked)
+        {
+            GLCall(glDeleteProgram(watched.Program));
+            watched.Program = it->Program;
+            swapped = true;
+            std::cout << "[Shader] Reloaded " << watched.Filepath << std::endl;
+        }
+        else
+        {
+            GLCall(glDeleteProgram(it->Program));
+        }
+
+        it = m_Linking.erase(it);
+    }
+    return swapped;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "shader_preprocessor.h"
+
+//Development helper: watches a shader directory on a worker thread (inotify on
+//Linux, timestamp polling elsewhere), re-preprocesses changed .shader files off
+//the render thread and relinks them without stalling a frame. With
+//ARB_parallel_shader_compile the driver compiles in the background and Update()
+//only swaps a program in once its link has finished and succeeded; the previous
+//program stays in use on any error.
+class shader_hot_reload
+{
+private:
+	struct watched_shader
+	{
+		std::unique_ptr<shader_preprocessor> Preprocessor; //only touched by the worker after Watch()
+		std::vector<shader_define> Defines;
+		std::string Filepath;
+		unsigned int Program;
+	};
+
+	struct pending_link
+	{
+		unsigned int Handle;
+		unsigned int Program;
+		std::vector<unsigned int> Shaders;
+	};
+
+	std::string m_Directory;
+	std::vector<watched_shader> m_Shaders;
+	std::vector<pending_link> m_Linking;
+
+	//Sources rebuilt by the worker, waiting for the GL thread to pick them up
+	std::mutex m_ReadyMutex;
+	std::vector<std::pair<unsigned int, ShaderProgramSource>> m_Ready;
+
+	std::mutex m_WatchMutex;
+	std::thread m_Worker;
+	std::atomic<bool> m_Running;
+	bool m_ParallelCompile;
+
+	void WorkerLoop();
+	void RebuildChanged();
+	void BeginLink(unsigned int handle, const ShaderProgramSource& source);
+
+public:
+	explicit shader_hot_reload(const std::string& directory);
+	~shader_hot_reload();
+
+	shader_hot_reload(const shader_hot_reload&) = delete;
+	shader_hot_reload& operator=(const shader_hot_reload&) = delete;
+
+	//Builds the program synchronously and returns a handle for GetProgram
+	unsigned int Watch(const std::string& filepath, const std::vector<shader_define>& defines = {});
+
+	//Call once per frame on the GL thread. Returns true if any program was swapped,
+	//in which case uniform locations need to be looked up again.
+	bool Update();
+
+	inline unsigned int GetProgram(unsigned int handle) const { return m_Shaders[handle].Program; }
+};
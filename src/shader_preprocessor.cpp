@@ -0,0 +1,278 @@
+#include "shader_preprocessor.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <optional>
+
+#include "mapped_file.h"
+
+
+static const int maxIncludeDepth = 16;
+
+uint64_t HashShaderText(const char* data, size_t size, uint64_t seed)
+{
+    //FNV-1a over 8 bytes at a time, plenty for a cache key and it keeps up with the parser
+    uint64_t hash = seed;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        hash ^= word;
+        hash *= 1099511628211ull;
+    }
+    for (; i < size; i++)
+    {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static std::string_view Trim(std::string_view text)
+{
+    size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos)
+        return {};
+    size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+//Whitespace separated token of text starting at or after pos, empty at the end
+static std::string_view NextToken(std::string_view text, size_t& pos)
+{
+    size_t first = text.find_first_not_of(" \t\r", pos);
+    if (first == std::string_view::npos)
+    {
+        pos = text.size();
+        return {};
+    }
+    size_t last = text.find_first_of(" \t\r", first);
+    pos = last == std::string_view::npos ? text.size() : last;
+    return text.substr(first, pos - first);
+}
+
+static std::string DirectoryOf(const std::string& filepath)
+{
+    size_t slash = filepath.find_last_of("/\\");
+    return slash == std::string::npos ? "" : filepath.substr(0, slash + 1);
+}
+
+//Copies a stage into out with the defines right after '#version', which has to stay
+//the first statement of a stage
+static void InjectDefines(std::string_view stage, const std::string& defines, std::string& out)
+{
+    out.clear();
+    if (stage.empty() || defines.empty())
+    {
+        out.append(stage.data() ? stage.data() : "", stage.size());
+        return;
+    }
+
+    out.reserve(stage.size() + defines.size() + 1);
+    size_t version = stage.find("#version");
+    if (version == std::string_view::npos)
+    {
+        out.append(defines).append(stage);
+        return;
+    }
+
+    size_t lineEnd = stage.find('\n', version);
+    if (lineEnd == std::string_view::npos)
+    {
+        out.append(stage).append("\n").append(defines);
+        return;
+    }
+
+    out.append(stage.substr(0, lineEnd + 1)).append(defines).append(stage.substr(lineEnd + 1));
+}
+
+shader_preprocessor::shader_preprocessor(const std::string& filepath, bool preferEmbedded)
+    : m_Filepath(filepath), m_PreferEmbedded(preferEmbedded), m_ContentHash(0)
+{
+    Reload();
+}
+
+bool shader_preprocessor::Expand(const std::string& filepath, std::string& out,
+                                 std::vector<std::string>& included, int depth)
+{
+    if (depth > maxIncludeDepth)
+    {
+        std::cout << "[Shader] Include depth exceeded at " << filepath << std::endl;
+        return false;
+    }
+
+    //Each file is pulled in once per expansion, which also breaks include cycles
+    if (std::find(included.begin(), included.end(), filepath) != included.end())
+        return true;
+    included.push_back(filepath);
+
+    //The embedded copy or the file mapped into memory, walked once: only the '#'s are
+    //visited and the text between directives is appended in one go
+    std::string_view text = m_PreferEmbedded ? FindEmbeddedShader(filepath) : std::string_view();
+    std::optional<mapped_file> file;
+    if (text.empty())
+    {
+        file.emplace(filepath);
+        if (!file->IsOpen())
+        {
+            std::cout << "[Shader] Could not open " << filepath << std::endl;
+            return false;
+        }
+        text = file->GetView();
+    }
+
+    bool ok = true;
+    size_t copied = 0; //start of the text not appended yet
+    size_t pos = 0;
+    while ((pos = text.find('#', pos)) != std::string_view::npos)
+    {
+        bool isInclude = text.substr(pos, 8) == "#include";
+        bool isPermutation = text.substr(pos, 12) == "#permutation";
+
+        //Directives only count with nothing but blanks before them on their line
+        size_t lineStart = pos;
+        while (lineStart > 0 && (text[lineStart - 1] == ' ' || text[lineStart - 1] == '\t'))
+            lineStart--;
+        if (!(isInclude || isPermutation) || (lineStart > 0 && text[lineStart - 1] != '\n'))
+        {
+            pos++;
+            continue;
+        }
+
+        size_t lineEnd = text.find('\n', pos);
+        if (lineEnd == std::string_view::npos)
+            lineEnd = text.size();
+        std::string_view line = text.substr(lineStart, lineEnd - lineStart);
+        std::string_view directive = Trim(line);
+
+        out.append(text.data() + copied, lineStart - copied);
+        copied = std::min(lineEnd + 1, text.size());
+        pos = copied;
+
+        if (isInclude)
+        {
+            size_t open = directive.find('"');
+            size_t close = directive.find('"', open + 1);
+            if (open == std::string_view::npos || close == std::string_view::npos)
+            {
+                std::cout << "[Shader] Malformed include in " << filepath << ": " << line << std::endl;
+                ok = false;
+                continue;
+            }
+            std::string name(directive.substr(open + 1, close - open - 1));
+            ok = Expand(DirectoryOf(filepath) + name, out, included, depth + 1) && ok;
+        }
+        else if (isPermutation)
+        {
+            size_t token = 12;
+            shader_permutation_axis axis;
+            axis.Name = NextToken(directive, token);
+            for (std::string_view value = NextToken(directive, token); !value.empty(); value = NextToken(directive, token))
+                axis.Values.emplace_back(value);
+
+            if (axis.Name.empty() || axis.Values.empty())
+            {
+                std::cout << "[Shader] Permutation without values in " << filepath << ": " << line << std::endl;
+                ok = false;
+                continue;
+            }
+            m_Axes.push_back(axis);
+        }
+    }
+
+    //Whatever follows the last directive, ending in a newline so the next file starts on a line of its own
+    if (copied < text.size())
+    {
+        out.append(text.data() + copied, text.size() - copied);
+        if (text.back() != '\n')
+            out += '\n';
+    }
+    return ok;
+}
+
+bool shader_preprocessor::Reload()
+{
+    std::vector<std::string> included;
+    std::string expanded;
+
+    m_Axes.clear();
+    bool ok = Expand(m_Filepath, expanded, included, 0);
+
+    shader_sections sections = ParseShaderSections(expanded);
+    for (int i = 0; i < (int)shader_stage::COUNT; i++)
+    {
+        if (sections.DuplicateMask & (1u << i))
+            std::cout << "[Shader] Duplicate " << shaderStageNames[i] << " section in "
+                << m_Filepath << ", keeping the first one" << std::endl;
+    }
+
+    uint64_t hash = HashShaderText(expanded.data(), expanded.size());
+    for (const shader_permutation_axis& axis : m_Axes)
+    {
+        hash = HashShaderText(axis.Name.data(), axis.Name.size(), hash);
+        for (const std::string& value : axis.Values)
+            hash = HashShaderText(value.data(), value.size(), hash);
+    }
+
+    //Keep the variants that are already built if nothing actually changed
+    if (hash != m_ContentHash)
+    {
+        m_Variants.clear();
+        m_Expanded = std::move(expanded);
+        m_ContentHash = hash;
+    }
+    return ok;
+}
+
+const ShaderProgramSource& shader_preprocessor::GetVariant(const std::vector<shader_define>& defines)
+{
+    //Every axis ends up defined, falling back to its first declared value
+    std::vector<shader_define> resolved;
+    for (const shader_permutation_axis& axis : m_Axes)
+        resolved.push_back({ axis.Name, axis.Values[0] });
+
+    for (const shader_define& define : defines)
+    {
+        auto axis = std::find_if(m_Axes.begin(), m_Axes.end(),
+            [&](const shader_permutation_axis& a) { return a.Name == define.Name; });
+
+        if (axis != m_Axes.end())
+        {
+            if (std::find(axis->Values.begin(), axis->Values.end(), define.Value) == axis->Values.end())
+            {
+                std::cout << "[Shader] " << define.Value << " is not a declared value of "
+                    << define.Name << " in " << m_Filepath << std::endl;
+                continue;
+            }
+            resolved[axis - m_Axes.begin()].Value = define.Value;
+        }
+        else
+        {
+            resolved.push_back(define);
+        }
+    }
+
+    //Sort the extra defines so the same set in a different order hits the same variant
+    std::sort(resolved.begin() + m_Axes.size(), resolved.end(),
+        [](const shader_define& a, const shader_define& b) { return a.Name < b.Name; });
+
+    std::string defineBlock;
+    for (const shader_define& define : resolved)
+        defineBlock += "#define " + define.Name + " " + define.Value + "\n";
+
+    uint64_t key = HashShaderText(defineBlock.data(), defineBlock.size(), m_ContentHash);
+
+    auto cached = m_Variants.find(key);
+    if (cached != m_Variants.end())
+        return cached->second;
+
+    //Stages are copied straight from the expanded text, defines included
+    shader_sections sections = ParseShaderSections(m_Expanded);
+    ShaderProgramSource source;
+    for (int i = 0; i < (int)shader_stage::COUNT; i++)
+        InjectDefines(sections.Stages[i], defineBlock, source.Get((shader_stage)i));
+
+    return m_Variants.emplace(key, std::move(source)).first->second;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "shader_source.h"
+
+//A '#permutation NAME value0 value1 ...' line declared in a .shader file.
+//The first value is the default when a variant does not pick one.
+struct shader_permutation_axis
+{
+	std::string Name;
+	std::vector<std::string> Values;
+};
+
+struct shader_define
+{
+	std::string Name;
+	std::string Value;
+};
+
+//Expands '#include "file"' lines, collects '#permutation' axes and hands out
+//per-variant sources with the selected values injected as '#define's right
+//after '#version'. Variants are generated on first request and cached by a
+//hash of the expanded file contents plus the define set, so dead '#if' branches
+//are stripped by the GLSL compiler instead of branching on a uniform per pixel.
+class shader_preprocessor
+{
+private:
+	std::string m_Filepath;
+	bool m_PreferEmbedded;
+	std::string m_Expanded;
+	uint64_t m_ContentHash;
+	std::vector<shader_permutation_axis> m_Axes;
+	std::unordered_map<uint64_t, ShaderProgramSource> m_Variants;
+
+	bool Expand(const std::string& filepath, std::string& out,
+	            std::vector<std::string>& included, int depth);
+
+public:
+	//With preferEmbedded, files compiled in by tools/embed_shaders are used instead of the disk
+	explicit shader_preprocessor(const std::string& filepath, bool preferEmbedded = false);
+
+	//Re-reads the file and its includes, dropping cached variants if anything changed
+	bool Reload();
+
+	const ShaderProgramSource& GetVariant(const std::vector<shader_define>& defines = {});
+
+	inline const std::vector<shader_permutation_axis>& GetAxes() const { return m_Axes; }
+	inline uint64_t GetContentHash() const { return m_ContentHash; }
+	inline size_t GetVariantCount() const { return m_Variants.size(); }
+};
+
+uint64_t HashShaderText(const char* data, size_t size, uint64_t seed = 14695981039346656037ull);
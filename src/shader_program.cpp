@@ -0,0 +1,101 @@
+#include "shader_program.h"
+
+#include <iostream>
+
+#include "renderer.h"
+
+
+static const unsigned int stageTypes[(int)shader_stage::COUNT] = {
+    GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, GL_GEOMETRY_SHADER,
+    GL_TESS_CONTROL_SHADER, GL_TESS_EVALUATION_SHADER, GL_COMPUTE_SHADER
+};
+
+unsigned int GetStageGLType(shader_stage stage)
+{
+    return stageTypes[(int)stage];
+}
+
+unsigned int compileShader(shader_stage stage, const std::string& source)
+{
+    unsigned int type = stageTypes[(int)stage];
+
+    unsigned int id = glCreateShader(type);
+
+    //Make sure this string stays alive to avoid ptr to junk
+    const char* src = source.c_str();
+    GLCall(glShaderSource(id, 1, &src, nullptr));
+    GLCall(glCompileShader(id));
+
+    int result;
+    GLCall(glGetShaderiv(id, GL_COMPILE_STATUS, &result));
+
+    if (result == GL_FALSE)
+    {
+        int length;
+        GLCall(glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length));
+        char* message = (char*)alloca(length * sizeof(char));
+        GLCall(glGetShaderInfoLog(id, length, &length, message));
+
+        std::cout << "Failed to compile " << GetStageName(stage) << std::endl;
+
+        std::cout << message << std::endl;
+
+        GLCall(glDeleteShader(id));
+        return 0;
+    }
+
+    return id;
+}
+
+unsigned int createShader(const ShaderProgramSource& source)
+{
+    unsigned int program = glCreateProgram();
+
+    //Create a shader object for every stage present in the file
+    unsigned int shaders[(int)shader_stage::COUNT] = {};
+    for (int i = 0; i < (int)shader_stage::COUNT; i++)
+    {
+        const std::string& stageSource = source.Get((shader_stage)i);
+        if (stageSource.empty())
+            continue;
+
+        shaders[i] = compileShader((shader_stage)i, stageSource);
+        if (shaders[i])
+        {
+            GLCall(glAttachShader(program, shaders[i]));
+        }
+    }
+
+    GLCall(glLinkProgram(program));
+    GLCall(glValidateProgram(program));
+
+    for (unsigned int shader : shaders)
+    {
+        if (shader)
+        {
+            GLCall(glDeleteShader(shader));
+        }
+    }
+
+    return program;
+}
+
+bool checkProgramLink(unsigned int program, const std::string& name)
+{
+    int result;
+    GLCall(glGetProgramiv(program, GL_LINK_STATUS, &result));
+
+    if (result == GL_FALSE)
+    {
+        int length;
+        GLCall(glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length));
+        char* message = (char*)alloca((length + 1) * sizeof(char));
+        message[0] = '\0';
+        GLCall(glGetProgramInfoLog(program, length + 1, &length, message));
+
+        std::cout << "Failed to link " << name << std::endl;
+        std::cout << message << std::endl;
+        return false;
+    }
+    return true;
+}
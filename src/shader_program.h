@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+
+#include "shader_source.h"
+
+unsigned int GetStageGLType(shader_stage stage);
+
+//Compiles one stage, logging and returning 0 on failure
+unsigned int compileShader(shader_stage stage, const std::string& source);
+
+//Compiles and links every stage present in source into one program
+unsigned int createShader(const ShaderProgramSource& source);
+
+//Queries the link status, logging the info log on failure. Blocks until linking is done.
+bool checkProgramLink(unsigned int program, const std::string& name);
@@ -0,0 +1,43 @@
+#include "shader_source.h"
+
+#include "embedded_shaders.h"
+
+
+std::string& ShaderProgramSource::Get(shader_stage stage)
+{
+    switch (stage)
+    {
+    case shader_stage::FRAGMENT:        return FragmentSource;
+    case shader_stage::GEOMETRY:        return GeometrySource;
+    case shader_stage::TESS_CONTROL:    return TessControlSource;
+    case shader_stage::TESS_EVALUATION: return TessEvaluationSource;
+    case shader_stage::COMPUTE:         return ComputeSource;
+    default:                            return VertexSource;
+    }
+}
+
+const std::string& ShaderProgramSource::Get(shader_stage stage) const
+{
+    return const_cast<ShaderProgramSource*>(this)->Get(stage);
+}
+
+ShaderProgramSource ToProgramSource(const shader_sections& sections)
+{
+    ShaderProgramSource source;
+    for (int i = 0; i < (int)shader_stage::COUNT; i++)
+    {
+        std::string_view body = sections.Stages[i];
+        source.Get((shader_stage)i).assign(body.data() ? body.data() : "", body.size());
+    }
+    return source;
+}
+
+std::string_view FindEmbeddedShader(std::string_view filepath)
+{
+    for (const embedded_shader_file& file : embeddedShaderFiles)
+    {
+        if (file.Path == filepath)
+            return file.Text;
+    }
+    return {};
+}
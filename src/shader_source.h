@@ -0,0 +1,122 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+enum class shader_stage
+{
+	VERTEX = 0, FRAGMENT, GEOMETRY, TESS_CONTROL, TESS_EVALUATION, COMPUTE, COUNT
+};
+
+//Views into the text of a .shader file, one per '#shader <stage>' section.
+//Lines before the first tag land in Preamble instead of any stage.
+struct shader_sections
+{
+	std::string_view Preamble;
+	std::string_view Stages[(int)shader_stage::COUNT];
+	unsigned int DuplicateMask = 0; //bit per stage that was tagged more than once
+
+	constexpr std::string_view Get(shader_stage stage) const { return Stages[(int)stage]; }
+};
+
+struct ShaderProgramSource
+{
+	std::string VertexSource;
+	std::string FragmentSource;
+	std::string GeometrySource;
+	std::string TessControlSource;
+	std::string TessEvaluationSource;
+	std::string ComputeSource;
+
+	std::string& Get(shader_stage stage);
+	const std::string& Get(shader_stage stage) const;
+};
+
+inline constexpr std::string_view shaderStageNames[(int)shader_stage::COUNT] = {
+	"vertex", "fragment", "geometry", "tess_control", "tess_evaluation", "compute"
+};
+
+inline const char* GetStageName(shader_stage stage) { return shaderStageNames[(int)stage].data(); }
+
+//-1 for an unknown tag so its lines are dropped instead of indexing out of bounds
+constexpr int StageFromTag(std::string_view tag)
+{
+	size_t first = tag.find_first_not_of(" \t");
+	if (first == std::string_view::npos)
+		return -1;
+
+	size_t last = tag.find_last_not_of(" \t\r\n");
+	tag = tag.substr(first, last - first + 1);
+
+	for (int i = 0; i < (int)shader_stage::COUNT; i++)
+	{
+		if (tag == shaderStageNames[i])
+			return i;
+	}
+	return -1;
+}
+
+//Single pass over the text, no copies: the views stay valid as long as text does.
+//Only the '#' of possible tags are visited, the lines in between are skipped whole.
+//constexpr so embedded shaders can be split while compiling.
+constexpr shader_sections ParseShaderSections(std::string_view text)
+{
+	shader_sections sections;
+
+	const int preamble = (int)shader_stage::COUNT;
+	int stage = preamble;
+	size_t sectionStart = 0;
+	size_t pos = 0;
+
+	while (true)
+	{
+		//Parsing shader file to find the specified sections: a tag is a line that
+		//starts with '#shader' after blanks
+		size_t tag = text.find("#shader", pos);
+		size_t lineStart = text.size();
+		if (tag != std::string_view::npos)
+		{
+			lineStart = tag;
+			while (lineStart > 0 && (text[lineStart - 1] == ' ' || text[lineStart - 1] == '\t'))
+				lineStart--;
+			if (lineStart > 0 && text[lineStart - 1] != '\n')
+			{
+				pos = tag + 7;
+				continue;
+			}
+		}
+
+		//A tag or the end of the text closes the current section
+		std::string_view body = text.substr(sectionStart, lineStart - sectionStart);
+		if (stage == preamble)
+			sections.Preamble = body;
+		else if (stage >= 0 && sections.Stages[stage].data() != nullptr)
+			sections.DuplicateMask |= 1u << stage;  //first section of a stage wins
+		else if (stage >= 0)
+			sections.Stages[stage] = body;
+
+		if (tag == std::string_view::npos)
+			break;
+
+		size_t lineEnd = text.find('\n', tag);
+		size_t next = lineEnd == std::string_view::npos ? text.size() : lineEnd + 1;
+		stage = StageFromTag(text.substr(tag + 7, next - tag - 7));
+		sectionStart = next;
+		pos = next;
+	}
+
+	return sections;
+}
+
+ShaderProgramSource ToProgramSource(const shader_sections& sections);
+
+struct embedded_shader_file
+{
+	std::string_view Path;
+	std::string_view Text;
+};
+
+//Copy of a file compiled into the binary by tools/embed_shaders, looked up by the
+//path it was embedded under (e.g. "res/shaders/basic.shader"). Empty if not embedded.
+std::string_view FindEmbeddedShader(std::string_view filepath);
@@ -0,0 +1,372 @@
+#include "simd_math.h"
+
+
+mat3 Transpose(const mat3& m)
+{
+    return mat3(vec3(m.Columns[0].X, m.Columns[1].X, m.Columns[2].X),
+                vec3(m.Columns[0].Y, m.Columns[1].Y, m.Columns[2].Y),
+                vec3(m.Columns[0].Z, m.Columns[1].Z, m.Columns[2].Z));
+}
+
+mat3 Inverse(const mat3& m)
+{
+    //Rows of the inverse are the cross products of the other two columns over the determinant
+    vec3 r0 = Cross(m.Columns[1], m.Columns[2]);
+    vec3 r1 = Cross(m.Columns[2], m.Columns[0]);
+    vec3 r2 = Cross(m.Columns[0], m.Columns[1]);
+    float determinant = Dot(m.Columns[0], r0);
+    if (determinant == 0.0f)
+        return mat3();
+
+    float inverse = 1.0f / determinant;
+    return Transpose(mat3(r0 * inverse, r1 * inverse, r2 * inverse));
+}
+
+mat4 Transpose(const mat4& m)
+{
+#ifdef SIMD_MATH_SSE
+    __m128 c0 = LoadVec4(m.Columns[0]), c1 = LoadVec4(m.Columns[1]), c2 = LoadVec4(m.Columns[2]), c3 = LoadVec4(m.Columns[3]);
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+    return mat4(StoreVec4(c0), StoreVec4(c1), StoreVec4(c2), StoreVec4(c3));
+#else
+    mat4 result;
+    for (int c = 0; c < 4; c++)
+        for (int r = 0; r < 4; r++)
+            result.Columns[c][r] = m.Columns[r][c];
+    return result;
+#endif
+}
+
+mat4 Inverse(const mat4& m)
+{
+    //Cofactor expansion; it works the same on either storage order
+    const float* a = m.GetData();
+    float inv[16];
+
+    inv[0] = a[5] * a[10] * a[15] - a[5] * a[11] * a[14] - a[9] * a[6] * a[15] + a[9] * a[7] * a[14] + a[13] * a[6] * a[11] - a[13] * a[7] * a[10];
+    inv[4] = -a[4] * a[10] * a[15] + a[4] * a[11] * a[14] + a[8] * a[6] * a[15] - a[8] * a[7] * a[14] - a[12] * a[6] * a[11] + a[12] * a[7] * a[10];
+    inv[8] = a[4] * a[9] * a[15] - a[4] * a[11] * a[13] - a[8] * a[5] * a[15] + a[8] * a[7] * a[13] + a[12] * a[5] * a[11] - a[12] * a[7] * a[9];
+    inv[12] = -a[4] * a[9] * a[14] + a[4] * a[10] * a[13] + a[8] * a[5] * a[14] - a[8] * a[6] * a[13] - a[12] * a[5] * a[10] + a[12] * a[6] * a[9];
+    inv[1] = -a[1] * a[10] * a[15] + a[1] * a[11] * a[14] + a[9] * a[2] * a[15] - a[9] * a[3] * a[14] - a[13] * a[2] * a[11] + a[13] * a[3] * a[10];
+    inv[5] = a[0] * a[10] * a[15] - a[0] * a[11] * a[14] - a[8] * a[2] * a[15] + a[8] * a[3] * a[14] + a[12] * a[2] * a[11] - a[12] * a[3] * a[10];
+    inv[9] = -a[0] * a[9] * a[15] + a[0] * a[11] * a[13] + a[8] * a[1] * a[15] - a[8] * a[3] * a[13] - a[12] * a[1] * a[11] + a[12] * a[3] * a[9];
+    inv[13] = a[0] * a[9] * a[14] - a[0] * a[10] * a[13] - a[8] * a[1] * a[14] + a[8] * a[2] * a[13] + a[12] * a[1] * a[10] - a[12] * a[2] * a[9];
+    inv[2] = a[1] * a[6] * a[15] - a[1] * a[7] * a[14] - a[5] * a[2] * a[15] + a[5] * a[3] * a[14] + a[13] * a[2] * a[7] - a[13] * a[3] * a[6];
+    inv[6] = -a[0] * a[6] * a[15] + a[0] * a[7] * a[14] + a[4] * a[2] * a[15] - a[4] * a[3] * a[14] - a[12] * a[2] * a[7] + a[12] * a[3] * a[6];
+    inv[10] = a[0] * a[5] * a[15] - a[0] * a[7] * a[13] - a[4] * a[1] * a[15] + a[4] * a[3] * a[13] + a[12] * a[1] * a[7] - a[12] * a[3] * a[5];
+    inv[14] = -a[0] * a[5] * a[14] + a[0] * a[6] * a[13] + a[4] * a[1] * a[14] - a[4] * a[2] * a[13] - a[12] * a[1] * a[6] + a[12] * a[2] * a[5];
+    inv[3] = -a[1] * a[6] * a[11] + a[1] * a[7] * a[10] + a[5] * a[2] * a[11] - a[5] * a[3] * a[10] - a[9] * a[2] * a[7] + a[9] * a[3] * a[6];
+    inv[7] = a[0] * a[6] * a[11] - a[0] * a[7] * a[10] - a[4] * a[2] * a[11] + a[4] * a[3] * a[10] + a[8] * a[2] * a[7] - a[8] * a[3] * a[6];
+    inv[11] = -a[0] * a[5] * a[11] + a[0] * a[7] * a[9] + a[4] * a[1] * a[11] - a[4] * a[3] * a[9] - a[8] * a[1] * a[7] + a[8] * a[3] * a[5];
+    inv[15] = a[0] * a[5] * a[10] - a[0] * a[6] * a[9] - a[4] * a[1] * a[10] + a[4] * a[2] * a[9] + a[8] * a[1] * a[6] - a[8] * a[2] * a[5];
+
+    float determinant = a[0] * inv[0] + a[1] * inv[4] + a[2] * inv[8] + a[3] * inv[12];
+    if (determinant == 0.0f)
+        return mat4();
+
+    float scale = 1.0f / determinant;
+    mat4 result;
+    for (int c = 0; c < 4; c++)
+        for (int r = 0; r < 4; r++)
+            result.Columns[c][r] = inv[c * 4 + r] * scale;
+    return result;
+}
+
+mat4 InverseAffine(const mat4& m)
+{
+    mat3 inverse = Inverse(ToMat3(m));
+    vec3 translation = -(inverse * m.GetTranslation());
+    return mat4(vec4(inverse.Columns[0], 0.0f), vec4(inverse.Columns[1], 0.0f), vec4(inverse.Columns[2], 0.0f),
+                vec4(translation, 1.0f));
+}
+
+mat4 Translation(const vec3& offset)
+{
+    mat4 result;
+    result.Columns[3] = vec4(offset, 1.0f);
+    return result;
+}
+
+mat4 Scaling(const vec3& scale)
+{
+    mat4 result;
+    result.Columns[0].X = scale.X;
+    result.Columns[1].Y = scale.Y;
+    result.Columns[2].Z = scale.Z;
+    return result;
+}
+
+mat4 Perspective(float fovY, float aspect, float zNear, float zFar)
+{
+    float f = 1.0f / std::tan(fovY * 0.5f);
+    float depth = 1.0f / (zNear - zFar);
+    return mat4(vec4(f / aspect, 0.0f, 0.0f, 0.0f),
+                vec4(0.0f, f, 0.0f, 0.0f),
+                vec4(0.0f, 0.0f, (zFar + zNear) * depth, -1.0f),
+                vec4(0.0f, 0.0f, 2.0f * zFar * zNear * depth, 0.0f));
+}
+
+mat4 Orthographic(float left, float right, float bottom, float top, float zNear, float zFar)
+{
+    return mat4(vec4(2.0f / (right - left), 0.0f, 0.0f, 0.0f),
+                vec4(0.0f, 2.0f / (top - bottom), 0.0f, 0.0f),
+                vec4(0.0f, 0.0f, -2.0f / (zFar - zNear), 0.0f),
+                vec4(-(right + left) / (right - left), -(top + bottom) / (top - bottom), -(zFar + zNear) / (zFar - zNear), 1.0f));
+}
+
+mat4 LookAt(const vec3& eye, const vec3& target, const vec3& up)
+{
+    vec3 forward = Normalize(target - eye);
+    vec3 side = Normalize(Cross(forward, up));
+    vec3 cameraUp = Cross(side, forward);
+    return mat4(vec4(side.X, cameraUp.X, -forward.X, 0.0f),
+                vec4(side.Y, cameraUp.Y, -forward.Y, 0.0f),
+                vec4(side.Z, cameraUp.Z, -forward.Z, 0.0f),
+                vec4(-Dot(side, eye), -Dot(cameraUp, eye), Dot(forward, eye), 1.0f));
+}
+
+quat AxisAngle(const vec3& axis, float angle)
+{
+    vec3 v = Normalize(axis) * std::sin(angle * 0.5f);
+    return quat(v.X, v.Y, v.Z, std::cos(angle * 0.5f));
+}
+
+quat Normalize(const quat& q)
+{
+    float length = std::sqrt(q.X * q.X + q.Y * q.Y + q.Z * q.Z + q.W * q.W);
+    if (length == 0.0f)
+        return quat();
+    float inverse = 1.0f / length;
+    return quat(q.X * inverse, q.Y * inverse, q.Z * inverse, q.W * inverse);
+}
+
+quat Slerp(const quat& a, const quat& b, float t)
+{
+    float cosine = a.X * b.X + a.Y * b.Y + a.Z * b.Z + a.W * b.W;
+    quat end = b;
+    if (cosine < 0.0f)
+    {
+        cosine = -cosine;
+        end = quat(-b.X, -b.Y, -b.Z, -b.W);
+    }
+
+    float wa, wb;
+    if (cosine > 0.9995f)
+    {
+        //Nearly parallel, a normalized lerp is as good and doesn't divide by ~0
+        wa = 1.0f - t;
+        wb = t;
+    }
+    else
+    {
+        float angle = std::acos(cosine);
+        float inverseSine = 1.0f / std::sin(angle);
+        wa = std::sin((1.0f - t) * angle) * inverseSine;
+        wb = std::sin(t * angle) * inverseSine;
+    }
+    return Normalize(quat(a.X * wa + end.X * wb, a.Y * wa + end.Y * wb, a.Z * wa + end.Z * wb, a.W * wa + end.W * wb));
+}
+
+vec3 Rotate(const quat& q, const vec3& v)
+{
+    vec3 axis(q.X, q.Y, q.Z);
+    vec3 t = Cross(axis, v) * 2.0f;
+    return v + t * q.W + Cross(axis, t);
+}
+
+mat3 RotationMatrix3(const quat& q)
+{
+    float xx = q.X * q.X, yy = q.Y * q.Y, zz = q.Z * q.Z;
+    float xy = q.X * q.Y, xz = q.X * q.Z, yz = q.Y * q.Z;
+    float wx = q.W * q.X, wy = q.W * q.Y, wz = q.W * q.Z;
+    return mat3(vec3(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy)),
+                vec3(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx)),
+                vec3(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy)));
+}
+
+mat4 RotationMatrix(const quat& q)
+{
+    mat3 rotation = RotationMatrix3(q);
+    return mat4(vec4(rotation.Columns[0], 0.0f), vec4(rotation.Columns[1], 0.0f), vec4(rotation.Columns[2], 0.0f),
+                vec4(0.0f, 0.0f, 0.0f, 1.0f));
+}
+
+mat4 Compose(const vec3& translation, const quat& rotation, const vec3& scale)
+{
+    mat3 r = RotationMatrix3(rotation);
+    return mat4(vec4(r.Columns[0] * scale.X, 0.0f), vec4(r.Columns[1] * scale.Y, 0.0f), vec4(r.Columns[2] * scale.Z, 0.0f),
+                vec4(translation, 1.0f));
+}
+
+aabb TransformAABB(const mat4& m, const aabb& box)
+{
+    //The new extent along each axis is the old one through the absolute matrix
+    vec3 center = TransformPoint(m, box.GetCenter());
+    vec3 extents = box.GetExtents();
+    vec3 newExtents;
+    for (int r = 0; r < 3; r++)
+        newExtents[r] = std::fabs(m.Columns[0][r]) * extents.X + std::fabs(m.Columns[1][r]) * extents.Y +
+                        std::fabs(m.Columns[2][r]) * extents.Z;
+    return { center - newExtents, center + newExtents };
+}
+
+#ifdef __AVX2__
+static inline __m256 MulAdd(__m256 a, __m256 b, __m256 c)
+{
+#ifdef __FMA__
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+#endif
+
+#ifdef SIMD_MATH_SSE
+static inline __m128 MulAdd(__m128 a, __m128 b, __m128 c)
+{
+#ifdef __FMA__
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+#endif
+
+template<bool WithW>
+static void TransformPointsImpl(const mat4& m, const float* x, const float* y, const float* z,
+                                float* outX, float* outY, float* outZ, float* outW, size_t count)
+{
+    const int rows = WithW ? 4 : 3;
+    float* out[4] = { outX, outY, outZ, outW };
+    size_t i = 0;
+
+#ifdef __AVX2__
+    {
+        __m256 columns[4][4];
+        for (int c = 0; c < 4; c++)
+            for (int r = 0; r < rows; r++)
+                columns[c][r] = _mm256_set1_ps(m.Columns[c][r]);
+
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256 px = _mm256_loadu_ps(x + i), py = _mm256_loadu_ps(y + i), pz = _mm256_loadu_ps(z + i);
+            for (int r = 0; r < rows; r++)
+            {
+                __m256 value = MulAdd(pz, columns[2][r], columns[3][r]);
+                value = MulAdd(py, columns[1][r], value);
+                _mm256_storeu_ps(out[r] + i, MulAdd(px, columns[0][r], value));
+            }
+        }
+    }
+#endif
+#ifdef SIMD_MATH_SSE
+    {
+        __m128 columns[4][4];
+        for (int c = 0; c < 4; c++)
+            for (int r = 0; r < rows; r++)
+                columns[c][r] = _mm_set1_ps(m.Columns[c][r]);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i), pz = _mm_loadu_ps(z + i);
+            for (int r = 0; r < rows; r++)
+            {
+                __m128 value = MulAdd(pz, columns[2][r], columns[3][r]);
+                value = MulAdd(py, columns[1][r], value);
+                _mm_storeu_ps(out[r] + i, MulAdd(px, columns[0][r], value));
+            }
+        }
+    }
+#endif
+    for (; i < count; i++)
+    {
+        float px = x[i], py = y[i], pz = z[i];
+        for (int r = 0; r < rows; r++)
+            out[r][i] = m.Columns[0][r] * px + m.Columns[1][r] * py + m.Columns[2][r] * pz + m.Columns[3][r];
+    }
+}
+
+void TransformPoints(const mat4& m, const float* x, const float* y, const float* z,
+                     float* outX, float* outY, float* outZ, size_t count)
+{
+    TransformPointsImpl<false>(m, x, y, z, outX, outY, outZ, nullptr, count);
+}
+
+void TransformPoints(const mat4& m, const float* x, const float* y, const float* z,
+                     float* outX, float* outY, float* outZ, float* outW, size_t count)
+{
+    TransformPointsImpl<true>(m, x, y, z, outX, outY, outZ, outW, count);
+}
+
+#ifdef __AVX2__
+//Two result columns per 256 bit register: each half of b's column pair is
+//broadcast in place, so a's columns are loaded once into both halves
+static inline void MultiplyColumnPairs(const __m256 a[4], const mat4& b, mat4& out)
+{
+    __m256 b01 = _mm256_loadu_ps(&b.Columns[0].X);
+    __m256 b23 = _mm256_loadu_ps(&b.Columns[2].X);
+
+    __m256 r01 = _mm256_mul_ps(a[0], _mm256_permute_ps(b01, 0x00));
+    r01 = MulAdd(a[1], _mm256_permute_ps(b01, 0x55), r01);
+    r01 = MulAdd(a[2], _mm256_permute_ps(b01, 0xAA), r01);
+    r01 = MulAdd(a[3], _mm256_permute_ps(b01, 0xFF), r01);
+
+    __m256 r23 = _mm256_mul_ps(a[0], _mm256_permute_ps(b23, 0x00));
+    r23 = MulAdd(a[1], _mm256_permute_ps(b23, 0x55), r23);
+    r23 = MulAdd(a[2], _mm256_permute_ps(b23, 0xAA), r23);
+    r23 = MulAdd(a[3], _mm256_permute_ps(b23, 0xFF), r23);
+
+    _mm256_storeu_ps(&out.Columns[0].X, r01);
+    _mm256_storeu_ps(&out.Columns[2].X, r23);
+}
+
+static inline void BroadcastColumns(const mat4& m, __m256 columns[4])
+{
+    for (int c = 0; c < 4; c++)
+        columns[c] = _mm256_broadcast_ps((const __m128*)&m.Columns[c].X);
+}
+#endif
+
+void MultiplyMatrices(const mat4* a, const unsigned int* aIndices, const mat4* b, mat4* out, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+#ifdef __AVX2__
+        __m256 columns[4];
+        BroadcastColumns(a[aIndices[i]], columns);
+        MultiplyColumnPairs(columns, b[i], out[i]);
+#else
+        out[i] = a[aIndices[i]] * b[i];
+#endif
+    }
+}
+
+void TransformAABBs(const mat4* matrices, const aabb* boxes, aabb* out, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+#ifdef SIMD_MATH_SSE
+        const mat4& m = matrices[i];
+        const aabb& box = boxes[i];
+        vec3 center = box.GetCenter();
+        vec3 extents = box.GetExtents();
+
+        const __m128 signMask = _mm_set1_ps(-0.0f);
+        __m128 newCenter = LoadVec4(m.Columns[3]);
+        __m128 newExtents = _mm_setzero_ps();
+        for (int c = 0; c < 3; c++)
+        {
+            __m128 column = LoadVec4(m.Columns[c]);
+            newCenter = MulAdd(column, _mm_set1_ps(center[c]), newCenter);
+            newExtents = MulAdd(_mm_andnot_ps(signMask, column), _mm_set1_ps(extents[c]), newExtents);
+        }
+
+        alignas(16) float low[4], high[4];
+        _mm_store_ps(low, _mm_sub_ps(newCenter, newExtents));
+        _mm_store_ps(high, _mm_add_ps(newCenter, newExtents));
+        out[i] = { vec3(low[0], low[1], low[2]), vec3(high[0], high[1], high[2]) };
+#else
+        out[i] = TransformAABB(matrices[i], boxes[i]);
+#endif
+    }
+}
\ No newline at end of file
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+//SSE2 is always there on x86-64; anything else gets the scalar code
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_MATH_SSE
+#include <immintrin.h>
+#endif
+
+//Vectors, matrices, quaternions and boxes for the CPU side: transforms, culling,
+//picking. Matrices are column major and act on column vectors like GLSL, so they
+//go to glUniformMatrix4fv untransposed, and a * b applies b first. Projections
+//follow GL clip space, z in [-w, w].
+//
+//vec4 and mat4 use SSE where available; vec2 and vec3 stay scalar, padding them
+//to 4 floats would cost more memory traffic than the arithmetic saves. For many
+//points or matrices at once use the batch functions at the bottom.
+
+struct vec2
+{
+	float X, Y;
+
+	vec2() : X(0.0f), Y(0.0f) {}
+	vec2(float x, float y) : X(x), Y(y) {}
+};
+
+inline vec2 operator+(const vec2& a, const vec2& b) { return vec2(a.X + b.X, a.Y + b.Y); }
+inline vec2 operator-(const vec2& a, const vec2& b) { return vec2(a.X - b.X, a.Y - b.Y); }
+inline vec2 operator*(const vec2& a, float s) { return vec2(a.X * s, a.Y * s); }
+inline float Dot(const vec2& a, const vec2& b) { return a.X * b.X + a.Y * b.Y; }
+inline float Length(const vec2& v) { return std::sqrt(Dot(v, v)); }
+
+struct vec3
+{
+	float X, Y, Z;
+
+	vec3() : X(0.0f), Y(0.0f), Z(0.0f) {}
+	vec3(float x, float y, float z) : X(x), Y(y), Z(z) {}
+
+	inline float operator[](int i) const { return (&X)[i]; }
+	inline float& operator[](int i) { return (&X)[i]; }
+};
+
+inline vec3 operator+(const vec3& a, const vec3& b) { return vec3(a.X + b.X, a.Y + b.Y, a.Z + b.Z); }
+inline vec3 operator-(const vec3& a, const vec3& b) { return vec3(a.X - b.X, a.Y - b.Y, a.Z - b.Z); }
+inline vec3 operator-(const vec3& v) { return vec3(-v.X, -v.Y, -v.Z); }
+inline vec3 operator*(const vec3& a, const vec3& b) { return vec3(a.X * b.X, a.Y * b.Y, a.Z * b.Z); }
+inline vec3 operator*(const vec3& a, float s) { return vec3(a.X * s, a.Y * s, a.Z * s); }
+inline float Dot(const vec3& a, const vec3& b) { return a.X * b.X + a.Y * b.Y + a.Z * b.Z; }
+inline vec3 Cross(const vec3& a, const vec3& b) { return vec3(a.Y * b.Z - a.Z * b.Y, a.Z * b.X - a.X * b.Z, a.X * b.Y - a.Y * b.X); }
+inline float Length(const vec3& v) { return std::sqrt(Dot(v, v)); }
+inline vec3 Normalize(const vec3& v) { float length = Length(v); return length > 0.0f ? v * (1.0f / length) : v; }
+inline vec3 Min(const vec3& a, const vec3& b) { return vec3(std::fmin(a.X, b.X), std::fmin(a.Y, b.Y), std::fmin(a.Z, b.Z)); }
+inline vec3 Max(const vec3& a, const vec3& b) { return vec3(std::fmax(a.X, b.X), std::fmax(a.Y, b.Y), std::fmax(a.Z, b.Z)); }
+
+struct alignas(16) vec4
+{
+	float X, Y, Z, W;
+
+	vec4() : X(0.0f), Y(0.0f), Z(0.0f), W(0.0f) {}
+	vec4(float x, float y, float z, float w) : X(x), Y(y), Z(z), W(w) {}
+	vec4(const vec3& v, float w) : X(v.X), Y(v.Y), Z(v.Z), W(w) {}
+
+	inline vec3 XYZ() const { return vec3(X, Y, Z); }
+	inline float operator[](int i) const { return (&X)[i]; }
+	inline float& operator[](int i) { return (&X)[i]; }
+};
+
+#ifdef SIMD_MATH_SSE
+inline __m128 LoadVec4(const vec4& v) { return _mm_load_ps(&v.X); }
+inline vec4 StoreVec4(__m128 v) { vec4 result; _mm_store_ps(&result.X, v); return result; }
+
+inline vec4 operator+(const vec4& a, const vec4& b) { return StoreVec4(_mm_add_ps(LoadVec4(a), LoadVec4(b))); }
+inline vec4 operator-(const vec4& a, const vec4& b) { return StoreVec4(_mm_sub_ps(LoadVec4(a), LoadVec4(b))); }
+inline vec4 operator*(const vec4& a, const vec4& b) { return StoreVec4(_mm_mul_ps(LoadVec4(a), LoadVec4(b))); }
+inline vec4 operator*(const vec4& a, float s) { return StoreVec4(_mm_mul_ps(LoadVec4(a), _mm_set1_ps(s))); }
+#else
+inline vec4 operator+(const vec4& a, const vec4& b) { return vec4(a.X + b.X, a.Y + b.Y, a.Z + b.Z, a.W + b.W); }
+inline vec4 operator-(const vec4& a, const vec4& b) { return vec4(a.X - b.X, a.Y - b.Y, a.Z - b.Z, a.W - b.W); }
+inline vec4 operator*(const vec4& a, const vec4& b) { return vec4(a.X * b.X, a.Y * b.Y, a.Z * b.Z, a.W * b.W); }
+inline vec4 operator*(const vec4& a, float s) { return vec4(a.X * s, a.Y * s, a.Z * s, a.W * s); }
+#endif
+inline float Dot(const vec4& a, const vec4& b) { return a.X * b.X + a.Y * b.Y + a.Z * b.Z + a.W * b.W; }
+
+//Rotation and scale only, for normals and bounding box axes
+struct mat3
+{
+	vec3 Columns[3];
+
+	mat3() : Columns{ vec3(1.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f), vec3(0.0f, 0.0f, 1.0f) } {}
+	mat3(const vec3& c0, const vec3& c1, const vec3& c2) : Columns{ c0, c1, c2 } {}
+};
+
+inline vec3 operator*(const mat3& m, const vec3& v)
+{
+	return m.Columns[0] * v.X + m.Columns[1] * v.Y + m.Columns[2] * v.Z;
+}
+
+inline mat3 operator*(const mat3& a, const mat3& b)
+{
+	return mat3(a * b.Columns[0], a * b.Columns[1], a * b.Columns[2]);
+}
+
+mat3 Transpose(const mat3& m);
+//Returns the identity for a singular matrix
+mat3 Inverse(const mat3& m);
+
+struct alignas(16) mat4
+{
+	vec4 Columns[4];
+
+	//Identity
+	mat4() : Columns{ vec4(1.0f, 0.0f, 0.0f, 0.0f), vec4(0.0f, 1.0f, 0.0f, 0.0f), vec4(0.0f, 0.0f, 1.0f, 0.0f), vec4(0.0f, 0.0f, 0.0f, 1.0f) } {}
+	mat4(const vec4& c0, const vec4& c1, const vec4& c2, const vec4& c3) : Columns{ c0, c1, c2, c3 } {}
+
+	inline const float* GetData() const { return &Columns[0].X; }
+	inline vec3 GetTranslation() const { return Columns[3].XYZ(); }
+};
+
+inline vec4 operator*(const mat4& m, const vec4& v)
+{
+#ifdef SIMD_MATH_SSE
+	__m128 result = _mm_mul_ps(LoadVec4(m.Columns[0]), _mm_set1_ps(v.X));
+	result = _mm_add_ps(result, _mm_mul_ps(LoadVec4(m.Columns[1]), _mm_set1_ps(v.Y)));
+	result = _mm_add_ps(result, _mm_mul_ps(LoadVec4(m.Columns[2]), _mm_set1_ps(v.Z)));
+	result = _mm_add_ps(result, _mm_mul_ps(LoadVec4(m.Columns[3]), _mm_set1_ps(v.W)));
+	return StoreVec4(result);
+#else
+	return m.Columns[0] * v.X + m.Columns[1] * v.Y + m.Columns[2] * v.Z + m.Columns[3] * v.W;
+#endif
+}
+
+inline mat4 operator*(const mat4& a, const mat4& b)
+{
+	return mat4(a * b.Columns[0], a * b.Columns[1], a * b.Columns[2], a * b.Columns[3]);
+}
+
+//Point (w = 1) and direction (w = 0) through an affine matrix
+inline vec3 TransformPoint(const mat4& m, const vec3& p) { return (m * vec4(p, 1.0f)).XYZ(); }
+inline vec3 TransformVector(const mat4& m, const vec3& v) { return (m * vec4(v, 0.0f)).XYZ(); }
+
+inline mat3 ToMat3(const mat4& m) { return mat3(m.Columns[0].XYZ(), m.Columns[1].XYZ(), m.Columns[2].XYZ()); }
+
+mat4 Transpose(const mat4& m);
+//General inverse, returns the identity for a singular matrix
+mat4 Inverse(const mat4& m);
+//Cheaper inverse for rotation / scale / translation matrices
+mat4 InverseAffine(const mat4& m);
+
+mat4 Translation(const vec3& offset);
+mat4 Scaling(const vec3& scale);
+//Field of view in radians
+mat4 Perspective(float fovY, float aspect, float zNear, float zFar);
+mat4 Orthographic(float left, float right, float bottom, float top, float zNear, float zFar);
+//View matrix looking down -Z, like gluLookAt
+mat4 LookAt(const vec3& eye, const vec3& target, const vec3& up);
+
+//Unit quaternion for rotations, W is the real part
+struct quat
+{
+	float X, Y, Z, W;
+
+	quat() : X(0.0f), Y(0.0f), Z(0.0f), W(1.0f) {}
+	quat(float x, float y, float z, float w) : X(x), Y(y), Z(z), W(w) {}
+};
+
+//Applies b first
+inline quat operator*(const quat& a, const quat& b)
+{
+	return quat(a.W * b.X + a.X * b.W + a.Y * b.Z - a.Z * b.Y,
+	            a.W * b.Y - a.X * b.Z + a.Y * b.W + a.Z * b.X,
+	            a.W * b.Z + a.X * b.Y - a.Y * b.X + a.Z * b.W,
+	            a.W * b.W - a.X * b.X - a.Y * b.Y - a.Z * b.Z);
+}
+
+inline quat Conjugate(const quat& q) { return quat(-q.X, -q.Y, -q.Z, q.W); }
+
+//Angle in radians, counter-clockwise looking down the axis
+quat AxisAngle(const vec3& axis, float angle);
+quat Normalize(const quat& q);
+//Shortest path, t in [0, 1]
+quat Slerp(const quat& a, const quat& b, float t);
+vec3 Rotate(const quat& q, const vec3& v);
+mat3 RotationMatrix3(const quat& q);
+mat4 RotationMatrix(const quat& q);
+
+//Scale, then rotate, then translate: the usual local transform of an object
+mat4 Compose(const vec3& translation, const quat& rotation, const vec3& scale);
+
+struct aabb
+{
+	vec3 Min;
+	vec3 Max;
+
+	inline vec3 GetCenter() const { return (Min + Max) * 0.5f; }
+	inline vec3 GetExtents() const { return (Max - Min) * 0.5f; }
+	inline bool IsEmpty() const { return Min.X > Max.X || Min.Y > Max.Y || Min.Z > Max.Z; }
+};
+
+//Min above Max, so that Union with anything gives that thing
+inline aabb EmptyAABB() { return { vec3(INFINITY, INFINITY, INFINITY), vec3(-INFINITY, -INFINITY, -INFINITY) }; }
+inline aabb Union(const aabb& a, const aabb& b) { return { Min(a.Min, b.Min), Max(a.Max, b.Max) }; }
+inline aabb Union(const aabb& a, const vec3& p) { return { Min(a.Min, p), Max(a.Max, p) }; }
+inline bool Contains(const aabb& box, const vec3& p)
+{
+	return p.X >= box.Min.X && p.X <= box.Max.X && p.Y >= box.Min.Y && p.Y <= box.Max.Y && p.Z >= box.Min.Z && p.Z <= box.Max.Z;
+}
+inline bool Intersects(const aabb& a, const aabb& b)
+{
+	return a.Min.X <= b.Max.X && a.Max.X >= b.Min.X && a.Min.Y <= b.Max.Y && a.Max.Y >= b.Min.Y && a.Min.Z <= b.Max.Z && a.Max.Z >= b.Min.Z;
+}
+inline float SurfaceArea(const aabb& box)
+{
+	vec3 size = box.Max - box.Min;
+	return 2.0f * (size.X * size.Y + size.Y * size.Z + size.Z * size.X);
+}
+
+//Box around the transformed corners of box, from its center and extents
+aabb TransformAABB(const mat4& m, const aabb& box);
+
+//Batch kernels. TransformPoints takes structure-of-arrays coordinates, 8 points
+//per AVX2 iteration (4 with SSE), scalar for the remainder. MultiplyMatrices and
+//TransformAABBs walk arrays of mat4 and aabb one element per iteration: a product
+//fills two result columns per AVX2 register (one per SSE register), a box is one
+//SSE register each for its center and extents. Inputs and outputs may alias
+//exactly (in place) but must not partially overlap.
+
+//Points with w = 1 through an affine matrix, out = m * (x, y, z, 1)
+void TransformPoints(const mat4& m, const float* x, const float* y, const float* z,
+                     float* outX, float* outY, float* outZ, size_t count);
+
+//Full projective transform, out = m * (x, y, z, 1) with the w kept, e.g. to clip space
+void TransformPoints(const mat4& m, const float* x, const float* y, const float* z,
+                     float* outX, float* outY, float* outZ, float* outW, size_t count);
+
+//out[i] = a[aIndices[i]] * b[i], e.g. parents' world matrices times local ones
+void MultiplyMatrices(const mat4* a, const unsigned int* aIndices, const mat4* b, mat4* out, size_t count);
+
+//out[i] = TransformAABB(matrices[i], boxes[i]), boxes must not be empty
+void TransformAABBs(const mat4* matrices, const aabb* boxes, aabb* out, size_t count);
\ No newline at end of file
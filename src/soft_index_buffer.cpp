@@ -0,0 +1,7 @@
+#include "soft_index_buffer.h"
+
+
+soft_index_buffer::soft_index_buffer(const unsigned int* data, unsigned int count)
+    : m_Indices(data, data + count)
+{
+}
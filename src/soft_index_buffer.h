@@ -0,0 +1,16 @@
+#pragma once
+
+#include <vector>
+
+//CPU side counterpart of index_buffer for soft_rasterizer
+class soft_index_buffer
+{
+private:
+	std::vector<unsigned int> m_Indices;
+
+public:
+	soft_index_buffer(const unsigned int* data, unsigned int count);
+
+	inline const unsigned int* GetData() const { return m_Indices.data(); }
+	inline unsigned int GetCount() const { return (unsigned int)m_Indices.size(); }
+};
\ No newline at end of file
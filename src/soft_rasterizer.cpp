@@ -0,0 +1,290 @@
+#include "soft_rasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+//Keep every multiply and add rounded on its own. Contracting them into fused
+//multiply-adds (GCC does by default with -mfma) picks different pairs in the
+//AVX2 and scalar loops and would change pixels between builds.
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#elif defined(_MSC_VER)
+#pragma fp_contract(off)
+#endif
+
+
+//Snapped coordinates stay within +-2^22 sixteenths of a pixel, so an edge
+//function's step across 8 pixels fits in 30 bits and a block can be tested in
+//int32 lanes once its starting value is clamped to +-2^30
+static const float guardBand = 4194304.0f;
+static const int64_t edgeClamp = 1 << 30;
+
+static int64_t SnapToSubpixel(float ndc, int size)
+{
+    float window = (ndc * 0.5f + 0.5f) * (float)size * 16.0f;
+    window = std::min(std::max(window, -guardBand), guardBand);
+    return (int64_t)std::lrint(window);
+}
+
+static uint32_t PackColor(float r, float g, float b, float a)
+{
+    auto toByte = [](float v)
+    {
+        return (uint32_t)(std::min(std::max(v, 0.0f), 1.0f) * 255.0f + 0.5f);
+    };
+    return toByte(r) | (toByte(g) << 8) | (toByte(b) << 16) | (toByte(a) << 24);
+}
+
+soft_rasterizer::soft_rasterizer(int width, int height, job_system* jobs)
+    : m_Width(std::max(width, 1)), m_Height(std::max(height, 1)), m_Jobs(jobs), m_TriangleCount(0)
+{
+    m_Stride = (m_Width + 7) & ~7;
+    m_TilesX = (m_Width + tileSize - 1) / tileSize;
+    m_TilesY = (m_Height + tileSize - 1) / tileSize;
+    m_Pixels.resize((size_t)m_Stride * m_Height);
+    m_Bins.resize((size_t)m_TilesX * m_TilesY);
+}
+
+void soft_rasterizer::Clear(float r, float g, float b, float a)
+{
+    std::fill(m_Pixels.begin(), m_Pixels.end(), PackColor(r, g, b, a));
+}
+
+void soft_rasterizer::SetupTriangles(const unsigned int* indices, unsigned int indexCount)
+{
+    const unsigned int triangleCount = indexCount / 3;
+    m_Triangles.resize(triangleCount);
+
+    For(triangleCount, 256, [&](unsigned int index)
+    {
+        triangle& t = m_Triangles[index];
+        t.Visible = false;
+
+        int64_t x[3], y[3];
+        for (int i = 0; i < 3; i++)
+        {
+            t.Vertices[i] = indices[index * 3 + i];
+            if (t.Vertices[i] >= m_Vertices.size())
+                return;
+
+            const float* position = m_Vertices[t.Vertices[i]].Position;
+            if (!(position[3] > 0.0f))
+                return;
+            x[i] = SnapToSubpixel(position[0] / position[3], m_Width);
+            y[i] = SnapToSubpixel(position[1] / position[3], m_Height);
+        }
+
+        //Twice the signed area, positive for counter-clockwise; clockwise
+        //triangles are turned around since nothing is culled
+        int64_t area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+        if (area == 0)
+            return;
+        if (area < 0)
+        {
+            std::swap(x[1], x[2]);
+            std::swap(y[1], y[2]);
+            std::swap(t.Vertices[1], t.Vertices[2]);
+            area = -area;
+        }
+
+        int64_t minX = std::min({ x[0], x[1], x[2] });
+        int64_t maxX = std::max({ x[0], x[1], x[2] });
+        int64_t minY = std::min({ y[0], y[1], y[2] });
+        int64_t maxY = std::max({ y[0], y[1], y[2] });
+        //Pixels whose center (16 * p + 8) lies within the bounds
+        t.MinX = (int)std::max<int64_t>((minX + 7) >> 4, 0);
+        t.MaxX = (int)std::min<int64_t>((maxX - 8) >> 4, m_Width - 1);
+        t.MinY = (int)std::max<int64_t>((minY + 7) >> 4, 0);
+        t.MaxY = (int)std::min<int64_t>((maxY - 8) >> 4, m_Height - 1);
+        if (t.MinX > t.MaxX || t.MinY > t.MaxY)
+            return;
+
+        for (int i = 0; i < 3; i++)
+        {
+            int a = (i + 1) % 3;
+            int b = (i + 2) % 3;
+            int64_t dx = x[b] - x[a];
+            int64_t dy = y[b] - y[a];
+            t.A[i] = -dy;
+            t.B[i] = dx;
+            t.C[i] = x[a] * y[b] - x[b] * y[a];
+            //Top-left rule: a pixel center exactly on an edge belongs to one side only
+            if (!(dy < 0 || (dy == 0 && dx > 0)))
+                t.C[i] -= 1;
+        }
+        t.InvArea = 1.0 / (double)area;
+        t.Visible = true;
+    });
+
+    //Binned serially so every tile sees its triangles in submission order
+    for (std::vector<unsigned int>& bin : m_Bins)
+        bin.clear();
+    for (unsigned int index = 0; index < triangleCount; index++)
+    {
+        const triangle& t = m_Triangles[index];
+        if (!t.Visible)
+            continue;
+
+        m_TriangleCount++;
+        for (int ty = t.MinY / tileSize; ty <= t.MaxY / tileSize; ty++)
+            for (int tx = t.MinX / tileSize; tx <= t.MaxX / tileSize; tx++)
+                m_Bins[(size_t)ty * m_TilesX + tx].push_back(index);
+    }
+}
+
+void soft_rasterizer::RasterizeTile(unsigned int tile, fragment_function shade, const void* shader, unsigned int varyingCount)
+{
+    const int tileX = (int)(tile % m_TilesX) * tileSize;
+    const int tileY = (int)(tile / m_TilesX) * tileSize;
+    const int tileMaxX = std::min(tileX + tileSize, m_Width) - 1;
+    const int tileMaxY = std::min(tileY + tileSize, m_Height) - 1;
+
+    soft_fragments fragments;
+#ifdef __AVX2__
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256 laneOffsets = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+#endif
+
+    for (unsigned int index : m_Bins[tile])
+    {
+        const triangle& t = m_Triangles[index];
+        const int minX = std::max(t.MinX, tileX) & ~7; //tiles and rows start 8-aligned
+        const int maxX = std::min(t.MaxX, tileMaxX);
+        const int minY = std::max(t.MinY, tileY);
+        const int maxY = std::min(t.MaxY, tileMaxY);
+
+        const soft_vertex* vertices[3];
+        float baryStep[3];
+        for (int i = 0; i < 3; i++)
+        {
+            vertices[i] = &m_Vertices[t.Vertices[i]];
+            baryStep[i] = (float)((double)(t.A[i] * 16) * t.InvArea);
+        }
+
+#ifdef __AVX2__
+        __m256i edgeSteps[3];
+        for (int i = 0; i < 3; i++)
+            edgeSteps[i] = _mm256_mullo_epi32(lanes, _mm256_set1_epi32((int)(t.A[i] * 16)));
+#endif
+
+        for (int y = minY; y <= maxY; y++)
+        {
+            uint32_t* row = &m_Pixels[(size_t)y * m_Stride];
+            const int64_t sampleY = (int64_t)y * 16 + 8;
+
+            int64_t edges[3];
+            for (int i = 0; i < 3; i++)
+                edges[i] = t.A[i] * ((int64_t)minX * 16 + 8) + t.B[i] * sampleY + t.C[i];
+
+            for (int x = minX; x <= maxX; x += 8)
+            {
+#ifdef __AVX2__
+                //A lane is covered when no edge function is negative
+                __m256i outside = _mm256_cmpgt_epi32(lanes, _mm256_set1_epi32(maxX - x));
+                for (int i = 0; i < 3; i++)
+                {
+                    int start = (int)std::min(std::max(edges[i], -edgeClamp), edgeClamp);
+                    outside = _mm256_or_si256(outside, _mm256_add_epi32(_mm256_set1_epi32(start), edgeSteps[i]));
+                }
+                __m256i covered = _mm256_xor_si256(_mm256_srai_epi32(outside, 31), _mm256_set1_epi32(-1));
+                if (_mm256_testz_si256(covered, covered))
+                {
+                    for (int i = 0; i < 3; i++)
+                        edges[i] += t.A[i] * 128;
+                    continue;
+                }
+
+                fragments.X.Value = _mm256_add_ps(_mm256_set1_ps((float)x + 0.5f), laneOffsets);
+                fragments.Y.Value = _mm256_set1_ps((float)y + 0.5f);
+                if (varyingCount)
+                {
+                    __m256 bary[3];
+                    for (int i = 0; i < 3; i++)
+                        bary[i] = _mm256_add_ps(_mm256_set1_ps((float)((double)edges[i] * t.InvArea)),
+                                                _mm256_mul_ps(laneOffsets, _mm256_set1_ps(baryStep[i])));
+                    for (unsigned int v = 0; v < varyingCount; v++)
+                    {
+                        __m256 value = _mm256_mul_ps(bary[0], _mm256_set1_ps(vertices[0]->Varyings[v]));
+                        value = _mm256_add_ps(value, _mm256_mul_ps(bary[1], _mm256_set1_ps(vertices[1]->Varyings[v])));
+                        value = _mm256_add_ps(value, _mm256_mul_ps(bary[2], _mm256_set1_ps(vertices[2]->Varyings[v])));
+                        fragments.Varyings[v].Value = value;
+                    }
+                }
+
+                soft_color color = shade(shader, fragments);
+
+                const __m256 zero = _mm256_setzero_ps();
+                const __m256 one = _mm256_set1_ps(1.0f);
+                const __m256 scale = _mm256_set1_ps(255.0f);
+                const __m256 half = _mm256_set1_ps(0.5f);
+                auto toBytes = [&](__m256 v)
+                {
+                    v = _mm256_min_ps(_mm256_max_ps(v, zero), one);
+                    return _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(v, scale), half));
+                };
+                __m256i packed = toBytes(color.R.Value);
+                packed = _mm256_or_si256(packed, _mm256_slli_epi32(toBytes(color.G.Value), 8));
+                packed = _mm256_or_si256(packed, _mm256_slli_epi32(toBytes(color.B.Value), 16));
+                packed = _mm256_or_si256(packed, _mm256_slli_epi32(toBytes(color.A.Value), 24));
+                _mm256_maskstore_epi32((int*)(row + x), covered, packed);
+#else
+                bool covered[8];
+                bool any = false;
+                for (int lane = 0; lane < 8; lane++)
+                {
+                    covered[lane] = x + lane <= maxX;
+                    for (int i = 0; i < 3; i++)
+                        covered[lane] = covered[lane] && edges[i] + t.A[i] * 16 * lane >= 0;
+                    any = any || covered[lane];
+                }
+                if (!any)
+                {
+                    for (int i = 0; i < 3; i++)
+                        edges[i] += t.A[i] * 128;
+                    continue;
+                }
+
+                for (int lane = 0; lane < 8; lane++)
+                {
+                    fragments.X.Value[lane] = (float)x + 0.5f + (float)lane;
+                    fragments.Y.Value[lane] = (float)y + 0.5f;
+                }
+                if (varyingCount)
+                {
+                    float bary[3][8];
+                    for (int i = 0; i < 3; i++)
+                    {
+                        float start = (float)((double)edges[i] * t.InvArea);
+                        for (int lane = 0; lane < 8; lane++)
+                            bary[i][lane] = start + (float)lane * baryStep[i];
+                    }
+                    for (unsigned int v = 0; v < varyingCount; v++)
+                        for (int lane = 0; lane < 8; lane++)
+                            fragments.Varyings[v].Value[lane] = bary[0][lane] * vertices[0]->Varyings[v] +
+                                                                bary[1][lane] * vertices[1]->Varyings[v] +
+                                                                bary[2][lane] * vertices[2]->Varyings[v];
+                }
+
+                soft_color color = shade(shader, fragments);
+                for (int lane = 0; lane < 8; lane++)
+                {
+                    if (covered[lane])
+                        row[x + lane] = PackColor(color.R.Value[lane], color.G.Value[lane], color.B.Value[lane], color.A.Value[lane]);
+                }
+#endif
+                for (int i = 0; i < 3; i++)
+                    edges[i] += t.A[i] * 128;
+            }
+        }
+    }
+}
+
+void soft_rasterizer::ReadPixels(unsigned char* rgba) const
+{
+    for (int y = 0; y < m_Height; y++)
+        std::memcpy(rgba + (size_t)y * m_Width * 4, &m_Pixels[(size_t)y * m_Stride], (size_t)m_Width * 4);
+}
\ No newline at end of file
@@ -0,0 +1,187 @@
+#pragma once
+
+#include "soft_index_buffer.h"
+#include "soft_vertex_buffer.h"
+#include "vertex_buffer_layout.h"
+#include "job_system.h"
+
+#include <cstdint>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+static const unsigned int softMaxVaryings = 4;
+
+//Eight values of one fragment input or output, one per pixel of a block. AVX2
+//when the compiler targets it, plain loops otherwise; both give the same coverage.
+struct soft_float8
+{
+#ifdef __AVX2__
+	__m256 Value;
+#else
+	float Value[8];
+#endif
+
+	static inline soft_float8 Broadcast(float x)
+	{
+		soft_float8 result;
+#ifdef __AVX2__
+		result.Value = _mm256_set1_ps(x);
+#else
+		for (int i = 0; i < 8; i++)
+			result.Value[i] = x;
+#endif
+		return result;
+	}
+
+	inline float operator[](int lane) const
+	{
+#ifdef __AVX2__
+		alignas(32) float values[8];
+		_mm256_store_ps(values, Value);
+		return values[lane];
+#else
+		return Value[lane];
+#endif
+	}
+};
+
+#ifdef __AVX2__
+inline soft_float8 operator+(soft_float8 a, soft_float8 b) { return { _mm256_add_ps(a.Value, b.Value) }; }
+inline soft_float8 operator-(soft_float8 a, soft_float8 b) { return { _mm256_sub_ps(a.Value, b.Value) }; }
+inline soft_float8 operator*(soft_float8 a, soft_float8 b) { return { _mm256_mul_ps(a.Value, b.Value) }; }
+#else
+inline soft_float8 operator+(soft_float8 a, soft_float8 b) { for (int i = 0; i < 8; i++) a.Value[i] += b.Value[i]; return a; }
+inline soft_float8 operator-(soft_float8 a, soft_float8 b) { for (int i = 0; i < 8; i++) a.Value[i] -= b.Value[i]; return a; }
+inline soft_float8 operator*(soft_float8 a, soft_float8 b) { for (int i = 0; i < 8; i++) a.Value[i] *= b.Value[i]; return a; }
+#endif
+
+//What a vertex functor writes: clip space position like gl_Position, plus the
+//varyings to interpolate across the triangle
+struct soft_vertex
+{
+	float Position[4];
+	float Varyings[softMaxVaryings];
+};
+
+//Inputs of a fragment functor for a block of 8 pixels on one row. X and Y are
+//window coordinates of the pixel centers, like gl_FragCoord.
+struct soft_fragments
+{
+	soft_float8 X;
+	soft_float8 Y;
+	soft_float8 Varyings[softMaxVaryings];
+};
+
+//Fragment functor output, components in [0, 1]
+struct soft_color
+{
+	soft_float8 R, G, B, A;
+};
+
+//CPU counterpart of renderer + shader_program for the triangle lists the tree
+//draws, meant as a deterministic reference: the same draws always give the same
+//pixels whatever the thread count or instruction set.
+//
+//Shaders are functors with
+//	static const unsigned int varyingCount;
+//	void Vertex(const unsigned char* vertex, soft_vertex& out) const;
+//	soft_color Fragment(const soft_fragments& in) const;
+//see soft_shaders.h. Positions snap to 1/16 pixel and coverage follows the
+//top-left rule with integer edge functions, so shared edges are drawn exactly
+//once. Varyings are interpolated linearly in screen space. Like the GL state the
+//tree uses there is no depth test, blending or clipping: triangles with a vertex
+//behind the camera (w <= 0) are dropped. soft_rasterizer.cpp turns off
+//floating-point contraction to keep the AVX2 and scalar paths equal; shaders that
+//do arithmetic of their own need -ffp-contract=off for the same guarantee.
+//
+//The framebuffer is split in 64x64 tiles. Each Draw shades vertices and sets up
+//triangles in parallel, bins triangles into tiles in submission order, then
+//rasterizes the tiles in parallel 8 pixels at a time.
+class soft_rasterizer
+{
+public:
+	static const int tileSize = 64;
+
+private:
+	struct triangle
+	{
+		int MinX, MinY, MaxX, MaxY; //covered pixels, inclusive, clipped to the framebuffer
+		int64_t A[3], B[3], C[3];   //edge i, opposite vertex i: E = A*x + B*y + C in 1/16 pixels
+		double InvArea;
+		unsigned int Vertices[3];
+		bool Visible;
+	};
+
+	typedef soft_color(*fragment_function)(const void* shader, const soft_fragments& in);
+
+	int m_Width;
+	int m_Height;
+	int m_Stride; //pixels per row, a multiple of 8
+	int m_TilesX;
+	int m_TilesY;
+	std::vector<uint32_t> m_Pixels; //RGBA8, bottom row first like GL
+	job_system* m_Jobs;
+
+	std::vector<soft_vertex> m_Vertices;
+	std::vector<triangle> m_Triangles;
+	std::vector<std::vector<unsigned int>> m_Bins;
+	unsigned long long m_TriangleCount;
+
+	template<typename Function>
+	void For(unsigned int count, unsigned int grainSize, const Function& fn)
+	{
+		if (m_Jobs)
+			m_Jobs->ParallelFor(count, grainSize, fn);
+		else
+			for (unsigned int i = 0; i < count; i++)
+				fn(i);
+	}
+
+	void SetupTriangles(const unsigned int* indices, unsigned int indexCount);
+	void RasterizeTile(unsigned int tile, fragment_function shade, const void* shader, unsigned int varyingCount);
+
+public:
+	//Without a job system everything runs on the calling thread
+	soft_rasterizer(int width, int height, job_system* jobs = nullptr);
+
+	void Clear(float r, float g, float b, float a);
+
+	template<typename Shader>
+	void Draw(const soft_vertex_buffer& vb, const vertex_buffer_layout& layout, const soft_index_buffer& ib, const Shader& shader)
+	{
+		static_assert(Shader::varyingCount <= softMaxVaryings, "Too many varyings");
+
+		const unsigned int stride = layout.GetStride();
+		const unsigned int vertexCount = stride ? vb.GetSize() / stride : 0;
+		const unsigned char* data = vb.GetData();
+
+		m_Vertices.resize(vertexCount);
+		For(vertexCount, 256, [&](unsigned int i)
+		{
+			shader.Vertex(data + (size_t)i * stride, m_Vertices[i]);
+		});
+
+		SetupTriangles(ib.GetData(), ib.GetCount());
+
+		fragment_function shade = [](const void* s, const soft_fragments& in)
+		{
+			return static_cast<const Shader*>(s)->Fragment(in);
+		};
+		For((unsigned int)m_Bins.size(), 1, [&](unsigned int tile)
+		{
+			RasterizeTile(tile, shade, &shader, Shader::varyingCount);
+		});
+	}
+
+	//Copies the framebuffer, tightly packed and bottom row first like glReadPixels
+	//with GL_RGBA / GL_UNSIGNED_BYTE
+	void ReadPixels(unsigned char* rgba) const;
+
+	inline int GetWidth() const { return m_Width; }
+	inline int GetHeight() const { return m_Height; }
+	//Triangles that survived setup since construction
+	inline unsigned long long GetTriangleCount() const { return m_TriangleCount; }
+};
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "soft_rasterizer.h"
+
+//soft_rasterizer counterpart of res/shaders/basic.shader: the 2D position
+//attribute goes straight to clip space and every fragment gets u_Color
+struct soft_basic_shader
+{
+	static const unsigned int varyingCount = 0;
+
+	float Color[4]; //u_Color
+
+	inline void Vertex(const unsigned char* vertex, soft_vertex& out) const
+	{
+		const float* position = reinterpret_cast<const float*>(vertex);
+		out.Position[0] = position[0];
+		out.Position[1] = position[1];
+		out.Position[2] = 0.0f;
+		out.Position[3] = 1.0f;
+	}
+
+	inline soft_color Fragment(const soft_fragments&) const
+	{
+		return { soft_float8::Broadcast(Color[0]), soft_float8::Broadcast(Color[1]),
+		         soft_float8::Broadcast(Color[2]), soft_float8::Broadcast(Color[3]) };
+	}
+};
+
+//Position plus a per vertex RGBA color, interpolated across the triangle
+struct soft_vertex_color_shader
+{
+	static const unsigned int varyingCount = 4;
+
+	inline void Vertex(const unsigned char* vertex, soft_vertex& out) const
+	{
+		const float* attributes = reinterpret_cast<const float*>(vertex);
+		out.Position[0] = attributes[0];
+		out.Position[1] = attributes[1];
+		out.Position[2] = 0.0f;
+		out.Position[3] = 1.0f;
+		for (unsigned int i = 0; i < varyingCount; i++)
+			out.Varyings[i] = attributes[2 + i];
+	}
+
+	inline soft_color Fragment(const soft_fragments& in) const
+	{
+		return { in.Varyings[0], in.Varyings[1], in.Varyings[2], in.Varyings[3] };
+	}
+};
\ No newline at end of file
@@ -0,0 +1,13 @@
+#include "soft_vertex_buffer.h"
+
+
+soft_vertex_buffer::soft_vertex_buffer(const void* data, unsigned int size)
+{
+    Stream(data, size);
+}
+
+void soft_vertex_buffer::Stream(const void* data, unsigned int size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    m_Data.assign(bytes, bytes + size);
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <vector>
+
+//CPU side counterpart of vertex_buffer for soft_rasterizer, the bytes are simply kept
+class soft_vertex_buffer
+{
+private:
+	std::vector<unsigned char> m_Data;
+
+public:
+	soft_vertex_buffer(const void* data, unsigned int size);
+
+	//Replaces the contents, like vertex_buffer::Stream
+	void Stream(const void* data, unsigned int size);
+
+	inline const unsigned char* GetData() const { return m_Data.data(); }
+	inline unsigned int GetSize() const { return (unsigned int)m_Data.size(); }
+};
\ No newline at end of file
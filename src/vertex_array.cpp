@@ -0,0 +1,60 @@
+#include "vertex_array.h"
+
+#include "renderer.h"
+#include "vertex_buffer.h"
+#include "vertex_buffer_layout.h"
+
+
+vertex_array::vertex_array()
+    : m_AttributeCount(0)
+{
+    GLCall(glGenVertexArrays(1, &m_RendererID));
+}
+
+vertex_array::~vertex_array()
+{
+    GLCall(glDeleteVertexArrays(1, &m_RendererID));
+}
+
+void vertex_array::AddBuffer(const vertex_buffer& vb, const vertex_buffer_layout& layout)
+{
+    bind();
+    vb.bind();
+
+    size_t offset = 0;
+    for (const vertex_buffer_element& element : layout.GetElements())
+    {
+        unsigned int index = m_AttributeCount++;
+        GLCall(glEnableVertexAttribArray(index));
+
+        //Reminder, stide is the total byte size accross all attributes
+        if (element.Type == GL_FLOAT || element.Normalized)
+        {
+            GLCall(glVertexAttribPointer(index, element.Count, element.Type, element.Normalized,
+                                         layout.GetStride(), (const void*)offset));
+        }
+        else
+        {
+            GLCall(glVertexAttribIPointer(index, element.Count, element.Type,
+                                          layout.GetStride(), (const void*)offset));
+        }
+
+        //Per-instance attributes only advance every 'Divisor' instances
+        if (element.Divisor)
+        {
+            GLCall(glVertexAttribDivisor(index, element.Divisor));
+        }
+
+        offset += element.Count * vertex_buffer_element::GetSizeOfType(element.Type);
+    }
+}
+
+void vertex_array::bind() const
+{
+    GLCall(glBindVertexArray(m_RendererID));
+}
+
+void vertex_array::unbind() const
+{
+    GLCall(glBindVertexArray(0));
+}
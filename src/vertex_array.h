@@ -0,0 +1,25 @@
+#pragma once
+
+class vertex_buffer;
+class vertex_buffer_layout;
+
+class vertex_array
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_AttributeCount;
+
+public:
+	vertex_array();
+	~vertex_array();
+
+	//Attributes continue after those of previously added buffers, so a per-vertex
+	//buffer and a per-instance buffer can be added one after the other
+	void AddBuffer(const vertex_buffer& vb, const vertex_buffer_layout& layout);
+
+	void bind() const;
+
+	void unbind() const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+};
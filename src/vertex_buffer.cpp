@@ -4,6 +4,7 @@
 
 
 vertex_buffer::vertex_buffer(const void* data, unsigned int size)
+    : m_Capacity(size)
 {
     GLCall(glGenBuffers(1, &m_RendererID));  //Gen Buffer
     GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));  //Bind Buffer
@@ -15,11 +16,32 @@ vertex_buffer::vertex_buffer(const void* data, unsigned int size)
                         GL_STATIC_DRAW));       //usage
 }
 
+vertex_buffer::vertex_buffer(unsigned int capacity)
+    : m_Capacity(capacity)
+{
+    GLCall(glGenBuffers(1, &m_RendererID));  //Gen Buffer
+    GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));  //Bind Buffer
+
+    GLCall(glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_STREAM_DRAW));
+}
+
 vertex_buffer::~vertex_buffer()
 {
     GLCall(glDeleteBuffers(1, &m_RendererID));
 }
 
+void vertex_buffer::Stream(const void* data, unsigned int size)
+{
+    GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));  //Bind Buffer
+
+    if (size > m_Capacity)
+        m_Capacity = size;
+
+    //Orphan then fill: the old storage lives on until the GPU is done with it
+    GLCall(glBufferData(GL_ARRAY_BUFFER, m_Capacity, nullptr, GL_STREAM_DRAW));
+    GLCall(glBufferSubData(GL_ARRAY_BUFFER, 0, size, data));
+}
+
 void vertex_buffer::bind() const
 {
     GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));  //Bind Buffer
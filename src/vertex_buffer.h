@@ -4,13 +4,22 @@ class vertex_buffer
 {
 private:
 	unsigned int m_RendererID;
+	unsigned int m_Capacity;
 
 public:
 	vertex_buffer(const void* data, unsigned int size);
+
+	//Empty streaming buffer, filled every frame through Stream
+	explicit vertex_buffer(unsigned int capacity);
 	~vertex_buffer();
 
+	//Replaces the contents, orphaning the old storage so the driver doesn't have
+	//to wait for draws still reading it. Grows the buffer if size exceeds capacity.
+	void Stream(const void* data, unsigned int size);
+
 	void bind() const;
 
 	void unbind() const;
 
-};
\ No newline at end of file
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+};
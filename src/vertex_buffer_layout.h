@@ -0,0 +1,57 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <type_traits>
+#include <vector>
+
+struct vertex_buffer_element
+{
+	unsigned int Type;
+	unsigned int Count;
+	unsigned char Normalized;
+	unsigned int Divisor; //0 = per vertex, N = advances once every N instances
+
+	static unsigned int GetSizeOfType(unsigned int type)
+	{
+		switch (type)
+		{
+		case GL_FLOAT:         return 4;
+		case GL_UNSIGNED_INT:  return 4;
+		case GL_UNSIGNED_BYTE: return 1;
+		}
+		return 0;
+	}
+};
+
+//Describes how consecutive attributes are packed in one vertex buffer
+class vertex_buffer_layout
+{
+private:
+	std::vector<vertex_buffer_element> m_Elements;
+	unsigned int m_Stride;
+
+public:
+	vertex_buffer_layout()
+		: m_Stride(0) {}
+
+	//Pass a divisor to make the attribute per instance instead of per vertex
+	template<typename T>
+	void Push(unsigned int count, unsigned int divisor = 0)
+	{
+		static_assert(std::is_same<T, float>::value || std::is_same<T, unsigned int>::value ||
+		              std::is_same<T, unsigned char>::value, "Unsupported vertex attribute type");
+
+		if (std::is_same<T, float>::value)
+			m_Elements.push_back({ GL_FLOAT, count, GL_FALSE, divisor });
+		else if (std::is_same<T, unsigned int>::value)
+			m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE, divisor });
+		else
+			m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE, divisor });
+
+		m_Stride += count * sizeof(T);
+	}
+
+	inline const std::vector<vertex_buffer_element>& GetElements() const { return m_Elements; }
+	inline unsigned int GetStride() const { return m_Stride; }
+};
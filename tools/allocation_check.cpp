@@ -0,0 +1,178 @@
+//Checks that steady-state frames don't touch the heap. Runs the work of an app
+//frame on a surfaceless EGL context: a scene graph with every 16th node moving,
+//Update, bvh Refit, culling and Submit on a job_system, plus a block of quads
+//recorded on every thread with parallel_recorder and uniforms staged in the
+//frame_arena, then renderer::Execute and glFinish. Allocations are counted per
+//frame, and after the warm-up frames any frame that allocates is reported and
+//the exit code is 1. Build with the sources under src/ (minus application.cpp)
+//and TRACK_ALLOCATIONS defined, against GLEW compiled with GLEW_EGL, and link
+//libEGL.
+//
+//    allocation_check [<frames> <nodes>]
+//
+//Defaults: 100 frames after 3 warm-up frames, 10000 nodes, 2000 quads.
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "egl_context.h"
+#include "renderer.h"
+#include "vertex_buffer.h"
+#include "vertex_buffer_layout.h"
+#include "vertex_array.h"
+#include "index_buffer.h"
+#include "command_list.h"
+#include "shader_program.h"
+#include "embedded_shaders.h"
+#include "allocation_tracker.h"
+#include "job_system.h"
+#include "frame_arena.h"
+#include "parallel_recorder.h"
+#include "scene_graph.h"
+#include "frustum_culler.h"
+#include "bvh.h"
+
+static const int width = 256;
+static const int height = 256;
+//The first frames may still grow command lists and sort buffers to their final size
+static const unsigned int warmupFrames = 3;
+static const unsigned int quadCount = 2000;
+
+int main(int argc, char** argv)
+{
+    unsigned int frames = argc > 1 ? (unsigned int)atoi(argv[1]) : 100;
+    unsigned int nodeCount = argc > 2 ? (unsigned int)atoi(argv[2]) : 10000;
+    if (frames == 0 || nodeCount == 0 || argc > 3)
+    {
+        std::cout << "usage: allocation_check [<frames> <nodes>]" << std::endl;
+        return 1;
+    }
+
+    //Without TRACK_ALLOCATIONS every count is 0 and the check would pass regardless
+    {
+        allocation_scope probe;
+        int* volatile value = new int(0);
+        delete value;
+        if (probe.GetCount() == 0)
+        {
+            std::cout << "[Allocation] Not counting, build with TRACK_ALLOCATIONS" << std::endl;
+            return 1;
+        }
+    }
+
+    EGLDisplay display;
+    EGLContext context = EGL_NO_CONTEXT;
+    if (!CreateContext("[Allocation]", display, context))
+        return 1;
+
+    unsigned int allocatingFrames = 0;
+    {
+        float square[] = { -0.5f, -0.5f, 0.5f, -0.5f, 0.5f, 0.5f, -0.5f, 0.5f };
+        unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+        vertex_array va;
+        vertex_buffer vb(square, sizeof(square));
+        vertex_buffer_layout layout;
+        layout.Push<float>(2);
+        va.AddBuffer(vb, layout);
+        index_buffer ib(indices, 6);
+
+        static constexpr shader_sections sceneSections = ParseShaderSections(scene_shader);
+        unsigned int shader = createShader(ToProgramSource(sceneSections));
+        scene_uniforms uniforms = GetSceneUniforms(shader);
+
+        unsigned int framebuffer, colorBuffer;
+        GLCall(glGenFramebuffers(1, &framebuffer));
+        GLCall(glGenRenderbuffers(1, &colorBuffer));
+        GLCall(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+        GLCall(glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer));
+        GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height));
+        GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer));
+        ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+        GLCall(glViewport(0, 0, width, height));
+
+        job_system jobs;
+        //Any one thread may end up recording every quad
+        frame_arena arena(jobs, quadCount * 5 * sizeof(draw_uniform));
+        parallel_recorder recorder(jobs, arena);
+        recorder.Reserve(quadCount, quadCount * 5);
+
+        //Four children per node, each a smaller copy offset from its parent
+        scene_graph scene(&jobs);
+        scene.Reserve(nodeCount);
+        unsigned int mesh = scene.AddMesh({ va.GetRendererID(), &ib });
+        const aabb bounds = { vec3(-0.5f, -0.5f, 0.0f), vec3(0.5f, 0.5f, 0.0f) };
+        std::vector<scene_node> nodes(nodeCount);
+        for (unsigned int i = 0; i < nodeCount; i++)
+        {
+            scene_node parent = i == 0 ? invalidSceneNode : nodes[(i - 1) / 4];
+            vec3 offset(i % 2 ? 0.6f : -0.6f, i % 4 < 2 ? 0.6f : -0.6f, 0.0f);
+            nodes[i] = scene.Add(parent, Compose(i ? offset : vec3(), quat(), vec3(0.5f, 0.5f, 1.0f)), bounds, mesh,
+                                 vec4(0.2f + 0.6f * (i % 3) / 2.0f, 0.5f, 0.8f, 1.0f));
+        }
+        scene.Update();
+
+        const mat4 viewProjection = Orthographic(-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f);
+        const frustum view = ExtractFrustum(viewProjection);
+        frustum_culler culler(&jobs);
+        bvh tree(&jobs);
+        tree.Build(scene.GetWorldBounds(), scene.GetCount());
+
+        renderer glRenderer;
+        command_list list;
+        const vec3 zAxis(0.0f, 0.0f, 1.0f);
+        const uint64_t key = renderer::MakeSortKey(1, 0, 0, 0.0f);
+        size_t arenaPeak = 0;
+        for (unsigned int frame = 0; frame < warmupFrames + frames; frame++)
+        {
+            allocation_scope frameAllocations;
+
+            list.Clear();
+            for (unsigned int i = 1; i < nodeCount; i += 16)
+                scene.SetLocal(nodes[i], vec3(), AxisAngle(zAxis, 0.01f * frame), vec3(0.5f, 0.5f, 1.0f));
+            scene.Update();
+            tree.Refit(scene.GetWorldBounds());
+            culler.Cull(view, scene.GetWorldBounds(), scene.GetCount());
+            scene.Submit(list, viewProjection, shader, uniforms, culler.GetVisible(), culler.GetVisibleCount());
+
+            //Uniforms are staged in the recording thread's arena, the list copies them
+            recorder.Record(quadCount, 0, [&](unsigned int i, command_list& threadList, linear_allocator& scratch)
+            {
+                draw_uniform* quad = scratch.Allocate<draw_uniform>(5);
+                float x = (i % 50) / 25.0f - 1.0f, y = (i / 50) / 20.0f - 1.0f;
+                quad[0] = { uniforms.Transform[0], { 0.02f, 0.0f, 0.0f, 0.0f } };
+                quad[1] = { uniforms.Transform[1], { 0.0f, 0.02f, 0.0f, 0.0f } };
+                quad[2] = { uniforms.Transform[2], { 0.0f, 0.0f, 1.0f, 0.0f } };
+                quad[3] = { uniforms.Transform[3], { x, y, 0.0f, 1.0f } };
+                quad[4] = { uniforms.Color, { 1.0f, 1.0f, 1.0f, 1.0f } };
+                threadList.Submit(key + i, shader, va.GetRendererID(), ib, quad, 5);
+            });
+            recorder.MergeInto(list);
+
+            glRenderer.Clear();
+            glRenderer.Execute(list);
+            GLCall(glFinish());
+            arenaPeak = std::max(arenaPeak, arena.GetPeakUsage());
+            arena.Reset();
+
+            if (frame >= warmupFrames && frameAllocations.GetCount() != 0)
+            {
+                std::cout << "[Frame " << frame << "] " << frameAllocations.GetCount() << " heap allocations" << std::endl;
+                allocatingFrames++;
+            }
+        }
+
+        std::cout << frames << " frames of " << nodeCount << " nodes and " << quadCount << " quads on "
+            << jobs.GetThreadCount() << " threads, " << list.GetCommands().size() << " draws, frame arena peak "
+            << arenaPeak << " bytes: " << allocatingFrames << " frames allocated" << std::endl;
+
+        GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+        GLCall(glDeleteRenderbuffers(1, &colorBuffer));
+        GLCall(glDeleteFramebuffers(1, &framebuffer));
+        GLCall(glDeleteProgram(shader));
+    }
+
+    DestroyContext(display, context);
+    return allocatingFrames == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,324 @@
+//Headless batch renderer: renders every image of a scene file across K independent
+//GL contexts, one thread each, and writes them out through frame_encoder. Contexts
+//are EGL surfaceless, so no window system is needed; with Mesa, setting
+//LIBGL_ALWAYS_SOFTWARE=1 runs everything on llvmpipe. Build with the sources under
+//src/ (minus application.cpp), against GLEW compiled with GLEW_EGL, and link libEGL.
+//
+//    batch_render <scene file> <contexts> <output pattern> [qoi|png]
+//
+//The output pattern gets the image's index in the scene file ("out/thumb_%05llu.png").
+//Scene files list images, each followed by its quads (unit squares, scaled):
+//
+//    image <width> <height> <camera x> <camera y> <zoom> [<background r> <g> <b> <a>]
+//    quad <x> <y> <width> <height> <r> <g> <b> <a>
+//
+//Run with 1, 2, 4... contexts to see how throughput scales; the totals are printed at the end.
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "egl_context.h"
+#include "renderer.h"
+#include "vertex_buffer.h"
+#include "vertex_buffer_layout.h"
+#include "vertex_array.h"
+#include "index_buffer.h"
+#include "command_list.h"
+#include "shader_program.h"
+#include "embedded_shaders.h"
+#include "frame_capture.h"
+#include "frame_encoder.h"
+
+//Matches the per instance attributes of res/shaders/instanced.shader
+struct quad_instance
+{
+    float Transform[4]; //xy = offset, zw = scale
+    float Color[4];
+};
+
+struct render_job
+{
+    int Width;
+    int Height;
+    float Camera[3]; //x, y, zoom
+    float Background[4];
+    unsigned int FirstQuad;
+    unsigned int QuadCount;
+};
+
+struct scene
+{
+    std::vector<render_job> Jobs;
+    std::vector<quad_instance> Quads;
+};
+
+struct context_stats
+{
+    unsigned int Images = 0;
+    double Seconds = 0.0;
+};
+
+static const unsigned int captureRing = 3;
+
+static bool LoadScene(const std::string& filepath, scene& out)
+{
+    std::ifstream stream(filepath);
+    if (!stream)
+    {
+        std::cout << "[Batch] Could not open " << filepath << std::endl;
+        return false;
+    }
+
+    std::string line;
+    unsigned int lineNumber = 0;
+    while (getline(stream, line))
+    {
+        lineNumber++;
+        std::istringstream words(line);
+        std::string kind;
+        if (!(words >> kind) || kind[0] == '#')
+            continue;
+
+        if (kind == "image")
+        {
+            render_job job = { 0, 0, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 0.0f, 1.0f }, (unsigned int)out.Quads.size(), 0 };
+            words >> job.Width >> job.Height >> job.Camera[0] >> job.Camera[1] >> job.Camera[2];
+            if (!words || job.Width <= 0 || job.Height <= 0)
+            {
+                std::cout << "[Batch] " << filepath << ":" << lineNumber << ": bad image line" << std::endl;
+                return false;
+            }
+            words >> job.Background[0] >> job.Background[1] >> job.Background[2] >> job.Background[3];
+            out.Jobs.push_back(job);
+        }
+        else if (kind == "quad" && !out.Jobs.empty())
+        {
+            quad_instance quad;
+            words >> quad.Transform[0] >> quad.Transform[1] >> quad.Transform[2] >> quad.Transform[3]
+                  >> quad.Color[0] >> quad.Color[1] >> quad.Color[2] >> quad.Color[3];
+            if (!words)
+            {
+                std::cout << "[Batch] " << filepath << ":" << lineNumber << ": bad quad line" << std::endl;
+                return false;
+            }
+            out.Quads.push_back(quad);
+            out.Jobs.back().QuadCount++;
+        }
+        else
+        {
+            std::cout << "[Batch] " << filepath << ":" << lineNumber << ": unexpected '" << kind << "'" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+//Hands a finished readback to the encoder under the index of the job it belongs to
+static void SubmitReadback(frame_capture& capture, const unsigned int* pendingJobs, frame_encoder& encoder, bool wait)
+{
+    captured_frame frame;
+    while (capture.Map(frame, wait))
+    {
+        frame.Index = pendingJobs[frame.Index % captureRing];
+        encoder.Submit(frame);
+        capture.Unmap();
+    }
+}
+
+static void RenderJobs(EGLDisplay display, EGLConfig config, const scene& work, std::atomic<unsigned int>& nextJob,
+                       frame_encoder& encoder, context_stats& stats)
+{
+    EGLContext context = CreateSurfacelessContext("[Batch]", display, config);
+    if (context == EGL_NO_CONTEXT)
+        return;
+
+    //Entry points are the same for every context, load them once
+    static std::once_flag glewLoaded;
+    static bool glewReady = false;
+    std::call_once(glewLoaded, [] {
+        glewReady = LoadGL("[Batch]");
+        if (glewReady)
+            std::cout << glGetString(GL_RENDERER) << ", " << glGetString(GL_VERSION) << std::endl;
+    });
+
+    if (glewReady)
+    {
+        //Everything GL lives in this scope so it is deleted while the context is still current
+        float positions[] = {
+            -0.5f, -0.5f,
+             0.5f, -0.5f,
+             0.5f,  0.5f,
+            -0.5f,  0.5f,
+        };
+        unsigned int indices[] = {
+            0, 1, 2,
+            2, 3, 0
+        };
+
+        vertex_array va;
+        vertex_buffer vb(positions, 4 * 2 * sizeof(float));
+        vertex_buffer_layout layout;
+        layout.Push<float>(2);
+        va.AddBuffer(vb, layout);
+
+        vertex_buffer instances(256 * sizeof(quad_instance));
+        vertex_buffer_layout instanceLayout;
+        instanceLayout.Push<float>(4, 1);
+        instanceLayout.Push<float>(4, 1);
+        va.AddBuffer(instances, instanceLayout);
+
+        index_buffer ib(indices, 6);
+
+        static constexpr shader_sections instancedSections = ParseShaderSections(instanced_shader);
+        unsigned int shader = createShader(ToProgramSource(instancedSections));
+
+        unsigned int framebuffer, colorBuffer;
+        int framebufferWidth = 0, framebufferHeight = 0;
+        GLCall(glGenFramebuffers(1, &framebuffer));
+        GLCall(glGenRenderbuffers(1, &colorBuffer));
+        GLCall(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+        GLCall(glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer));
+
+        renderer jobRenderer;
+        command_list list;
+        std::vector<quad_instance> staging;
+
+        frame_capture capture(captureRing);
+        unsigned int pendingJobs[captureRing];
+        unsigned long long captures = 0;
+
+        auto begin = std::chrono::steady_clock::now();
+        for (unsigned int jobIndex = nextJob++; jobIndex < work.Jobs.size(); jobIndex = nextJob++)
+        {
+            const render_job& job = work.Jobs[jobIndex];
+
+            if (job.Width != framebufferWidth || job.Height != framebufferHeight)
+            {
+                GLCall(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+                GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, job.Width, job.Height));
+                GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer));
+                ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+                framebufferWidth = job.Width;
+                framebufferHeight = job.Height;
+            }
+
+            //Camera applied on the CPU, it is just an offset and a zoom
+            staging.resize(job.QuadCount);
+            for (unsigned int i = 0; i < job.QuadCount; i++)
+            {
+                const quad_instance& quad = work.Quads[job.FirstQuad + i];
+                quad_instance& placed = staging[i];
+                placed.Transform[0] = (quad.Transform[0] - job.Camera[0]) * job.Camera[2];
+                placed.Transform[1] = (quad.Transform[1] - job.Camera[1]) * job.Camera[2];
+                placed.Transform[2] = quad.Transform[2] * job.Camera[2];
+                placed.Transform[3] = quad.Transform[3] * job.Camera[2];
+                for (int c = 0; c < 4; c++)
+                    placed.Color[c] = quad.Color[c];
+            }
+
+            GLCall(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+            GLCall(glViewport(0, 0, job.Width, job.Height));
+            GLCall(glClearColor(job.Background[0], job.Background[1], job.Background[2], job.Background[3]));
+            jobRenderer.Clear();
+
+            if (job.QuadCount > 0)
+            {
+                instances.Stream(staging.data(), job.QuadCount * sizeof(quad_instance));
+                list.SubmitInstanced(renderer::MakeSortKey(0, shader, 0, 0.0f), shader, va.GetRendererID(), ib,
+                                     job.QuadCount);
+                jobRenderer.Execute(list);
+                list.Clear();
+            }
+
+            //Keep the readback ring moving: wait only when every buffer is still in flight
+            if (capture.GetInFlight() == captureRing)
+                SubmitReadback(capture, pendingJobs, encoder, true);
+            pendingJobs[captures++ % captureRing] = jobIndex;
+            capture.Capture(job.Width, job.Height, framebuffer);
+            SubmitReadback(capture, pendingJobs, encoder, false);
+
+            stats.Images++;
+        }
+        SubmitReadback(capture, pendingJobs, encoder, true);
+        stats.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+        GLCall(glDeleteRenderbuffers(1, &colorBuffer));
+        GLCall(glDeleteFramebuffers(1, &framebuffer));
+        GLCall(glDeleteProgram(shader));
+    }
+
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display, context);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 4)
+    {
+        std::cout << "usage: batch_render <scene file> <contexts> <output pattern> [qoi|png]" << std::endl;
+        return 1;
+    }
+
+    scene work;
+    if (!LoadScene(argv[1], work))
+        return 1;
+
+    unsigned int contextCount = (unsigned int)atoi(argv[2]);
+    if (contextCount == 0)
+        contextCount = 1;
+    image_format format = argc > 4 && std::string(argv[4]) == "qoi" ? image_format::QOI : image_format::PNG;
+
+    EGLDisplay display;
+    EGLConfig config;
+    if (!OpenDisplay("[Batch]", display, config))
+        return 1;
+
+    std::vector<context_stats> stats(contextCount);
+    unsigned long long failed = 0;
+    auto begin = std::chrono::steady_clock::now();
+    {
+        //Declared before the render threads so it outlives them, and flushes on destruction
+        frame_encoder encoder(format, argv[3]);
+        if (!encoder.IsOpen())
+        {
+            eglTerminate(display);
+            return 1;
+        }
+        std::atomic<unsigned int> nextJob(0);
+
+        std::vector<std::thread> threads;
+        for (unsigned int i = 0; i < contextCount; i++)
+            threads.emplace_back(RenderJobs, display, config, std::cref(work), std::ref(nextJob), std::ref(encoder),
+                                 std::ref(stats[i]));
+        for (std::thread& thread : threads)
+            thread.join();
+        //Images only count once they are on disk
+        encoder.Flush();
+        failed = encoder.GetFailedCount();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    unsigned int images = 0;
+    for (unsigned int i = 0; i < contextCount; i++)
+    {
+        std::cout << "Context " << i << ": " << stats[i].Images << " images in " << stats[i].Seconds << " s" << std::endl;
+        images += stats[i].Images;
+    }
+    if (failed)
+        std::cout << "[Batch] " << failed << " images could not be written" << std::endl;
+    unsigned long long written = images - failed;
+    std::cout << written << " images written from " << contextCount << " contexts in " << seconds << " s, "
+        << written / seconds << " images/s" << std::endl;
+
+    eglTerminate(display);
+    return images == work.Jobs.size() && failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,195 @@
+//Benchmark of the bvh: build, full and partial refit, frustum culling against the
+//flat frustum_culler and ray picking against testing every box, on random boxes
+//clustered like objects in a level. Culling results are compared with the flat
+//culler's and ray hits with the brute force ones. Build with src/bvh.cpp,
+//src/frustum_culler.cpp, src/simd_math.cpp and src/job_system.cpp, ideally with
+//-mavx2 -mfma.
+//
+//    bvh_benchmark [<boxes> <threads>]
+//
+//Defaults: 500000 boxes, one thread per hardware thread.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bvh.h"
+#include "job_system.h"
+#include "timing.h"
+
+static const unsigned int repeats = 10;
+static const unsigned int rayCount = 100000;
+//Rays also checked against every box, which is slow
+static const unsigned int checkedRays = 200;
+
+struct box_set
+{
+    std::vector<float> Components[6];
+
+    inline scene_bounds GetBounds() const
+    {
+        return { Components[0].data(), Components[1].data(), Components[2].data(),
+                 Components[3].data(), Components[4].data(), Components[5].data() };
+    }
+    inline aabb Get(unsigned int i) const
+    {
+        return { vec3(Components[0][i], Components[1][i], Components[2][i]), vec3(Components[3][i], Components[4][i], Components[5][i]) };
+    }
+    inline void Set(unsigned int i, const aabb& box)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            Components[axis][i] = box.Min[axis];
+            Components[3 + axis][i] = box.Max[axis];
+        }
+    }
+};
+
+//Closest box the ray enters, by testing all of them
+static float BruteForceRaycast(const box_set& boxes, unsigned int count, const ray& r)
+{
+    float best = INFINITY;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        aabb box = boxes.Get(i);
+        if (box.IsEmpty())
+            continue;
+        float enter = 0.0f, exit = INFINITY;
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float a = (box.Min[axis] - r.Origin[axis]) / r.Direction[axis];
+            float b = (box.Max[axis] - r.Origin[axis]) / r.Direction[axis];
+            enter = std::max(enter, std::min(a, b));
+            exit = std::min(exit, std::max(a, b));
+        }
+        if (enter <= exit)
+            best = std::min(best, enter);
+    }
+    return best;
+}
+
+static void Run(const char* name, const box_set& source, unsigned int count, job_system* jobs)
+{
+    box_set boxes = source;
+    bvh tree(jobs);
+    double build = Time(3, [&] { tree.Build(boxes.GetBounds(), count); });
+    std::cout << name << ": build " << build << " ms, " << tree.GetNodeCount() << " nodes, depth " << tree.GetDepth()
+        << ", SAH cost " << tree.GetCost() << std::endl;
+
+    double refit = Time(repeats, [&] { tree.Refit(boxes.GetBounds()); });
+
+    //1% of the boxes drift a little, the rest stays put
+    std::mt19937 random(11);
+    std::uniform_int_distribution<unsigned int> pick(0, count - 1);
+    std::uniform_real_distribution<float> step(-0.5f, 0.5f);
+    std::vector<unsigned int> moved(std::max(1u, count / 100));
+    double partial = 1e30;
+    for (unsigned int r = 0; r < repeats; r++)
+    {
+        for (unsigned int& i : moved)
+        {
+            i = pick(random);
+            vec3 offset(step(random), step(random), step(random));
+            aabb box = boxes.Get(i);
+            boxes.Set(i, { box.Min + offset, box.Max + offset });
+        }
+        auto begin = std::chrono::steady_clock::now();
+        tree.Refit(boxes.GetBounds(), moved.data(), (unsigned int)moved.size());
+        partial = std::min(partial, Milliseconds(begin));
+    }
+    std::cout << "  refit all " << refit << " ms, " << moved.size() << " moved " << partial << " ms" << std::endl;
+
+    //A camera inside the cloud looking along it, and one far away seeing all of it
+    const mat4 projection = Perspective(1.0472f, 16.0f / 9.0f, 0.1f, 2000.0f);
+    const mat4 views[2] = { LookAt(vec3(0.0f, 0.0f, 0.0f), vec3(1.0f, 0.1f, -1.0f), vec3(0.0f, 1.0f, 0.0f)),
+                            LookAt(vec3(0.0f, 0.0f, 1400.0f), vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f)) };
+    const char* viewNames[2] = { "inside", "outside" };
+    frustum_culler flat(jobs);
+    std::vector<unsigned int> visible;
+    visible.reserve(count);
+    for (int v = 0; v < 2; v++)
+    {
+        frustum f = ExtractFrustum(projection * views[v]);
+        double flatTime = Time(repeats, [&] { flat.Cull(f, boxes.GetBounds(), count); });
+        double treeTime = Time(repeats, [&] { tree.Cull(f, visible); });
+
+        std::vector<unsigned int> sorted(visible);
+        std::sort(sorted.begin(), sorted.end());
+        bool same = sorted.size() == flat.GetVisibleCount() && std::equal(sorted.begin(), sorted.end(), flat.GetVisible());
+        std::cout << "  cull " << viewNames[v] << ": " << visible.size() << " visible, flat " << flatTime << " ms, bvh "
+            << treeTime << " ms (" << flatTime / treeTime << "x), " << (same ? "same" : "DIFFERENT") << " set" << std::endl;
+    }
+
+    //Rays from random points towards random directions
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<ray> rays(rayCount);
+    for (ray& r : rays)
+        r = { vec3(unit(random) * 500.0f, unit(random) * 500.0f, unit(random) * 500.0f),
+              Normalize(vec3(unit(random), unit(random), unit(random))) };
+
+    unsigned int hits = 0;
+    double rayTime = Time(3, [&] {
+        hits = 0;
+        for (const ray& r : rays)
+        {
+            ray_hit hit;
+            hits += tree.Raycast(r, INFINITY, hit) ? 1 : 0;
+        }
+    });
+    unsigned int wrong = 0;
+    for (unsigned int k = 0; k < checkedRays; k++)
+    {
+        ray_hit hit;
+        float expected = BruteForceRaycast(boxes, count, rays[k]);
+        float distance = tree.Raycast(rays[k], INFINITY, hit) ? hit.Distance : INFINITY;
+        if (!(std::fabs(distance - expected) <= 1e-3f * std::max(1.0f, expected)) && distance != expected)
+            wrong++;
+    }
+    std::cout << "  raycast: " << rayCount / rayTime / 1e3 << " M rays/s, " << hits << " of " << rayCount << " hit, "
+        << wrong << " of " << checkedRays << " differ from brute force" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int count = argc > 1 ? (unsigned int)atoi(argv[1]) : 500000;
+    unsigned int threads = argc > 2 ? (unsigned int)atoi(argv[2]) : 0;
+    if (count == 0)
+    {
+        std::cout << "usage: bvh_benchmark [<boxes> <threads>]" << std::endl;
+        return 1;
+    }
+
+    //Clusters of boxes of varied sizes in a 1000 unit cube, every 64th one without bounds
+    std::mt19937 random(5);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f), spread(-20.0f, 20.0f), size(0.2f, 2.0f);
+    box_set boxes;
+    for (std::vector<float>& component : boxes.Components)
+        component.resize(count);
+    vec3 cluster;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (i % 256 == 0)
+            cluster = vec3(position(random), position(random), position(random));
+        vec3 center = cluster + vec3(spread(random), spread(random), spread(random));
+        vec3 extents(size(random), size(random), size(random));
+        boxes.Set(i, i % 64 == 63 ? EmptyAABB() : aabb{ center - extents, center + extents });
+    }
+
+    std::cout << count << " boxes" << std::endl;
+    Run("1 thread", boxes, count, nullptr);
+
+    //The job system counts the calling thread among its threads, 0 workers means one per hardware thread
+    if (threads != 1)
+    {
+        job_system jobs(threads ? threads - 1 : 0);
+        std::string name = std::to_string(jobs.GetThreadCount()) + " threads";
+        Run(name.c_str(), boxes, count, &jobs);
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+//Benchmark of frustum_culler: random boxes scattered around a perspective camera,
+//culled by a plain loop over IsVisible, by CullBoxes on the calling thread and by
+//frustum_culler split across a job_system. The visible lists are compared with the
+//plain loop's. Build with src/frustum_culler.cpp, src/simd_math.cpp and
+//src/job_system.cpp, with and without -mavx2 -mfma to compare paths.
+//
+//    cull_benchmark [<boxes> <threads>]
+//
+//Defaults: 1000000 boxes, one thread per hardware thread.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "frustum_culler.h"
+#include "job_system.h"
+#include "timing.h"
+
+static const unsigned int repeats = 20;
+
+int main(int argc, char** argv)
+{
+    unsigned int count = argc > 1 ? (unsigned int)atoi(argv[1]) : 1000000;
+    unsigned int threads = argc > 2 ? (unsigned int)atoi(argv[2]) : 0;
+    if (count == 0)
+    {
+        std::cout << "usage: cull_benchmark [<boxes> <threads>]" << std::endl;
+        return 1;
+    }
+
+#ifdef __AVX2__
+    std::cout << "AVX2";
+#else
+    std::cout << "Scalar";
+#endif
+    std::cout << " kernel, " << count << " boxes, best of " << repeats << std::endl;
+
+    //Boxes in a cube around the camera, so about a tenth of them are within its 60 degree frustum,
+    //every 64th one empty like a node without bounds
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f), size(0.5f, 5.0f);
+    std::vector<float> components[6];
+    for (std::vector<float>& component : components)
+        component.resize(count);
+    std::vector<aabb> boxes(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        vec3 center(position(random), position(random), position(random));
+        vec3 extents(size(random), size(random), size(random));
+        boxes[i] = i % 64 == 63 ? EmptyAABB() : aabb{ center - extents, center + extents };
+        for (int axis = 0; axis < 3; axis++)
+        {
+            components[axis][i] = boxes[i].Min[axis];
+            components[3 + axis][i] = boxes[i].Max[axis];
+        }
+    }
+    scene_bounds bounds = { components[0].data(), components[1].data(), components[2].data(),
+                            components[3].data(), components[4].data(), components[5].data() };
+
+    const mat4 view = LookAt(vec3(0.0f, 0.0f, 0.0f), vec3(1.0f, 0.2f, -1.0f), vec3(0.0f, 1.0f, 0.0f));
+    const frustum f = ExtractFrustum(Perspective(1.0472f, 16.0f / 9.0f, 0.1f, 1000.0f) * view);
+
+    std::vector<unsigned int> expected;
+    expected.reserve(count);
+    double scalar = Time(repeats, [&] {
+        expected.clear();
+        for (unsigned int i = 0; i < count; i++)
+        {
+            if (IsVisible(f, boxes[i]))
+                expected.push_back(i);
+        }
+    });
+
+    std::vector<unsigned int> visible(count + 8);
+    unsigned int visibleCount = 0;
+    double batch = Time(repeats, [&] {
+        visibleCount = CullBoxes(f, bounds, 0, count, visible.data());
+    });
+    bool same = visibleCount == expected.size() && std::equal(expected.begin(), expected.end(), visible.begin());
+
+    std::cout << expected.size() << " visible (" << 100.0 * expected.size() / count << "%)" << std::endl;
+    std::cout << "IsVisible loop: " << scalar << " ms, " << count / scalar / 1e3 << " M boxes/s" << std::endl;
+    std::cout << "CullBoxes: " << batch << " ms, " << count / batch / 1e3 << " M boxes/s (" << scalar / batch
+        << "x), " << (same ? "same" : "DIFFERENT") << " list" << std::endl;
+
+    //The job system counts the calling thread among its threads, 0 workers means one per hardware thread
+    std::unique_ptr<job_system> jobs;
+    if (threads != 1)
+        jobs.reset(new job_system(threads ? threads - 1 : 0));
+    frustum_culler culler(jobs.get());
+    double parallel = Time(repeats, [&] {
+        culler.Cull(f, bounds, count);
+    });
+    bool parallelSame = culler.GetVisibleCount() == expected.size() &&
+                        std::equal(expected.begin(), expected.end(), culler.GetVisible());
+
+    std::cout << "frustum_culler, " << (jobs ? jobs->GetThreadCount() : 1) << " threads: " << parallel << " ms, "
+        << count / parallel / 1e3 << " M boxes/s (" << scalar / parallel << "x), "
+        << (parallelSame ? "same" : "DIFFERENT") << " list" << std::endl;
+    return same && parallelSame ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,329 @@
+//Benchmark of the GL draw paths on a surfaceless EGL context, meant for llvmpipe
+//(set LIBGL_ALWAYS_SOFTWARE=1 with Mesa) but usable on any driver. Draws the same
+//random quads as one instanced draw of instanced.shader, streaming the instance
+//buffer every frame, and as one draw per quad of scene.shader with its transform
+//and color as per-draw uniforms. Both record a command_list every frame and run
+//it through renderer. A third pass writes the quads into quad_batch, which streams
+//their vertices and draws them in batches of batch.shader, once with the textured
+//variant and once with the TEXTURED 0 one it picks for batches without
+//textures. The time to record and
+//submit and the time until glFinish returns are reported, and the pixels of the
+//final images compared with the instanced one. The draws per quad are recorded
+//again with parallel_recorder, on every thread of a job_system, and compared with
+//the ones recorded on one thread. Last, squares, triangles and
+//octagons from one mesh_pool go through indirect_batch, as one multi-draw
+//indirect where the driver has it and as its GL 3.3 fallback of one draw per
+//mesh, and the two images are compared with each other. Build with
+//the sources under src/ (minus application.cpp), against GLEW compiled with
+//GLEW_EGL, and link libEGL.
+//
+//    draw_benchmark [<quads> <frames>]
+//
+//Defaults: 100000 quads, 10 frames, at 1280x720.
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "egl_context.h"
+#include "renderer.h"
+#include "vertex_buffer.h"
+#include "vertex_buffer_layout.h"
+#include "vertex_array.h"
+#include "index_buffer.h"
+#include "command_list.h"
+#include "shader_program.h"
+#include "embedded_shaders.h"
+#include "quad_batch.h"
+#include "mesh_pool.h"
+#include "indirect_batch.h"
+#include "shader_preprocessor.h"
+#include "job_system.h"
+#include "frame_arena.h"
+#include "parallel_recorder.h"
+
+static const int width = 1280;
+static const int height = 720;
+
+//Matches the per instance attributes of res/shaders/instanced.shader
+struct quad_instance
+{
+    float Transform[4]; //xy = offset, zw = scale
+    float Color[4];
+};
+
+struct frame_times
+{
+    double Submit; //recording the list and issuing it, ms per frame
+    double Frame;  //until glFinish returns, ms per frame
+};
+
+//Renders frames of what record puts into a list, returning the times per frame; the
+//last frame's pixels are left in pixels
+template<typename Record>
+static frame_times RunFrames(unsigned int frames, const Record& record, std::vector<unsigned char>& pixels)
+{
+    renderer glRenderer;
+    command_list list;
+    double submit = 0.0, total = 0.0;
+    for (unsigned int frame = 0; frame < frames; frame++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        glRenderer.Clear();
+        list.Clear();
+        record(list);
+        glRenderer.Execute(list);
+        auto submitted = std::chrono::steady_clock::now();
+        GLCall(glFinish());
+        auto finished = std::chrono::steady_clock::now();
+        submit += std::chrono::duration<double, std::milli>(submitted - begin).count();
+        total += std::chrono::duration<double, std::milli>(finished - begin).count();
+    }
+
+    pixels.resize((size_t)width * height * 4);
+    GLCall(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data()));
+    return { submit / frames, total / frames };
+}
+
+static size_t CountDifferences(const std::vector<unsigned char>& a, const std::vector<unsigned char>& b)
+{
+    size_t differing = 0;
+    for (size_t i = 0; i < a.size(); i += 4)
+    {
+        if (a[i] != b[i] || a[i + 1] != b[i + 1] || a[i + 2] != b[i + 2])
+            differing++;
+    }
+    return differing;
+}
+
+static void Report(const char* name, const frame_times& times, unsigned int draws, unsigned int quads)
+{
+    std::cout << name << ": " << draws << " draws, submit " << times.Submit << " ms, frame " << times.Frame << " ms, "
+        << quads / times.Frame / 1e3 << " M quads/s" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int quadCount = argc > 1 ? (unsigned int)atoi(argv[1]) : 100000;
+    unsigned int frames = argc > 2 ? (unsigned int)atoi(argv[2]) : 10;
+    if (quadCount == 0 || frames == 0)
+    {
+        std::cout << "usage: draw_benchmark [<quads> <frames>]" << std::endl;
+        return 1;
+    }
+
+    //Small quads all over the screen, from a fixed seed
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> position(-1.0f, 1.0f), size(0.005f, 0.02f), unit(0.0f, 1.0f);
+    std::vector<quad_instance> quads(quadCount);
+    for (quad_instance& quad : quads)
+        quad = { { position(random), position(random), size(random), size(random) },
+                 { unit(random), unit(random), unit(random), 1.0f } };
+
+    EGLDisplay display;
+    EGLContext context = EGL_NO_CONTEXT;
+    if (!CreateContext("[Draw]", display, context))
+        return 1;
+    std::cout << glGetString(GL_RENDERER) << ", " << glGetString(GL_VERSION) << ", " << quadCount << " quads, "
+        << width << "x" << height << std::endl;
+
+    std::vector<unsigned char> instancedPixels, drawPixels, batchPixels;
+    {
+        float square[] = { -1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f };
+        unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+        vertex_buffer vb(square, sizeof(square));
+        vertex_buffer_layout layout;
+        layout.Push<float>(2);
+        index_buffer ib(indices, 6);
+
+        vertex_buffer instanceBuffer((unsigned int)(quadCount * sizeof(quad_instance)));
+        vertex_buffer_layout instanceLayout;
+        instanceLayout.Push<float>(4, 1);
+        instanceLayout.Push<float>(4, 1);
+        vertex_array instancedArray;
+        instancedArray.AddBuffer(vb, layout);
+        instancedArray.AddBuffer(instanceBuffer, instanceLayout);
+
+        vertex_array drawArray;
+        drawArray.AddBuffer(vb, layout);
+
+        static constexpr shader_sections instancedSections = ParseShaderSections(instanced_shader);
+        static constexpr shader_sections sceneSections = ParseShaderSections(scene_shader);
+        unsigned int instancedShader = createShader(ToProgramSource(instancedSections));
+        unsigned int sceneShader = createShader(ToProgramSource(sceneSections));
+        shader_preprocessor batchShaders("res/shaders/batch.shader", true);
+        unsigned int batchShader = createShader(batchShaders.GetVariant({ { "TEXTURED", "1" } }));
+        unsigned int untexturedBatchShader = createShader(batchShaders.GetVariant({ { "TEXTURED", "0" } }));
+        int transformLocation, colorLocation;
+        GLCall(transformLocation = glGetUniformLocation(sceneShader, "u_Transform"));
+        GLCall(colorLocation = glGetUniformLocation(sceneShader, "u_Color"));
+
+        unsigned int framebuffer, colorBuffer;
+        GLCall(glGenFramebuffers(1, &framebuffer));
+        GLCall(glGenRenderbuffers(1, &colorBuffer));
+        GLCall(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+        GLCall(glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer));
+        GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height));
+        GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer));
+        ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+        GLCall(glViewport(0, 0, width, height));
+        GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+        GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+
+        //Every draw gets the same key, so both paths draw the quads in the same order
+        const uint64_t key = renderer::MakeSortKey(0, 0, 0, 0.0f);
+        frame_times instanced = RunFrames(frames, [&](command_list& list)
+        {
+            instanceBuffer.Stream(quads.data(), (unsigned int)(quadCount * sizeof(quad_instance)));
+            list.SubmitInstanced(key, instancedShader, instancedArray.GetRendererID(), ib, quadCount);
+        }, instancedPixels);
+        Report("Instanced", instanced, 1, quadCount);
+
+        //The transform as the columns of a matrix for scene.shader. The quad's index goes
+        //in the depth bits, so lists recorded in any order sort back into this one.
+        auto submitQuad = [&](command_list& list, unsigned int i)
+        {
+            const quad_instance& quad = quads[i];
+            const float* t = quad.Transform;
+            draw_uniform uniforms[5] = {
+                { transformLocation,     { t[2], 0.0f, 0.0f, 0.0f } },
+                { transformLocation + 1, { 0.0f, t[3], 0.0f, 0.0f } },
+                { transformLocation + 2, { 0.0f, 0.0f, 1.0f, 0.0f } },
+                { transformLocation + 3, { t[0], t[1], 0.0f, 1.0f } },
+                { colorLocation, { quad.Color[0], quad.Color[1], quad.Color[2], quad.Color[3] } }
+            };
+            list.Submit(key + i, sceneShader, drawArray.GetRendererID(), ib, uniforms, 5);
+        };
+        frame_times draws = RunFrames(frames, [&](command_list& list)
+        {
+            for (unsigned int i = 0; i < quadCount; i++)
+                submitQuad(list, i);
+        }, drawPixels);
+        Report("Draw per quad", draws, quadCount, quadCount);
+        std::cout << "Instancing: " << draws.Frame / instanced.Frame << "x faster per frame, "
+            << CountDifferences(instancedPixels, drawPixels) << " pixels differ" << std::endl;
+
+        std::vector<unsigned char> recordedPixels;
+        {
+            job_system jobs;
+            frame_arena arena(jobs, 1 << 16);
+            parallel_recorder recorder(jobs, arena);
+            frame_times recorded = RunFrames(frames, [&](command_list& list)
+            {
+                recorder.Record(quadCount, 0, [&](unsigned int i, command_list& threadList, linear_allocator&)
+                {
+                    submitQuad(threadList, i);
+                });
+                recorder.MergeInto(list);
+                arena.Reset();
+            }, recordedPixels);
+            std::string name = "Draw per quad on " + std::to_string(jobs.GetThreadCount()) + " threads";
+            Report(name.c_str(), recorded, quadCount, quadCount);
+            std::cout << "Parallel recording: " << draws.Submit / recorded.Submit << "x faster to submit, "
+                << CountDifferences(drawPixels, recordedPixels) << " pixels differ from one thread" << std::endl;
+        }
+
+        //The batch draws right away instead of through the list, corners instead of center and half extents
+        quad_batch batch;
+        unsigned int batchDraws = 0;
+        auto batchQuads = [&](unsigned int untexturedProgram)
+        {
+            return RunFrames(frames, [&](command_list&)
+            {
+                batch.ResetStats();
+                batch.Begin(batchShader, untexturedProgram);
+                for (const quad_instance& quad : quads)
+                {
+                    const float* t = quad.Transform;
+                    batch.DrawQuad(t[0] - t[2], t[1] - t[3], t[2] * 2.0f, t[3] * 2.0f, quad.Color);
+                }
+                batch.End();
+                batchDraws = batch.GetDrawCount();
+            }, batchPixels);
+        };
+        frame_times textured = batchQuads(0);
+        Report("quad_batch, textured program", textured, batchDraws, quadCount);
+        frame_times batched = batchQuads(untexturedBatchShader);
+        Report("quad_batch", batched, batchDraws, quadCount);
+        std::cout << "Batching: " << draws.Frame / batched.Frame << "x faster per frame than a draw per quad, "
+            << textured.Frame / batched.Frame << "x faster than the textured program, "
+            << CountDifferences(instancedPixels, batchPixels) << " pixels differ from instancing" << std::endl;
+
+        //A square, a triangle and an octagon, drawn in turn with the same transforms and colors
+        mesh_pool pool(layout, 64, 64);
+        mesh_range meshes[3];
+        meshes[0] = pool.AddMesh(square, 4, indices, 6);
+        float triangle[] = { -1.0f, -1.0f, 1.0f, -1.0f, 0.0f, 1.0f };
+        unsigned int triangleIndices[] = { 0, 1, 2 };
+        meshes[1] = pool.AddMesh(triangle, 3, triangleIndices, 3);
+        float octagon[16];
+        unsigned int octagonIndices[18];
+        for (unsigned int i = 0; i < 8; i++)
+        {
+            octagon[i * 2] = std::cos(i * 0.785398f);
+            octagon[i * 2 + 1] = std::sin(i * 0.785398f);
+        }
+        for (unsigned int i = 0; i < 6; i++)
+        {
+            octagonIndices[i * 3] = 0;
+            octagonIndices[i * 3 + 1] = i + 1;
+            octagonIndices[i * 3 + 2] = i + 2;
+        }
+        meshes[2] = pool.AddMesh(octagon, 8, octagonIndices, 18);
+
+        shader_preprocessor indirectShaders("res/shaders/indirect.shader", true);
+        indirect_batch indirect(pool, quadCount), fallback(pool, quadCount, false);
+        unsigned int fallbackShader = createShader(indirectShaders.GetVariant({ { "INDIRECT", "0" } }));
+        unsigned int indirectShader = indirect.IsIndirect() ? createShader(indirectShaders.GetVariant({ { "INDIRECT", "1" } })) : 0;
+
+        std::vector<unsigned char> indirectPixels, fallbackPixels;
+        auto fill = [&](indirect_batch& target)
+        {
+            target.Clear();
+            for (unsigned int i = 0; i < quadCount; i++)
+            {
+                const quad_instance& quad = quads[i];
+                target.Add(meshes[i % 3], { { quad.Transform[0], quad.Transform[1], quad.Transform[2], quad.Transform[3] },
+                                            { quad.Color[0], quad.Color[1], quad.Color[2], quad.Color[3] } });
+            }
+        };
+        frame_times separate = RunFrames(frames, [&](command_list&)
+        {
+            fill(fallback);
+            fallback.Submit(fallbackShader);
+        }, fallbackPixels);
+        Report("indirect_batch fallback", separate, fallback.GetDrawCount(), quadCount);
+        if (indirect.IsIndirect())
+        {
+            frame_times multi = RunFrames(frames, [&](command_list&)
+            {
+                fill(indirect);
+                indirect.Submit(indirectShader);
+            }, indirectPixels);
+            Report("indirect_batch multi-draw", multi, 1, quadCount);
+            std::cout << "Multi-draw indirect: " << separate.Frame / multi.Frame << "x faster per frame than the fallback, "
+                << CountDifferences(fallbackPixels, indirectPixels) << " pixels differ" << std::endl;
+            GLCall(glDeleteProgram(indirectShader));
+        }
+        else
+        {
+            std::cout << "No multi-draw indirect on this driver, fallback only" << std::endl;
+        }
+
+        GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+        GLCall(glDeleteRenderbuffers(1, &colorBuffer));
+        GLCall(glDeleteFramebuffers(1, &framebuffer));
+        GLCall(glDeleteProgram(instancedShader));
+        GLCall(glDeleteProgram(sceneShader));
+        GLCall(glDeleteProgram(batchShader));
+        GLCall(glDeleteProgram(untexturedBatchShader));
+        GLCall(glDeleteProgram(fallbackShader));
+    }
+
+    DestroyContext(display, context);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <iostream>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+//Surfaceless EGL setup for the tools that render without a window, with Mesa
+//LIBGL_ALWAYS_SOFTWARE=1 puts them on llvmpipe. Needs GLEW built with GLEW_EGL
+//and libEGL. Messages start with the tool's tag, e.g. "[Draw]".
+
+//Surfaceless Mesa first, it needs neither X nor a GPU device node. Picks an RGBA8
+//desktop GL config; on failure the display is released again.
+inline bool OpenDisplay(const char* tag, EGLDisplay& display, EGLConfig& config)
+{
+	display = EGL_NO_DISPLAY;
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay)
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	if (display == EGL_NO_DISPLAY)
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+	EGLint major, minor;
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+	{
+		std::cout << tag << " No EGL display" << std::endl;
+		return false;
+	}
+
+	const EGLint configAttributes[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE, 8,
+		EGL_GREEN_SIZE, 8,
+		EGL_BLUE_SIZE, 8,
+		EGL_ALPHA_SIZE, 8,
+		EGL_NONE
+	};
+	EGLint configCount = 0;
+	if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)
+	{
+		std::cout << tag << " No EGL config with desktop GL" << std::endl;
+		eglTerminate(display);
+		return false;
+	}
+	return true;
+}
+
+//A GL 3.3 core context, current on the calling thread without a surface.
+//EGL_NO_CONTEXT on failure.
+inline EGLContext CreateSurfacelessContext(const char* tag, EGLDisplay display, EGLConfig config)
+{
+	//The bound API is per thread in EGL
+	eglBindAPI(EGL_OPENGL_API);
+	const EGLint contextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 3,
+		EGL_CONTEXT_MINOR_VERSION, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+	EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+	if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+	{
+		std::cout << tag << " Could not create a surfaceless GL 3.3 context (EGL error 0x" << std::hex
+			<< eglGetError() << std::dec << ")" << std::endl;
+		if (context != EGL_NO_CONTEXT)
+			eglDestroyContext(display, context);
+		return EGL_NO_CONTEXT;
+	}
+	return context;
+}
+
+//Entry points from eglGetProcAddress don't depend on the context, once per process is enough
+inline bool LoadGL(const char* tag)
+{
+	glewExperimental = GL_TRUE;
+	if (glewInit() != GLEW_OK)
+	{
+		std::cout << tag << " glewInit failed, GLEW needs to be built with GLEW_EGL" << std::endl;
+		return false;
+	}
+	//glewInit may leave GL_INVAL_ENUM behind on core contexts
+	while (glGetError() != GL_NO_ERROR);
+	return true;
+}
+
+//Releases context, if any, and the display
+inline void DestroyContext(EGLDisplay display, EGLContext context)
+{
+	eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	if (context != EGL_NO_CONTEXT)
+		eglDestroyContext(display, context);
+	eglTerminate(display);
+}
+
+//Display, context and GL entry points for a tool with a single context
+inline bool CreateContext(const char* tag, EGLDisplay& display, EGLContext& context)
+{
+	EGLConfig config;
+	if (!OpenDisplay(tag, display, config))
+		return false;
+
+	context = CreateSurfacelessContext(tag, display, config);
+	if (context == EGL_NO_CONTEXT || !LoadGL(tag))
+	{
+		DestroyContext(display, context);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,96 @@
+//Build step that turns .shader files into a header of constexpr string_views so
+//the app can start without touching the disk. Run from the repository root:
+//
+//    embed_shaders src/embedded_shaders.h res/shaders/basic.shader [more.shader ...]
+//
+//Each file becomes '<stem>_shader' plus an entry in embeddedShaderFiles keyed by
+//the path exactly as given on the command line.
+
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//MSVC caps a single string literal at ~16KB, adjacent literals are concatenated
+static const size_t chunkSize = 8192;
+static const std::string delimiter = "shader";
+
+static std::string IdentifierFor(const std::string& filepath)
+{
+    size_t slash = filepath.find_last_of("/\\");
+    std::string stem = filepath.substr(slash == std::string::npos ? 0 : slash + 1);
+    stem = stem.substr(0, stem.find('.'));
+
+    std::string identifier;
+    for (char c : stem)
+        identifier += isalnum((unsigned char)c) ? c : '_';
+    if (identifier.empty() || isdigit((unsigned char)identifier[0]))
+        identifier = "_" + identifier;
+
+    return identifier + "_shader";
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "usage: embed_shaders <output.h> <file.shader>..." << std::endl;
+        return 1;
+    }
+
+    std::stringstream out;
+    out << "//Generated by tools/embed_shaders, do not edit. Regenerate after changing:\n";
+    for (int i = 2; i < argc; i++)
+        out << "//    " << argv[i] << "\n";
+    out << "#pragma once\n\n#include <string_view>\n\n#include \"shader_source.h\"\n\n";
+
+    std::vector<std::pair<std::string, std::string>> entries;
+    for (int i = 2; i < argc; i++)
+    {
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file)
+        {
+            std::cout << "Could not open " << argv[i] << std::endl;
+            return 1;
+        }
+
+        std::stringstream contents;
+        contents << file.rdbuf();
+        std::string text = contents.str();
+
+        if (text.find(")" + delimiter + "\"") != std::string::npos)
+        {
+            std::cout << argv[i] << " contains the raw string delimiter )" << delimiter << "\"" << std::endl;
+            return 1;
+        }
+
+        std::string identifier = IdentifierFor(argv[i]);
+        out << "inline constexpr std::string_view " << identifier << " =";
+        for (size_t offset = 0; offset < text.size() || offset == 0; offset += chunkSize)
+            out << "\n    R\"" << delimiter << "(" << text.substr(offset, chunkSize) << ")" << delimiter << "\"";
+        out << ";\n\n";
+
+        entries.emplace_back(argv[i], identifier);
+    }
+
+    out << "inline constexpr embedded_shader_file embeddedShaderFiles[] = {\n";
+    for (const auto& entry : entries)
+        out << "    { \"" << entry.first << "\", " << entry.second << " },\n";
+    out << "};\n";
+
+    //Only touch the header when it changes so dependent files don't rebuild
+    std::string generated = out.str();
+    {
+        std::ifstream existing(argv[1], std::ios::binary);
+        std::stringstream previous;
+        previous << existing.rdbuf();
+        if (existing && previous.str() == generated)
+            return 0;
+    }
+
+    std::ofstream header(argv[1], std::ios::binary);
+    header << generated;
+    return header ? 0 : 1;
+}
@@ -0,0 +1,642 @@
+//Replays a GL trace recorded by a GL_TRACE build (see src/gl_trace.h) as fast as
+//the driver allows: vsync off, no app logic, one swap per recorded frame. Handy
+//for comparing drivers or backends on a frozen workload and for bisecting
+//performance regressions. Build with src/mapped_file.cpp and link GLFW and GLEW.
+//
+//    gl_replay <trace file> [--hidden]
+//
+//Prints the time per frame and in total; the total includes a final glFinish.
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gl_trace_format.h"
+#include "mapped_file.h"
+
+class trace_reader
+{
+private:
+    const unsigned char* m_Next;
+    const unsigned char* m_End;
+    bool m_Overrun;
+
+public:
+    trace_reader(const char* data, size_t size)
+        : m_Next(reinterpret_cast<const unsigned char*>(data)), m_End(m_Next + size), m_Overrun(false)
+    {
+    }
+
+    template<typename T>
+    T Get()
+    {
+        T value{};
+        if ((size_t)(m_End - m_Next) < sizeof(T))
+        {
+            m_Overrun = true;
+            m_Next = m_End;
+            return value;
+        }
+        memcpy(&value, m_Next, sizeof(T));
+        m_Next += sizeof(T);
+        return value;
+    }
+
+    const char* GetBytes(uint32_t& size)
+    {
+        size = Get<uint32_t>();
+        if ((size_t)(m_End - m_Next) < size)
+        {
+            m_Overrun = true;
+            m_Next = m_End;
+            size = 0;
+        }
+        const char* bytes = reinterpret_cast<const char*>(m_Next);
+        m_Next += size;
+        return bytes;
+    }
+
+    std::string GetString()
+    {
+        uint32_t size;
+        const char* bytes = GetBytes(size);
+        return std::string(bytes, size);
+    }
+
+    inline bool AtEnd() const { return m_Next >= m_End; }
+    inline bool Overran() const { return m_Overrun; }
+};
+
+//Objects are recreated under whatever names this driver hands out. Names that
+//were never created in the trace (0 in particular) pass through unchanged.
+using name_map = std::unordered_map<uint32_t, GLuint>;
+
+static GLuint MapName(const name_map& names, uint32_t traced)
+{
+    auto found = names.find(traced);
+    return found != names.end() ? found->second : traced;
+}
+
+static void GenNames(trace_reader& reader, name_map& names, std::vector<GLuint>& scratch, void (GLAPIENTRY* gen)(GLsizei, GLuint*))
+{
+    int32_t n = reader.Get<int32_t>();
+    scratch.resize(n);
+    gen(n, scratch.data());
+    for (int32_t i = 0; i < n; i++)
+        names[reader.Get<uint32_t>()] = scratch[i];
+}
+
+static void DeleteNames(trace_reader& reader, name_map& names, std::vector<GLuint>& scratch, void (GLAPIENTRY* del)(GLsizei, const GLuint*))
+{
+    int32_t n = reader.Get<int32_t>();
+    scratch.resize(n);
+    for (int32_t i = 0; i < n; i++)
+    {
+        uint32_t traced = reader.Get<uint32_t>();
+        scratch[i] = MapName(names, traced);
+        names.erase(traced);
+    }
+    del(n, scratch.data());
+}
+
+static const void* AsPointer(uint64_t offset)
+{
+    return reinterpret_cast<const void*>((uintptr_t)offset);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "usage: gl_replay <trace file> [--hidden]" << std::endl;
+        return 1;
+    }
+    bool hidden = argc > 2 && std::string(argv[2]) == "--hidden";
+
+    mapped_file file(argv[1]);
+    gl_trace_header header;
+    if (!file.IsOpen() || file.GetSize() < sizeof(header))
+    {
+        std::cout << "[Replay] Could not read " << argv[1] << std::endl;
+        return 1;
+    }
+    memcpy(&header, file.GetData(), sizeof(header));
+    if (header.Magic != glTraceMagic || header.Version != glTraceVersion)
+    {
+        std::cout << "[Replay] " << argv[1] << " is not a version " << glTraceVersion << " GL trace" << std::endl;
+        return 1;
+    }
+
+    if (!glfwInit())
+        return 1;
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, hidden ? GLFW_FALSE : GLFW_TRUE);
+
+    GLFWwindow* window = glfwCreateWindow(header.Width > 0 ? header.Width : 1280, header.Height > 0 ? header.Height : 720,
+                                          "GL trace replay", NULL, NULL);
+    if (!window)
+    {
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    glewExperimental = GL_TRUE;
+    if (glewInit() != GLEW_OK)
+    {
+        std::cout << "[Replay] glewInit failed" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+    std::cout << glGetString(GL_RENDERER) << ", " << glGetString(GL_VERSION) << std::endl;
+
+    name_map buffers, vertexArrays, programs, framebuffers, renderbuffers, pipelines;
+    std::unordered_map<uint64_t, GLsync> syncs;
+    //(traced program << 32 | traced location) -> location here
+    std::unordered_map<uint64_t, GLint> locations;
+    uint32_t currentProgram = 0;
+
+    auto mapLocation = [&locations](uint32_t program, int32_t location) -> GLint {
+        if (location < 0)
+            return location;
+        auto found = locations.find((uint64_t)program << 32 | (uint32_t)location);
+        return found != locations.end() ? found->second : location;
+    };
+
+    std::vector<GLuint> names;
+    std::vector<const GLchar*> strings;
+    std::vector<GLint> lengths;
+    std::vector<std::string> sources;
+    std::vector<unsigned char> pixels;
+    std::vector<double> frameTimes;
+
+    trace_reader reader(file.GetData() + sizeof(header), file.GetSize() - sizeof(header));
+    unsigned long long calls = 0;
+    bool failed = false;
+
+    using clock = std::chrono::steady_clock;
+    auto begin = clock::now();
+    auto frameBegin = begin;
+
+    while (!reader.AtEnd() && !failed)
+    {
+        gl_trace_op op = (gl_trace_op)reader.Get<uint16_t>();
+        calls++;
+
+        switch (op)
+        {
+        case gl_trace_op::FRAME:
+        {
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+            auto now = clock::now();
+            frameTimes.push_back(std::chrono::duration<double, std::milli>(now - frameBegin).count());
+            frameBegin = now;
+            break;
+        }
+        case gl_trace_op::ACTIVE_TEXTURE:
+            glActiveTexture(reader.Get<uint32_t>());
+            break;
+        case gl_trace_op::ATTACH_SHADER:
+        {
+            GLuint program = MapName(programs, reader.Get<uint32_t>());
+            glAttachShader(program, MapName(programs, reader.Get<uint32_t>()));
+            break;
+        }
+        case gl_trace_op::BIND_BUFFER:
+        {
+            GLenum target = reader.Get<uint32_t>();
+            glBindBuffer(target, MapName(buffers, reader.Get<uint32_t>()));
+            break;
+        }
+        case gl_trace_op::BIND_BUFFER_BASE:
+        {
+            GLenum target = reader.Get<uint32_t>();
+            GLuint index = reader.Get<uint32_t>();
+            glBindBufferBase(target, index, MapName(buffers, reader.Get<uint32_t>()));
+            break;
+        }
+        case gl_trace_op::BIND_FRAMEBUFFER:
+        {
+            GLenum target = reader.Get<uint32_t>();
+            glBindFramebuffer(target, MapName(framebuffers, reader.Get<uint32_t>()));
+            break;
+        }
+        case gl_trace_op::BIND_PROGRAM_PIPELINE:
+            glBindProgramPipeline(MapName(pipelines, reader.Get<uint32_t>()));
+            break;
+        case gl_trace_op::BIND_RENDERBUFFER:
+        {
+            GLenum target = reader.Get<uint32_t>();
+            glBindRenderbuffer(target, MapName(renderbuffers, reader.Get<uint32_t>()));
+            break;
+        }
+        case gl_trace_op::BIND_TEXTURE:
+        {
+            //Textures are created outside the traced code, names pass through
+            GLenum target = reader.Get<uint32_t>();
+            glBindTexture(target, reader.Get<uint32_t>());
+            break;
+        }
+        case gl_trace_op::BIND_VERTEX_ARRAY:
+            glBindVertexArray(MapName(vertexArrays, reader.Get<uint32_t>()));
+            break;
+        case gl_trace_op::BUFFER_DATA:
+        {
+            GLenum target = reader.Get<uint32_t>();
+            int64_t size = reader.Get<int64_t>();
+            GLenum usage = reader.Get<uint32_t>();
+            const char* data = nullptr;
+            if (reader.Get<uint8_t>())
+            {
+                uint32_t dataSize;
+                data = reader.GetBytes(dataSize);
+            }
+            glBufferData(target, (GLsizeiptr)size, data, usage);
+            break;
+        }
+        case gl_trace_op::BUFFER_SUB_DATA:
+        {
+            GLenum target = reader.Get<uint32_t>();
+            int64_t offset = reader.Get<int64_t>();
+            uint32_t size;
+            const char* data = reader.GetBytes(size);
+            glBufferSubData(target, (GLintptr)offset, size, data);
+            break;
+        }
+        case gl_trace_op::CLEAR:
+            glClear(reader.Get<uint32_t>());
+            break;
+        case gl_trace_op::CLEAR_COLOR:
+        {
+            float r = reader.Get<float>(), g = reader.Get<float>(), b = reader.Get<float>(), a = reader.Get<float>();
+            glClearColor(r, g, b, a);
+            break;
+        }
+        case gl_trace_op::CLIENT_WAIT_SYNC:
+        {
+            uint64_t sync = reader.Get<uint64_t>();
+            GLbitfield flags = reader.Get<uint32_t>();
+            uint64_t timeout = reader.Get<uint64_t>();
+            auto found = syncs.find(sync);
+            if (found != syncs.end())
+                glClientWaitSync(found->second, flags, timeout);
+            break;
+        }
+        case gl_trace_op::COMPILE_SHADER:
+            glCompileShader(MapName(programs, reader.Get<uint32_t>()));
+            break;
+        case gl_trace_op::CREATE_PROGRAM:
+            programs[reader.Get<uint32_t>()] = glCreateProgram();
+            break;
+        case gl_trace_op::CREATE_SHADER:
+        {
+            GLenum type = reader.Get<uint32_t>();
+            programs[reader.Get<uint32_t>()] = glCreateShader(type);
+            break;
+        }
+        case gl_trace_op::CREATE_SHADER_PROGRAMV:
+        {
+            //glCreateShaderProgramv has no lengths parameter, the sources need terminating
+            GLenum type = reader.Get<uint32_t>();
+            int32_t count = reader.Get<int32_t>();
+            sources.resize(count);
+            strings.resize(count);
+            for (int32_t i = 0; i < count; i++)
+            {
+                sources[i] = reader.GetString();
+                strings[i] = sources[i].c_str();
+            }
+            programs[reader.Get<uint32_t>()] = glCreateShaderProgramv(type, count, strings.data());
+            break;
+        }
+        case gl_trace_op::DELETE_BUFFERS:
+            DeleteNames(reader, buffers, names, glDeleteBuffers);
+            break;
+        case gl_trace_op::DELETE_FRAMEBUFFERS:
+            DeleteNames(reader, framebuffers, names, glDeleteFramebuffers);
+            break;
+        case gl_trace_op::DELETE_PROGRAM:
+        {
+            uint32_t traced = reader.Get<uint32_t>();
+            glDeleteProgram(MapName(programs, traced));
+            programs.erase(traced);
+            break;
+        }
+        case gl_trace_op::DELETE_PROGRAM_PIPELINES:
+            DeleteNames(reader, pipelines, names, glDeleteProgramPipelines);
+            break;
+        case gl_trace_op::DELETE_RENDERBUFFERS:
+            DeleteNames(reader, renderbuffers, names, glDeleteRenderbuffers);
+            break;
+        case gl_trace_op::DELETE_SHADER:
+        {
+            uint32_t traced = reader.Get<uint32_t>();
+            glDeleteShader(MapName(programs, traced));
+            programs.erase(traced);
+            break;
+        }
+        case gl_trace_op::DELETE_SYNC:
+        {
+            auto found = syncs.find(reader.Get<uint64_t>());
+            if (found != syncs.end())
+            {
+                glDeleteSync(found->second);
+                syncs.erase(found);
+            }
+            break;
+        }
+        case gl_trace_op::DELETE_VERTEX_ARRAYS:
+            DeleteNames(reader, vertexArrays, names, glDeleteVertexArrays);
+            break;
+        case gl_trace_op::DETACH_SHADER:
+        {
+            GLuint program = MapName(programs, reader.Get<uint32_t>());
+            glDetachShader(program, MapName(programs, reader.Get<uint32_t>()));
+            break;
+        }
+        case gl_trace_op::DISABLE:
+            glDisable(reader.Get<uint32_t>());
+            break;
+        case gl_trace_op::DRAW_ELEMENTS:
+        {
+            GLenum mode = reader.Get<uint32_t>();
+            int32_t count = reader.Get<int32_t>();
+            GLenum type = reader.Get<uint32_t>();
+            glDrawElements(mode, count, type, AsPointer(reader.Get<uint64_t>()));
+            break;
+        }
+        case gl_trace_op::DRAW_ELEMENTS_BASE_VERTEX:
+        {
+            GLenum mode = reader.Get<uint32_t>();
+            int32_t count = reader.Get<int32_t>();
+            GLenum type = reader.Get<uint32_t>();
+            const void* offset = AsPointer(reader.Get<uint64_t>());
+            glDrawElementsBaseVertex(mode, count, type, const_cast<void*>(offset), reader.Get<int32_t>());
+            break;
+        }
+        case gl_trace_op::DRAW_ELEMENTS_INSTANCED:
+        {
+            GLenum mode = reader.Get<uint32_t>();
+            int32_t count = reader.Get<int32_t>();
+            GLenum type = reader.Get<uint32_t>();
+            const void* offset = AsPointer(reader.Get<uint64_t>());
+            glDrawElementsInstanced(mode, count, type, offset, reader.Get<int32_t>());
+            break;
+        }
+        case gl_trace_op::ENABLE:
+            glEnable(reader.Get<uint32_t>());
+            break;
+        case gl_trace_op::ENABLE_VERTEX_ATTRIB_ARRAY:
+            glEnableVertexAttribArray(reader.Get<uint32_t>());
+            break;
+        case gl_trace_op::FENCE_SYNC:
+        {
+            GLenum condition = reader.Get<uint32_t>();
+            GLbitfield flags = reader.Get<uint32_t>();
+            syncs[reader.Get<uint64_t>()] = glFenceSync(condition, flags);
+            break;
+        }
+        case gl_trace_op::FLUSH:
+            glFlush();
+            break;
+        case gl_trace_op::FRAMEBUFFER_RENDERBUFFER:
+        {
+            GLenum target = reader.Get<uint32_t>();
+            GLenum attachment = reader.Get<uint32_t>();
+            GLenum renderbufferTarget = reader.Get<uint32_t>();
+            glFramebufferRenderbuffer(target, attachment, renderbufferTarget, MapName(renderbuffers, reader.Get<uint32_t>()));
+            break;
+        }
+        case gl_trace_op::GEN_BUFFERS:
+            GenNames(reader, buffers, names, glGenBuffers);
+            break;
+        case gl_trace_op::GEN_FRAMEBUFFERS:
+            GenNames(reader, framebuffers, names, glGenFramebuffers);
+            break;
+        case gl_trace_op::GEN_PROGRAM_PIPELINES:
+            GenNames(reader, pipelines, names, glGenProgramPipelines);
+            break;
+        case gl_trace_op::GEN_RENDERBUFFERS:
+            GenNames(reader, renderbuffers, names, glGenRenderbuffers);
+            break;
+        case gl_trace_op::GEN_VERTEX_ARRAYS:
+            GenNames(reader, vertexArrays, names, glGenVertexArrays);
+            break;
+        case gl_trace_op::GET_UNIFORM_LOCATION:
+        {
+            uint32_t program = reader.Get<uint32_t>();
+            std::string name = reader.GetString();
+            int32_t traced = reader.Get<int32_t>();
+            if (traced >= 0)
+                locations[(uint64_t)program << 32 | (uint32_t)traced] = glGetUniformLocation(MapName(programs, program), name.c_str());
+            break;
+        }
+        case gl_trace_op::LINK_PROGRAM:
+            glLinkProgram(MapName(programs, reader.Get<uint32_t>()));
+            break;
+        case gl_trace_op::MAP_BUFFER_RANGE:
+        {
+            GLenum target = reader.Get<uint32_t>();
+            int64_t offset = reader.Get<int64_t>();
+            int64_t length = reader.Get<int64_t>();
+            glMapBufferRange(target, (GLintptr)offset, (GLsizeiptr)length, reader.Get<uint32_t>());
+            break;
+        }
+        case gl_trace_op::MAX_SHADER_COMPILER_THREADS:
+        {
+            GLuint count = reader.Get<uint32_t>();
+            if (GLEW_ARB_parallel_shader_compile)
+                glMaxShaderCompilerThreadsARB(count);
+            break;
+        }
+        case gl_trace_op::MULTI_DRAW_ELEMENTS_INDIRECT:
+        {
+            GLenum mode = reader.Get<uint32_t>();
+            GLenum type = reader.Get<uint32_t>();
+            const void* offset = AsPointer(reader.Get<uint64_t>());
+            int32_t drawCount = reader.Get<int32_t>();
+            glMultiDrawElementsIndirect(mode, type, offset, drawCount, reader.Get<int32_t>());
+            break;
+        }
+        case gl_trace_op::PIXEL_STOREI:
+        {
+            GLenum name = reader.Get<uint32_t>();
+            glPixelStorei(name, reader.Get<int32_t>());
+            break;
+        }
+        case gl_trace_op::PROGRAM_UNIFORM4F:
+        {
+            uint32_t program = reader.Get<uint32_t>();
+            GLint location = mapLocation(program, reader.Get<int32_t>());
+            float x = reader.Get<float>(), y = reader.Get<float>(), z = reader.Get<float>(), w = reader.Get<float>();
+            glProgramUniform4f(MapName(programs, program), location, x, y, z, w);
+            break;
+        }
+        case gl_trace_op::READ_BUFFER:
+            glReadBuffer(reader.Get<uint32_t>());
+            break;
+        case gl_trace_op::READ_PIXELS:
+        {
+            int32_t x = reader.Get<int32_t>(), y = reader.Get<int32_t>();
+            int32_t width = reader.Get<int32_t>(), height = reader.Get<int32_t>();
+            GLenum format = reader.Get<uint32_t>();
+            GLenum type = reader.Get<uint32_t>();
+            bool intoPackBuffer = reader.Get<uint8_t>() != 0;
+            uint64_t offset = reader.Get<uint64_t>();
+            void* destination = const_cast<void*>(AsPointer(offset));
+            if (!intoPackBuffer)
+            {
+                //Room for the widest format the tree reads, 4 floats per pixel
+                pixels.resize((size_t)width * height * 16);
+                destination = pixels.data();
+            }
+            glReadPixels(x, y, width, height, format, type, destination);
+            break;
+        }
+        case gl_trace_op::RENDERBUFFER_STORAGE:
+        {
+            GLenum target = reader.Get<uint32_t>();
+            GLenum format = reader.Get<uint32_t>();
+            int32_t width = reader.Get<int32_t>();
+            glRenderbufferStorage(target, format, width, reader.Get<int32_t>());
+            break;
+        }
+        case gl_trace_op::SCISSOR:
+        {
+            int32_t x = reader.Get<int32_t>(), y = reader.Get<int32_t>();
+            int32_t width = reader.Get<int32_t>(), height = reader.Get<int32_t>();
+            glScissor(x, y, width, height);
+            break;
+        }
+        case gl_trace_op::SHADER_SOURCE:
+        {
+            GLuint shader = MapName(programs, reader.Get<uint32_t>());
+            int32_t count = reader.Get<int32_t>();
+            strings.resize(count);
+            lengths.resize(count);
+            for (int32_t i = 0; i < count; i++)
+            {
+                uint32_t size;
+                strings[i] = reader.GetBytes(size);
+                lengths[i] = (GLint)size;
+            }
+            glShaderSource(shader, count, strings.data(), lengths.data());
+            break;
+        }
+        case gl_trace_op::UNIFORM1IV:
+        {
+            GLint location = mapLocation(currentProgram, reader.Get<int32_t>());
+            uint32_t size;
+            const char* values = reader.GetBytes(size);
+            glUniform1iv(location, size / sizeof(GLint), reinterpret_cast<const GLint*>(values));
+            break;
+        }
+        case gl_trace_op::UNIFORM4F:
+        {
+            GLint location = mapLocation(currentProgram, reader.Get<int32_t>());
+            float x = reader.Get<float>(), y = reader.Get<float>(), z = reader.Get<float>(), w = reader.Get<float>();
+            glUniform4f(location, x, y, z, w);
+            break;
+        }
+        case gl_trace_op::UNIFORM4FV:
+        {
+            GLint location = mapLocation(currentProgram, reader.Get<int32_t>());
+            uint32_t size;
+            const char* values = reader.GetBytes(size);
+            glUniform4fv(location, size / (4 * sizeof(GLfloat)), reinterpret_cast<const GLfloat*>(values));
+            break;
+        }
+        case gl_trace_op::UNMAP_BUFFER:
+            glUnmapBuffer(reader.Get<uint32_t>());
+            break;
+        case gl_trace_op::USE_PROGRAM:
+            currentProgram = reader.Get<uint32_t>();
+            glUseProgram(MapName(programs, currentProgram));
+            break;
+        case gl_trace_op::USE_PROGRAM_STAGES:
+        {
+            GLuint pipeline = MapName(pipelines, reader.Get<uint32_t>());
+            GLbitfield stages = reader.Get<uint32_t>();
+            glUseProgramStages(pipeline, stages, MapName(programs, reader.Get<uint32_t>()));
+            break;
+        }
+        case gl_trace_op::VALIDATE_PROGRAM:
+            glValidateProgram(MapName(programs, reader.Get<uint32_t>()));
+            break;
+        case gl_trace_op::VERTEX_ATTRIB_DIVISOR:
+        {
+            GLuint index = reader.Get<uint32_t>();
+            glVertexAttribDivisor(index, reader.Get<uint32_t>());
+            break;
+        }
+        case gl_trace_op::VERTEX_ATTRIB_IPOINTER:
+        {
+            GLuint index = reader.Get<uint32_t>();
+            int32_t size = reader.Get<int32_t>();
+            GLenum type = reader.Get<uint32_t>();
+            int32_t stride = reader.Get<int32_t>();
+            glVertexAttribIPointer(index, size, type, stride, AsPointer(reader.Get<uint64_t>()));
+            break;
+        }
+        case gl_trace_op::VERTEX_ATTRIB_POINTER:
+        {
+            GLuint index = reader.Get<uint32_t>();
+            int32_t size = reader.Get<int32_t>();
+            GLenum type = reader.Get<uint32_t>();
+            GLboolean normalized = reader.Get<uint8_t>();
+            int32_t stride = reader.Get<int32_t>();
+            glVertexAttribPointer(index, size, type, normalized, stride, AsPointer(reader.Get<uint64_t>()));
+            break;
+        }
+        case gl_trace_op::VIEWPORT:
+        {
+            int32_t x = reader.Get<int32_t>(), y = reader.Get<int32_t>();
+            int32_t width = reader.Get<int32_t>(), height = reader.Get<int32_t>();
+            glViewport(x, y, width, height);
+            break;
+        }
+        default:
+            std::cout << "[Replay] Unknown op " << (unsigned int)op << " after " << calls << " calls" << std::endl;
+            failed = true;
+            break;
+        }
+    }
+
+    glFinish();
+    double totalMs = std::chrono::duration<double, std::milli>(clock::now() - begin).count();
+
+    if (reader.Overran())
+    {
+        std::cout << "[Replay] Trace ends in the middle of a call" << std::endl;
+        failed = true;
+    }
+    for (GLenum error = glGetError(); error != GL_NO_ERROR; error = glGetError())
+        std::cout << "[Replay] GL error 0x" << std::hex << error << std::dec << std::endl;
+
+    std::cout << calls << " calls, " << frameTimes.size() << " frames in " << totalMs << " ms" << std::endl;
+    if (!frameTimes.empty())
+    {
+        double sum = 0.0;
+        for (double time : frameTimes)
+            sum += time;
+        std::sort(frameTimes.begin(), frameTimes.end());
+        std::cout << "Frame time " << sum / frameTimes.size() << " ms (min " << frameTimes.front() << ", median "
+            << frameTimes[frameTimes.size() / 2] << ", max " << frameTimes.back() << ")" << std::endl;
+    }
+
+    glfwTerminate();
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,228 @@
+//Benchmark of job_system: the round trip of one empty job, the cost per job of a
+//burst of empty ones, ParallelFor scaling from 1 to N threads, and jobs queued
+//with RunAfter while the job they depend on keeps a worker busy, which must all
+//run once it is done, and a main-thread job that waits on the one queued behind
+//it, which must run exactly once. A run that takes longer than 10 s is reported
+//as hung.
+//Spawn and dependency tests use at least one worker. Build with src/job_system.cpp.
+//
+//    job_benchmark [<threads>]
+//
+//Defaults: one thread per hardware thread.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "job_system.h"
+#include "timing.h"
+
+static const unsigned int repeats = 10;
+static const unsigned int burstSize = 4000;
+static const unsigned int elementCount = 1 << 22;
+//More dependent jobs than fit in a thread's job pool at once
+static const unsigned int dependentCount = 10000;
+
+static void Empty(const job&)
+{
+}
+
+static void Increment(const job& self)
+{
+    ((std::atomic<unsigned int>*)self.Data)->fetch_add(1, std::memory_order_relaxed);
+}
+
+static void Sleep(const job& self)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(self.Begin));
+}
+
+//Something to compute that the optimizer can't drop
+static float Work(const std::vector<float>& values, unsigned int begin, unsigned int end)
+{
+    float sum = 0.0f;
+    for (unsigned int i = begin; i < end; i++)
+        sum += std::sqrt(values[i]) * std::sin(values[i]);
+    return sum;
+}
+
+static void Spawn(job_system& jobs)
+{
+    double single = Time(repeats, [&] {
+        for (unsigned int i = 0; i < burstSize; i++)
+        {
+            std::atomic<unsigned int> counter(1);
+            job j;
+            j.Function = Empty;
+            j.Counter = &counter;
+            jobs.Run(j);
+            jobs.Wait(counter);
+        }
+    });
+
+    double burst = Time(repeats, [&] {
+        std::atomic<unsigned int> counter(burstSize);
+        for (unsigned int i = 0; i < burstSize; i++)
+        {
+            job j;
+            j.Function = Empty;
+            j.Counter = &counter;
+            jobs.Run(j);
+        }
+        jobs.Wait(counter);
+    });
+
+    std::cout << "Run and Wait one job: " << single * 1e6 / burstSize << " ns, burst of " << burstSize << ": "
+        << burst * 1e6 / burstSize << " ns per job" << std::endl;
+}
+
+//Run(B); RunAfter(c, A); Wait(a) with c held by a job that keeps a worker busy, then
+//many more dependents than there are pool slots. False if any of them didn't run.
+static bool Dependencies(job_system& jobs)
+{
+    std::atomic<unsigned int> busy(1), a(1), b(1), ran(0);
+    job sleeper;
+    sleeper.Function = Sleep;
+    sleeper.Begin = 50;
+    sleeper.Counter = &busy;
+    jobs.Run(sleeper);
+    //Let a worker take it, so the main thread finds the dependent job first
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    job independent;
+    independent.Function = Increment;
+    independent.Data = &ran;
+    independent.Counter = &b;
+    jobs.Run(independent);
+
+    job dependent = independent;
+    dependent.Counter = &a;
+    jobs.RunAfter(busy, dependent);
+    jobs.Wait(a);
+    jobs.Wait(b);
+
+    std::atomic<unsigned int> gate(1), dependents(dependentCount);
+    sleeper.Begin = 20;
+    sleeper.Counter = &gate;
+    jobs.Run(sleeper);
+    dependent.Counter = &dependents;
+    for (unsigned int i = 0; i < dependentCount; i++)
+        jobs.RunAfter(gate, dependent);
+    jobs.Wait(dependents);
+    jobs.Wait(gate);
+    return ran.load() == dependentCount + 2;
+}
+
+struct waiting_job_data
+{
+    job_system* System;
+    std::atomic<unsigned int>* Waits;
+    std::atomic<unsigned int>* Ran;
+};
+
+static void WaitOnMainThread(const job& self)
+{
+    const waiting_job_data& data = *(const waiting_job_data*)self.Data;
+    data.System->Wait(*data.Waits);
+    data.Ran->fetch_add(1, std::memory_order_relaxed);
+}
+
+//Main-thread job A waits on B, queued behind it, so Wait re-enters
+//RunMainThreadJobs from inside A. False if B didn't run exactly once.
+static bool MainThreadReentry(job_system& jobs)
+{
+    std::atomic<unsigned int> a(1), b(1), ran(0);
+    waiting_job_data data = { &jobs, &b, &ran };
+    job first;
+    first.Function = WaitOnMainThread;
+    first.Data = &data;
+    first.Counter = &a;
+    job second;
+    second.Function = Increment;
+    second.Data = &ran;
+    second.Counter = &b;
+    jobs.RunOnMainThread(first);
+    jobs.RunOnMainThread(second);
+    jobs.Wait(a);
+
+    //Anything queued twice would run here
+    jobs.RunMainThreadJobs();
+    jobs.RunMainThreadJobs();
+    return ran.load() == 2 && b.load() == 0;
+}
+
+int main(int argc, char** argv)
+{
+    int requested = argc > 1 ? atoi(argv[1]) : 0;
+    if (requested < 0 || argc > 2)
+    {
+        std::cout << "usage: job_benchmark [<threads>]" << std::endl;
+        return 1;
+    }
+
+    //A hang is the likeliest failure, so have a watchdog report it
+    std::thread watchdog([] {
+        std::this_thread::sleep_for(std::chrono::seconds(10));
+        std::cout << "HUNG" << std::endl;
+        std::_Exit(1);
+    });
+    watchdog.detach();
+
+    //The job system counts the calling thread among its threads, 0 workers means one per hardware thread
+    unsigned int threads = requested ? (unsigned int)requested : std::max(1u, std::thread::hardware_concurrency());
+    std::unique_ptr<job_system> jobs(new job_system(std::max(1u, threads - 1)));
+    std::cout << jobs->GetThreadCount() << " threads, best of " << repeats << std::endl;
+    Spawn(*jobs);
+
+    bool complete = Dependencies(*jobs);
+    std::cout << "RunAfter with the dependency busy: " << (complete ? "all ran" : "MISSING JOBS") << std::endl;
+    bool reentered = MainThreadReentry(*jobs);
+    std::cout << "Main-thread job waiting on the next one: " << (reentered ? "ran once" : "WRONG COUNT") << std::endl;
+    complete = complete && reentered;
+
+    std::vector<float> values(elementCount);
+    for (unsigned int i = 0; i < elementCount; i++)
+        values[i] = (float)i;
+
+    //Chunks summed one per index, so each thread count adds up the same floats
+    const unsigned int chunk = 4096;
+    std::vector<float> sums(elementCount / chunk);
+    std::cout << "ParallelFor over " << elementCount << " elements in chunks of " << chunk << std::endl;
+    double serial = 0.0;
+    float expected = 0.0f;
+    for (unsigned int t = 1; t <= threads; t++)
+    {
+        //Nothing but the calling thread for 1
+        jobs.reset(t > 1 ? new job_system(t - 1) : nullptr);
+        double parallel = Time(repeats, [&] {
+            if (!jobs)
+            {
+                for (unsigned int c = 0; c < sums.size(); c++)
+                    sums[c] = Work(values, c * chunk, (c + 1) * chunk);
+                return;
+            }
+            jobs->ParallelFor((unsigned int)sums.size(), 0, [&](unsigned int c)
+            {
+                sums[c] = Work(values, c * chunk, (c + 1) * chunk);
+            });
+        });
+
+        float total = 0.0f;
+        for (float sum : sums)
+            total += sum;
+        if (t == 1)
+        {
+            serial = parallel;
+            expected = total;
+        }
+        complete = complete && total == expected;
+        std::cout << "  " << t << " threads: " << parallel << " ms (" << serial / parallel << "x)"
+            << (total == expected ? "" : ", DIFFERENT sum") << std::endl;
+    }
+    return complete ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+//Microbenchmarks for src/simd_math: each batch kernel against the plain loop of
+//single vec4 / mat4 operations it replaces, on the same data, with the largest
+//difference between the two so a broken kernel shows up next to its timing.
+//Build with src/simd_math.cpp, with and without -mavx2 -mfma to compare paths.
+//
+//    math_benchmark [<count> <repeats>]
+//
+//Defaults: 1000000 points / matrices, best of 20 runs.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "simd_math.h"
+#include "timing.h"
+
+static void Report(const char* name, size_t count, double scalarMs, double batchMs, float maxError)
+{
+    std::cout << name << ": " << scalarMs << " ms scalar, " << batchMs << " ms batch (" << scalarMs / batchMs
+        << "x), " << count / batchMs / 1e3 << " M/s, max difference " << maxError << std::endl;
+}
+
+static float MaxDifference(const mat4& a, const mat4& b)
+{
+    float difference = 0.0f;
+    for (int c = 0; c < 4; c++)
+        for (int r = 0; r < 4; r++)
+            difference = std::max(difference, std::fabs(a.Columns[c][r] - b.Columns[c][r]));
+    return difference;
+}
+
+static mat4 RandomTransform(std::mt19937& random)
+{
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    quat rotation = AxisAngle(vec3(unit(random), unit(random), unit(random) + 2.0f), unit(random) * 3.14159f);
+    return Compose(vec3(unit(random) * 100.0f, unit(random) * 100.0f, unit(random) * 100.0f), rotation,
+                   vec3(1.0f + unit(random) * 0.5f, 1.0f + unit(random) * 0.5f, 1.0f + unit(random) * 0.5f));
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = argc > 1 ? (size_t)atoll(argv[1]) : 1000000;
+    unsigned int repeats = argc > 2 ? (unsigned int)atoi(argv[2]) : 20;
+    if (count == 0 || repeats == 0)
+    {
+        std::cout << "usage: math_benchmark [<count> <repeats>]" << std::endl;
+        return 1;
+    }
+
+#ifdef __AVX2__
+    std::cout << "AVX2";
+#elif defined(SIMD_MATH_SSE)
+    std::cout << "SSE";
+#else
+    std::cout << "Scalar";
+#endif
+    std::cout << " kernels, " << count << " elements, best of " << repeats << std::endl;
+
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    const mat4 view = LookAt(vec3(0.0f, 50.0f, 200.0f), vec3(0.0f, 0.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f));
+    const mat4 viewProjection = Perspective(1.0f, 16.0f / 9.0f, 0.1f, 1000.0f) * view;
+
+    //Points: SoA for the kernel, the same values as vec4s for the scalar loop
+    std::vector<float> x(count), y(count), z(count), outX(count), outY(count), outZ(count), outW(count);
+    std::vector<vec4> points(count), transformed(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        x[i] = unit(random) * 100.0f;
+        y[i] = unit(random) * 100.0f;
+        z[i] = unit(random) * 100.0f;
+        points[i] = vec4(x[i], y[i], z[i], 1.0f);
+    }
+
+    {
+        double scalar = Time(repeats, [&] {
+            for (size_t i = 0; i < count; i++)
+                transformed[i] = view * points[i];
+        });
+        double batch = Time(repeats, [&] {
+            TransformPoints(view, x.data(), y.data(), z.data(), outX.data(), outY.data(), outZ.data(), count);
+        });
+        float error = 0.0f;
+        for (size_t i = 0; i < count; i++)
+        {
+            error = std::max(error, std::fabs(outX[i] - transformed[i].X));
+            error = std::max(error, std::fabs(outY[i] - transformed[i].Y));
+            error = std::max(error, std::fabs(outZ[i] - transformed[i].Z));
+        }
+        Report("TransformPoints (affine)", count, scalar, batch, error);
+    }
+
+    {
+        double scalar = Time(repeats, [&] {
+            for (size_t i = 0; i < count; i++)
+                transformed[i] = viewProjection * points[i];
+        });
+        double batch = Time(repeats, [&] {
+            TransformPoints(viewProjection, x.data(), y.data(), z.data(), outX.data(), outY.data(), outZ.data(),
+                            outW.data(), count);
+        });
+        float error = 0.0f;
+        for (size_t i = 0; i < count; i++)
+            error = std::max(error, std::fabs(outW[i] - transformed[i].W));
+        Report("TransformPoints (clip)", count, scalar, batch, error);
+    }
+
+    std::vector<mat4> parents(count), locals(count), worlds(count), expected(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        parents[i] = RandomTransform(random);
+        locals[i] = RandomTransform(random);
+    }
+
+    //Four children per parent, like the trees scene_graph updates
+    std::vector<unsigned int> parentIndices(count);
+    for (size_t i = 0; i < count; i++)
+        parentIndices[i] = (unsigned int)(i / 4);
+
+    {
+        double scalar = Time(repeats, [&] {
+            for (size_t i = 0; i < count; i++)
+                expected[i] = parents[parentIndices[i]] * locals[i];
+        });
+        double batch = Time(repeats, [&] {
+            MultiplyMatrices(parents.data(), parentIndices.data(), locals.data(), worlds.data(), count);
+        });
+        float error = 0.0f;
+        for (size_t i = 0; i < count; i++)
+            error = std::max(error, MaxDifference(worlds[i], expected[i]));
+        Report("MultiplyMatrices", count, scalar, batch, error);
+    }
+
+    std::vector<aabb> boxes(count), worldBoxes(count), expectedBoxes(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        vec3 center(unit(random), unit(random), unit(random));
+        vec3 extents(0.1f + std::fabs(unit(random)), 0.1f + std::fabs(unit(random)), 0.1f + std::fabs(unit(random)));
+        boxes[i] = { center - extents, center + extents };
+    }
+
+    {
+        double scalar = Time(repeats, [&] {
+            for (size_t i = 0; i < count; i++)
+                expectedBoxes[i] = TransformAABB(locals[i], boxes[i]);
+        });
+        double batch = Time(repeats, [&] {
+            TransformAABBs(locals.data(), boxes.data(), worldBoxes.data(), count);
+        });
+        float error = 0.0f;
+        for (size_t i = 0; i < count; i++)
+            for (int axis = 0; axis < 3; axis++)
+            {
+                error = std::max(error, std::fabs(worldBoxes[i].Min[axis] - expectedBoxes[i].Min[axis]));
+                error = std::max(error, std::fabs(worldBoxes[i].Max[axis] - expectedBoxes[i].Max[axis]));
+            }
+        Report("TransformAABBs", count, scalar, batch, error);
+    }
+
+    //Single operations, for reference
+    {
+        double inverse = Time(repeats, [&] {
+            for (size_t i = 0; i < count; i++)
+                worlds[i] = Inverse(locals[i]);
+        });
+        double affine = Time(repeats, [&] {
+            for (size_t i = 0; i < count; i++)
+                expected[i] = InverseAffine(locals[i]);
+        });
+        float error = 0.0f;
+        for (size_t i = 0; i < count; i++)
+            error = std::max(error, MaxDifference(worlds[i] * locals[i], mat4()));
+        std::cout << "Inverse: " << inverse << " ms, InverseAffine: " << affine << " ms, max |inverse * m - I| "
+            << error << std::endl;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,164 @@
+//Benchmark of program_pipeline_cache on a surfaceless EGL context: materials that
+//share scene.shader's vertex stage and differ only in their fragment stage are
+//loaded once as whole linked programs and once as separable stages combined into
+//program pipelines. Reports the links each mode needed (a separable stage counts
+//once) and the time to load them, then draws a square per material in both modes
+//and compares the images, which must match. Build with the sources under src/
+//(minus application.cpp), against GLEW compiled with GLEW_EGL, and link libEGL.
+//
+//    pipeline_benchmark [<materials>]
+//
+//Defaults: 64 materials, at 256x256. Without ARB_separate_shader_objects both
+//passes link whole programs.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "egl_context.h"
+#include "renderer.h"
+#include "vertex_buffer.h"
+#include "vertex_buffer_layout.h"
+#include "vertex_array.h"
+#include "index_buffer.h"
+#include "shader_program.h"
+#include "embedded_shaders.h"
+#include "program_pipeline.h"
+#include "timing.h"
+
+static const int width = 256;
+static const int height = 256;
+static const unsigned int columns = 8;
+
+//scene.shader with a fragment stage of its own, tinted by the material's index
+static ShaderProgramSource MakeMaterial(unsigned int index, unsigned int count)
+{
+    static constexpr shader_sections sceneSections = ParseShaderSections(scene_shader);
+    ShaderProgramSource source = ToProgramSource(sceneSections);
+    std::string tint = std::to_string(0.25f + 0.75f * index / count) + ", " +
+                       std::to_string(0.25f + 0.75f * (index % 5) / 4.0f) + ", 1.0, 1.0";
+    source.FragmentSource =
+        "#version 330 core\n"
+        "layout(location = 0) out vec4 color;\n"
+        "uniform vec4 u_Color;\n"
+        "void main()\n"
+        "{\n"
+        "\tcolor = u_Color * vec4(" + tint + ");\n"
+        "}\n";
+    return source;
+}
+
+struct pass_result
+{
+    unsigned int Links;
+    double Load; //ms to get every material from an empty cache
+    bool Separable;
+};
+
+//Loads the materials into a fresh cache and draws a square with each, leaving the image in pixels
+static pass_result RunPass(bool separable, const std::vector<ShaderProgramSource>& materials, const vertex_array& va,
+                           const index_buffer& ib, std::vector<unsigned char>& pixels)
+{
+    program_pipeline_cache cache(separable);
+    std::vector<program_pipeline> pipelines;
+    auto begin = std::chrono::steady_clock::now();
+    for (const ShaderProgramSource& material : materials)
+        pipelines.push_back(cache.Get(material));
+    double load = Milliseconds(begin);
+
+    GLCall(glClear(GL_COLOR_BUFFER_BIT));
+    va.bind();
+    ib.bind();
+    const float cell = 2.0f / columns;
+    for (unsigned int i = 0; i < pipelines.size(); i++)
+    {
+        const program_pipeline& pipeline = pipelines[i];
+        ASSERT(pipeline.Program != 0 || pipeline.Pipeline != 0);
+        cache.Bind(pipeline);
+
+        float x = -1.0f + cell * (i % columns + 0.5f), y = -1.0f + cell * (i / columns % columns + 0.5f);
+        int transform = cache.GetUniformLocation(pipeline, shader_stage::VERTEX, "u_Transform");
+        int color = cache.GetUniformLocation(pipeline, shader_stage::FRAGMENT, "u_Color");
+        cache.SetUniform4f(pipeline, shader_stage::VERTEX, transform, cell * 0.4f, 0.0f, 0.0f, 0.0f);
+        cache.SetUniform4f(pipeline, shader_stage::VERTEX, transform + 1, 0.0f, cell * 0.4f, 0.0f, 0.0f);
+        cache.SetUniform4f(pipeline, shader_stage::VERTEX, transform + 2, 0.0f, 0.0f, 1.0f, 0.0f);
+        cache.SetUniform4f(pipeline, shader_stage::VERTEX, transform + 3, x, y, 0.0f, 1.0f);
+        cache.SetUniform4f(pipeline, shader_stage::FRAGMENT, color, 1.0f, 0.8f, 0.6f, 1.0f);
+        GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
+    }
+    cache.Unbind();
+
+    pixels.resize((size_t)width * height * 4);
+    GLCall(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data()));
+    return { cache.GetLinkCount(), load, cache.IsSeparable() };
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int materialCount = argc > 1 ? (unsigned int)atoi(argv[1]) : 64;
+    if (materialCount == 0 || argc > 2)
+    {
+        std::cout << "usage: pipeline_benchmark [<materials>]" << std::endl;
+        return 1;
+    }
+
+    EGLDisplay display;
+    EGLContext context = EGL_NO_CONTEXT;
+    if (!CreateContext("[Pipeline]", display, context))
+        return 1;
+    std::cout << glGetString(GL_RENDERER) << ", " << glGetString(GL_VERSION) << ", " << materialCount << " materials" << std::endl;
+
+    size_t differing = 0;
+    {
+        std::vector<ShaderProgramSource> materials;
+        for (unsigned int i = 0; i < materialCount; i++)
+            materials.push_back(MakeMaterial(i, materialCount));
+
+        float square[] = { -1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f };
+        unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+        vertex_array va;
+        vertex_buffer vb(square, sizeof(square));
+        vertex_buffer_layout layout;
+        layout.Push<float>(2);
+        va.AddBuffer(vb, layout);
+        index_buffer ib(indices, 6);
+
+        unsigned int framebuffer, colorBuffer;
+        GLCall(glGenFramebuffers(1, &framebuffer));
+        GLCall(glGenRenderbuffers(1, &colorBuffer));
+        GLCall(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+        GLCall(glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer));
+        GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height));
+        GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer));
+        ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+        GLCall(glViewport(0, 0, width, height));
+        GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+        GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+
+        std::vector<unsigned char> wholePixels, separablePixels;
+        pass_result whole = RunPass(false, materials, va, ib, wholePixels);
+        pass_result separable = RunPass(true, materials, va, ib, separablePixels);
+        std::cout << "Whole programs: " << whole.Links << " links, " << whole.Load << " ms" << std::endl;
+        if (separable.Separable)
+            std::cout << "Separable stages: " << separable.Links << " links, " << separable.Load << " ms ("
+                << whole.Load / separable.Load << "x faster)" << std::endl;
+        else
+            std::cout << "No ARB_separate_shader_objects, linked whole programs again: " << separable.Links << " links" << std::endl;
+
+        for (size_t i = 0; i < wholePixels.size(); i++)
+        {
+            if (wholePixels[i] != separablePixels[i])
+                differing++;
+        }
+        std::cout << differing << " bytes of the two images differ" << std::endl;
+
+        GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+        GLCall(glDeleteRenderbuffers(1, &colorBuffer));
+        GLCall(glDeleteFramebuffers(1, &framebuffer));
+    }
+
+    DestroyContext(display, context);
+    return differing == 0 ? 0 : 1;
+}
\ No newline at end of file
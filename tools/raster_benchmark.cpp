@@ -0,0 +1,296 @@
+//Throughput benchmark of soft_rasterizer against the GL driver, meant for llvmpipe
+//(set LIBGL_ALWAYS_SOFTWARE=1 with Mesa). Draws the same random triangles with
+//basic.shader on a surfaceless EGL context and with soft_basic_shader on the CPU,
+//times both and reports how many pixels of the final images differ. Build with the
+//sources under src/ (minus application.cpp), against GLEW compiled with GLEW_EGL,
+//and link libEGL.
+//
+//    raster_benchmark [<width> <height> <triangles> <frames> <threads> [<reference>]]
+//
+//The same triangles are also drawn once with soft_vertex_color_shader, whose
+//varyings go through the AVX2 or scalar interpolation. Given a reference file,
+//that image is written to it when it doesn't exist and compared with it when it
+//does, so running a build with -mavx2 and one without on the same file checks
+//that both paths give the same pixels.
+//
+//Defaults: 1280x720, 20000 triangles, 50 frames, one thread per hardware thread.
+//Triangles come from a fixed seed, in 16 draws of different colors. The two images
+//only differ along edges: both snap to subpixels and follow a top-left rule, but
+//not necessarily the same precision and corners.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "egl_context.h"
+#include "renderer.h"
+#include "vertex_buffer.h"
+#include "vertex_buffer_layout.h"
+#include "vertex_array.h"
+#include "index_buffer.h"
+#include "command_list.h"
+#include "shader_program.h"
+#include "embedded_shaders.h"
+#include "job_system.h"
+#include "soft_rasterizer.h"
+#include "soft_shaders.h"
+
+static const unsigned int drawCount = 16;
+
+struct benchmark_scene
+{
+    std::vector<float> Positions;
+    std::vector<float> ColoredVertices; //x, y, r, g, b, a
+    std::vector<std::vector<unsigned int>> Indices; //one list per draw
+    float Colors[drawCount][4];
+};
+
+//Triangles of random size and placement, some partly off screen, in both windings
+static void MakeScene(unsigned int triangleCount, benchmark_scene& out)
+{
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> center(-1.1f, 1.1f);
+    std::uniform_real_distribution<float> size(0.01f, 0.25f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    out.Indices.resize(drawCount);
+    for (unsigned int i = 0; i < triangleCount; i++)
+    {
+        float x = center(random), y = center(random), extent = size(random);
+        unsigned int first = (unsigned int)out.Positions.size() / 2;
+        for (int v = 0; v < 3; v++)
+        {
+            out.Positions.push_back(x + (unit(random) - 0.5f) * extent * 2.0f);
+            out.Positions.push_back(y + (unit(random) - 0.5f) * extent * 2.0f);
+            out.ColoredVertices.insert(out.ColoredVertices.end(), out.Positions.end() - 2, out.Positions.end());
+            for (int c = 0; c < 4; c++)
+                out.ColoredVertices.push_back(unit(random));
+        }
+        std::vector<unsigned int>& indices = out.Indices[i % drawCount];
+        indices.push_back(first);
+        indices.push_back(first + 1);
+        indices.push_back(first + 2);
+    }
+    for (unsigned int d = 0; d < drawCount; d++)
+    {
+        for (int c = 0; c < 3; c++)
+            out.Colors[d][c] = unit(random);
+        out.Colors[d][3] = 1.0f;
+    }
+}
+
+//Returns seconds per frame, the last frame's pixels are left in pixels
+static double RunGL(const benchmark_scene& scene, int width, int height, unsigned int frames, std::vector<unsigned char>& pixels)
+{
+    double seconds = 0.0;
+    {
+        vertex_array va;
+        vertex_buffer vb(scene.Positions.data(), (unsigned int)(scene.Positions.size() * sizeof(float)));
+        vertex_buffer_layout layout;
+        layout.Push<float>(2);
+        va.AddBuffer(vb, layout);
+
+        std::vector<std::unique_ptr<index_buffer>> indexBuffers;
+        for (const std::vector<unsigned int>& indices : scene.Indices)
+            indexBuffers.emplace_back(new index_buffer(indices.data(), (unsigned int)indices.size()));
+
+        static constexpr shader_sections basicSections = ParseShaderSections(basic_shader);
+        unsigned int shader = createShader(ToProgramSource(basicSections));
+        int colorLocation;
+        GLCall(colorLocation = glGetUniformLocation(shader, "u_Color"));
+
+        unsigned int framebuffer, colorBuffer;
+        GLCall(glGenFramebuffers(1, &framebuffer));
+        GLCall(glGenRenderbuffers(1, &colorBuffer));
+        GLCall(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+        GLCall(glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer));
+        GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height));
+        GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer));
+        ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+        GLCall(glViewport(0, 0, width, height));
+        GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+
+        //The layer keeps the draws in submission order, like soft_rasterizer
+        renderer glRenderer;
+        command_list list;
+        for (unsigned int d = 0; d < drawCount; d++)
+        {
+            draw_uniform color = { colorLocation, { scene.Colors[d][0], scene.Colors[d][1], scene.Colors[d][2], scene.Colors[d][3] } };
+            list.Submit(renderer::MakeSortKey(d, shader, 0, 0.0f), shader, va.GetRendererID(), *indexBuffers[d], &color, 1);
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        for (unsigned int frame = 0; frame < frames; frame++)
+        {
+            glRenderer.Clear();
+            glRenderer.Execute(list);
+            GLCall(glFinish());
+        }
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        pixels.resize((size_t)width * height * 4);
+        GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+        GLCall(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data()));
+
+        GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+        GLCall(glDeleteRenderbuffers(1, &colorBuffer));
+        GLCall(glDeleteFramebuffers(1, &framebuffer));
+        GLCall(glDeleteProgram(shader));
+    }
+    return seconds / frames;
+}
+
+static double RunSoft(const benchmark_scene& scene, int width, int height, unsigned int frames, job_system* jobs,
+                      std::vector<unsigned char>& pixels)
+{
+    soft_vertex_buffer vb(scene.Positions.data(), (unsigned int)(scene.Positions.size() * sizeof(float)));
+    vertex_buffer_layout layout;
+    layout.Push<float>(2);
+
+    std::vector<soft_index_buffer> indexBuffers;
+    for (const std::vector<unsigned int>& indices : scene.Indices)
+        indexBuffers.emplace_back(indices.data(), (unsigned int)indices.size());
+
+    soft_rasterizer rasterizer(width, height, jobs);
+    auto begin = std::chrono::steady_clock::now();
+    for (unsigned int frame = 0; frame < frames; frame++)
+    {
+        rasterizer.Clear(0.0f, 0.0f, 0.0f, 1.0f);
+        for (unsigned int d = 0; d < drawCount; d++)
+        {
+            soft_basic_shader shader = { { scene.Colors[d][0], scene.Colors[d][1], scene.Colors[d][2], scene.Colors[d][3] } };
+            rasterizer.Draw(vb, layout, indexBuffers[d], shader);
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    pixels.resize((size_t)width * height * 4);
+    rasterizer.ReadPixels(pixels.data());
+    return seconds / frames;
+}
+
+//One frame with interpolated vertex colors, into pixels
+static void RunSoftColored(const benchmark_scene& scene, int width, int height, job_system* jobs, std::vector<unsigned char>& pixels)
+{
+    soft_vertex_buffer vb(scene.ColoredVertices.data(), (unsigned int)(scene.ColoredVertices.size() * sizeof(float)));
+    vertex_buffer_layout layout;
+    layout.Push<float>(2);
+    layout.Push<float>(4);
+
+    soft_rasterizer rasterizer(width, height, jobs);
+    rasterizer.Clear(0.0f, 0.0f, 0.0f, 1.0f);
+    for (const std::vector<unsigned int>& indices : scene.Indices)
+        rasterizer.Draw(vb, layout, soft_index_buffer(indices.data(), (unsigned int)indices.size()), soft_vertex_color_shader());
+
+    pixels.resize((size_t)width * height * 4);
+    rasterizer.ReadPixels(pixels.data());
+}
+
+//Writes pixels to path if there is no such file yet, otherwise returns how many
+//pixels differ from it, or -1 if it has a different size
+static long long CompareWithReference(const char* path, const std::vector<unsigned char>& pixels)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        std::ofstream(path, std::ios::binary).write((const char*)pixels.data(), (std::streamsize)pixels.size());
+        std::cout << "[Raster] Wrote the vertex color image to " << path << std::endl;
+        return 0;
+    }
+
+    std::vector<unsigned char> reference((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (reference.size() != pixels.size())
+        return -1;
+    long long differing = 0;
+    for (size_t i = 0; i < pixels.size(); i += 4)
+    {
+        if (std::memcmp(&pixels[i], &reference[i], 4) != 0)
+            differing++;
+    }
+    return differing;
+}
+
+int main(int argc, char** argv)
+{
+    int width = argc > 2 ? atoi(argv[1]) : 1280;
+    int height = argc > 2 ? atoi(argv[2]) : 720;
+    unsigned int triangleCount = argc > 3 ? (unsigned int)atoi(argv[3]) : 20000;
+    unsigned int frames = argc > 4 ? (unsigned int)atoi(argv[4]) : 50;
+    unsigned int threads = argc > 5 ? (unsigned int)atoi(argv[5]) : 0;
+    const char* referencePath = argc > 6 ? argv[6] : nullptr;
+    if (width <= 0 || height <= 0 || frames == 0 || argc > 7)
+    {
+        std::cout << "usage: raster_benchmark [<width> <height> <triangles> <frames> <threads> [<reference>]]" << std::endl;
+        return 1;
+    }
+
+    benchmark_scene scene;
+    MakeScene(triangleCount, scene);
+
+    std::vector<unsigned char> softPixels, softSinglePixels, glPixels;
+
+    //The job system counts the calling thread among its threads, 0 workers means one per hardware thread
+    std::unique_ptr<job_system> jobs;
+    if (threads != 1)
+        jobs.reset(new job_system(threads ? threads - 1 : 0));
+    double single = RunSoft(scene, width, height, frames, nullptr, softSinglePixels);
+    double multi = RunSoft(scene, width, height, frames, jobs.get(), softPixels);
+    std::cout << "soft_rasterizer, 1 thread:  " << single * 1000.0 << " ms/frame, "
+        << triangleCount / single / 1e6 << " Mtri/s" << std::endl;
+    std::cout << "soft_rasterizer, " << (jobs ? jobs->GetThreadCount() : 1) << " threads: " << multi * 1000.0 << " ms/frame, "
+        << triangleCount / multi / 1e6 << " Mtri/s" << std::endl;
+    bool same = softPixels == softSinglePixels;
+    if (!same)
+        std::cout << "[Raster] Thread count changed the image" << std::endl;
+
+    std::vector<unsigned char> coloredPixels, coloredSinglePixels;
+    RunSoftColored(scene, width, height, nullptr, coloredSinglePixels);
+    RunSoftColored(scene, width, height, jobs.get(), coloredPixels);
+    if (coloredPixels != coloredSinglePixels)
+    {
+        std::cout << "[Raster] Thread count changed the vertex color image" << std::endl;
+        same = false;
+    }
+    if (referencePath)
+    {
+#ifdef __AVX2__
+        const char* path = "AVX2";
+#else
+        const char* path = "scalar";
+#endif
+        long long differing = CompareWithReference(referencePath, coloredPixels);
+        if (differing < 0)
+            std::cout << "[Raster] " << referencePath << " is not a " << width << "x" << height << " image" << std::endl;
+        else
+            std::cout << "Vertex colors, " << path << ": " << differing << " pixels differ from " << referencePath << std::endl;
+        same = same && differing == 0;
+    }
+
+    EGLDisplay display;
+    EGLContext context = EGL_NO_CONTEXT;
+    if (!CreateContext("[Raster]", display, context))
+        return same ? 0 : 1;
+
+    std::cout << glGetString(GL_RENDERER) << ", " << glGetString(GL_VERSION) << std::endl;
+    double gl = RunGL(scene, width, height, frames, glPixels);
+    std::cout << "GL: " << gl * 1000.0 << " ms/frame, " << triangleCount / gl / 1e6 << " Mtri/s" << std::endl;
+
+    size_t differing = 0;
+    for (size_t i = 0; i < glPixels.size(); i += 4)
+    {
+        if (glPixels[i] != softPixels[i] || glPixels[i + 1] != softPixels[i + 1] || glPixels[i + 2] != softPixels[i + 2])
+            differing++;
+    }
+    std::cout << differing << " of " << (size_t)width * height << " pixels differ from GL ("
+        << 100.0 * differing / ((double)width * height) << "%)" << std::endl;
+
+    DestroyContext(display, context);
+    return same ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,144 @@
+//Benchmark of scene_graph::Update on a large hierarchy: every node dirty (the root
+//moved), a small fraction of scattered nodes moved, and nothing moved, on the
+//calling thread alone and split across a job_system. World matrices are checked
+//against a plain parent-times-local walk. Build with src/scene_graph.cpp,
+//src/simd_math.cpp and src/job_system.cpp (plus renderer and command_list, which
+//scene_graph::Submit uses), ideally with -mavx2 -mfma.
+//
+//    scene_benchmark [<nodes> <children per node> <threads>]
+//
+//Defaults: 1000000 nodes, 4 children per node, one thread per hardware thread.
+//Nodes are added depth first, so the first Update also has to sort them by depth.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "scene_graph.h"
+#include "job_system.h"
+#include "timing.h"
+
+static const unsigned int repeats = 10;
+
+static mat4 RandomTransform(std::mt19937& random)
+{
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    return Compose(vec3(unit(random), unit(random), unit(random)), AxisAngle(vec3(0.0f, 0.0f, 1.0f), unit(random)),
+                   vec3(0.9f, 0.9f, 0.9f));
+}
+
+//Adds count nodes below parent, depth first, children per node at most
+static void Build(scene_graph& scene, scene_node parent, unsigned int count, unsigned int children, std::mt19937& random,
+                  std::vector<scene_node>& nodes)
+{
+    const aabb unitBox = { vec3(-0.5f, -0.5f, -0.5f), vec3(0.5f, 0.5f, 0.5f) };
+    scene_node node = scene.Add(parent, RandomTransform(random), unitBox);
+    nodes.push_back(node);
+    count--;
+
+    for (unsigned int c = 0; c < children && count > 0; c++)
+    {
+        unsigned int share = count / (children - c);
+        if (share == 0)
+            share = count;
+        Build(scene, node, share, children, random, nodes);
+        count -= share;
+    }
+}
+
+static float Verify(const scene_graph& scene)
+{
+    std::vector<mat4> expected(scene.GetCount());
+    const unsigned int* parents = scene.GetParents();
+    float error = 0.0f;
+    for (unsigned int i = 0; i < scene.GetCount(); i++)
+    {
+        scene_node node = scene.GetNode(i);
+        expected[i] = parents[i] == ~0u ? scene.GetLocal(node) : expected[parents[i]] * scene.GetLocal(node);
+        for (int c = 0; c < 4; c++)
+            for (int r = 0; r < 4; r++)
+                error = std::max(error, std::fabs(expected[i].Columns[c][r] - scene.GetWorld(node).Columns[c][r]));
+    }
+    return error;
+}
+
+static void Run(const char* name, unsigned int nodeCount, unsigned int children, job_system* jobs)
+{
+    std::mt19937 random(7);
+    scene_graph scene(jobs);
+    scene.Reserve(nodeCount);
+    std::vector<scene_node> nodes;
+    nodes.reserve(nodeCount);
+
+    auto begin = std::chrono::steady_clock::now();
+    Build(scene, invalidSceneNode, nodeCount, children, random, nodes);
+    double build = Milliseconds(begin);
+
+    begin = std::chrono::steady_clock::now();
+    scene.Update();
+    double first = Milliseconds(begin);
+
+    std::cout << name << ": " << nodeCount << " nodes, " << scene.GetDepthCount() << " levels, built in " << build
+        << " ms, first update (sort + all) " << first << " ms" << std::endl;
+
+    double all = 1e30;
+    for (unsigned int r = 0; r < repeats; r++)
+    {
+        scene.SetLocal(nodes[0], RandomTransform(random));
+        begin = std::chrono::steady_clock::now();
+        scene.Update();
+        all = std::min(all, Milliseconds(begin));
+    }
+
+    //Scattered leaves and inner nodes, each dragging its subtree along
+    const unsigned int moved = std::max(1u, nodeCount / 100);
+    std::uniform_int_distribution<unsigned int> pick(0, nodeCount - 1);
+    double some = 1e30;
+    for (unsigned int r = 0; r < repeats; r++)
+    {
+        for (unsigned int m = 0; m < moved; m++)
+            scene.SetLocal(nodes[pick(random)], RandomTransform(random));
+        begin = std::chrono::steady_clock::now();
+        scene.Update();
+        some = std::min(some, Milliseconds(begin));
+    }
+
+    double none = 1e30;
+    for (unsigned int r = 0; r < repeats; r++)
+    {
+        begin = std::chrono::steady_clock::now();
+        scene.Update();
+        none = std::min(none, Milliseconds(begin));
+    }
+
+    std::cout << "  all dirty " << all << " ms, " << moved << " moved " << some << " ms, nothing moved " << none
+        << " ms, max difference " << Verify(scene) << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int nodeCount = argc > 1 ? (unsigned int)atoi(argv[1]) : 1000000;
+    unsigned int children = argc > 2 ? (unsigned int)atoi(argv[2]) : 4;
+    unsigned int threads = argc > 3 ? (unsigned int)atoi(argv[3]) : 0;
+    if (nodeCount == 0 || children < 2)
+    {
+        std::cout << "usage: scene_benchmark [<nodes> <children per node> <threads>]" << std::endl;
+        return 1;
+    }
+
+    Run("1 thread", nodeCount, children, nullptr);
+
+    //The job system counts the calling thread among its threads, 0 workers means one per hardware thread
+    if (threads != 1)
+    {
+        job_system jobs(threads ? threads - 1 : 0);
+        std::string name = std::to_string(jobs.GetThreadCount()) + " threads";
+        Run(name.c_str(), nodeCount, children, &jobs);
+    }
+    return 0;
+}
\ No newline at end of file
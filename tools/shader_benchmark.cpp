@@ -0,0 +1,143 @@
+//Benchmark of shader loading: shader_preprocessor, which maps each file and walks
+//it once, against the getline and stringstream loader it replaced, on a library of
+//generated .shader files that each include a shared file. The stage sources of
+//both are compared. Build with src/shader_preprocessor.cpp, src/shader_source.cpp
+//and src/mapped_file.cpp.
+//
+//    shader_benchmark [<files> <lines per stage>]
+//
+//Defaults: 1000 files of 400 lines per stage, written to a temporary directory.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "shader_preprocessor.h"
+#include "timing.h"
+
+static const unsigned int repeats = 5;
+
+//The old loader: includes expanded line by line into a stringstream, then split
+//into stages line by line again
+static void LegacyExpand(const std::string& filepath, std::stringstream& out, std::vector<std::string>& included)
+{
+    if (std::find(included.begin(), included.end(), filepath) != included.end())
+        return;
+    included.push_back(filepath);
+
+    std::ifstream file(filepath);
+    size_t slash = filepath.find_last_of("/\\");
+    std::string directory = slash == std::string::npos ? "" : filepath.substr(0, slash + 1);
+
+    std::string line;
+    while (getline(file, line))
+    {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first != std::string::npos && line.compare(first, 8, "#include") == 0)
+        {
+            size_t open = line.find('"');
+            size_t close = line.find('"', open + 1);
+            LegacyExpand(directory + line.substr(open + 1, close - open - 1), out, included);
+        }
+        else
+        {
+            out << line << "\n";
+        }
+    }
+}
+
+static ShaderProgramSource LegacyLoad(const std::string& filepath)
+{
+    std::vector<std::string> included;
+    std::stringstream expanded;
+    LegacyExpand(filepath, expanded, included);
+
+    std::string line;
+    std::stringstream stages[2];
+    int stage = -1;
+    while (getline(expanded, line))
+    {
+        if (line.find("#shader") != std::string::npos)
+            stage = line.find("vertex") != std::string::npos ? 0 : line.find("fragment") != std::string::npos ? 1 : -1;
+        else if (stage >= 0)
+            stages[stage] << line << "\n";
+    }
+
+    ShaderProgramSource source;
+    source.VertexSource = stages[0].str();
+    source.FragmentSource = stages[1].str();
+    return source;
+}
+
+static void WriteStage(std::ofstream& file, const char* stage, unsigned int lines, unsigned int seed)
+{
+    file << "#shader " << stage << "\n#version 330 core\n";
+    for (unsigned int i = 0; i < lines; i++)
+        file << "    vec4 v" << i << " = vec4(" << (seed + i) % 97 << ".0, 0.5, 0.25, 1.0) * u_Scale; //line " << i << "\n";
+    file << "void main() { }\n";
+}
+
+int main(int argc, char** argv)
+{
+    unsigned int count = argc > 1 ? (unsigned int)atoi(argv[1]) : 1000;
+    unsigned int lines = argc > 2 ? (unsigned int)atoi(argv[2]) : 400;
+    if (count == 0 || argc > 3)
+    {
+        std::cout << "usage: shader_benchmark [<files> <lines per stage>]" << std::endl;
+        return 1;
+    }
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "shader_benchmark";
+    std::filesystem::create_directories(directory);
+    {
+        std::ofstream common(directory / "common.glsl");
+        common << "uniform vec4 u_Scale;\n";
+    }
+
+    std::vector<std::string> paths;
+    size_t bytes = 0;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        paths.push_back((directory / ("shader" + std::to_string(i) + ".shader")).string());
+        std::ofstream file(paths.back());
+        file << "//Generated\n";
+        WriteStage(file, "vertex", lines, i);
+        file << "#include \"common.glsl\"\n";
+        WriteStage(file, "fragment", lines, i * 7);
+        bytes += (size_t)file.tellp();
+    }
+    std::cout << count << " files, " << bytes / 1e6 << " MB, best of " << repeats << std::endl;
+
+    std::vector<ShaderProgramSource> legacy(count), current(count);
+    double legacyTime = Time(repeats, [&] {
+        for (unsigned int i = 0; i < count; i++)
+            legacy[i] = LegacyLoad(paths[i]);
+    });
+    double currentTime = Time(repeats, [&] {
+        for (unsigned int i = 0; i < count; i++)
+        {
+            shader_preprocessor preprocessor(paths[i]);
+            current[i] = preprocessor.GetVariant();
+        }
+    });
+
+    unsigned int different = 0;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (legacy[i].VertexSource != current[i].VertexSource || legacy[i].FragmentSource != current[i].FragmentSource)
+            different++;
+    }
+
+    std::cout << "getline and stringstream: " << legacyTime << " ms, " << bytes / legacyTime / 1e3 << " MB/s" << std::endl;
+    std::cout << "shader_preprocessor: " << currentTime << " ms, " << bytes / currentTime / 1e3 << " MB/s ("
+        << legacyTime / currentTime << "x), " << different << " of " << count << " differ" << std::endl;
+
+    std::filesystem::remove_all(directory);
+    return different == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+
+//Timing helpers shared by the benchmarks in tools/
+
+//Milliseconds since begin
+inline double Milliseconds(std::chrono::steady_clock::time_point begin)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+//Best time of repeats runs of fn in milliseconds, the minimum is the least
+//disturbed by everything else
+template<typename Function>
+double Time(unsigned int repeats, const Function& fn)
+{
+	double best = 1e30;
+	for (unsigned int r = 0; r < repeats; r++)
+	{
+		auto begin = std::chrono::steady_clock::now();
+		fn();
+		best = std::min(best, Milliseconds(begin));
+	}
+	return best;
+}